@@ -0,0 +1,551 @@
+// 渲染与编辑热点路径的性能基准
+//
+//   bunny_bench [--quick] [--corpus dir] [--output result.json]
+//               [--baseline baseline.json] [--threshold 0.10]
+//   bunny_bench --verify [--quick] [--corpus dir]
+//
+// 结果以 JSON 输出；指定 --baseline 时逐项对比，耗时超过阈值的项目视为回归，退出码为 1。
+// --verify 不计时，逐个文档比较分块并行解析与整体解析的 HTML 和块级节点行号，有任何差异时退出码为 1。
+
+#include "HtmlConverter.hpp"
+#include "PageTemplate.hpp"
+#include "Utf8.hpp"
+#include "blocksplitter.h"
+#include "documentsnapshot.h"
+#include "filemonitor.h"
+#include "markdownhighlighter.h"
+#include "mathrenderer.h"
+#include "nativerenderer.h"
+#include "spellchecker.h"
+#include "tabarchive.h"
+#include "threewaymerge.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct BenchResult {
+        QString name;
+        qint64 bytes;
+        int iterations;
+        qint64 medianNs;
+    };
+
+    struct Corpus {
+        QString name;
+        QString text;
+    };
+
+    // 反复执行直到至少 minIterations 次且累计超过 minNs，取中位数
+    BenchResult measure(const QString &name, qint64 bytes, const std::function<void()> &body) {
+        const int minIterations = 3;
+        const qint64 minNs = 200 * 1000 * 1000;
+        std::vector<qint64> samples;
+        qint64 total = 0;
+        QElapsedTimer timer;
+        while (int(samples.size()) < minIterations || (total < minNs && samples.size() < 1000)) {
+            timer.start();
+            body();
+            qint64 elapsed = timer.nsecsElapsed();
+            samples.push_back(elapsed);
+            total += elapsed;
+        }
+        std::sort(samples.begin(), samples.end());
+        BenchResult result{name, bytes, int(samples.size()), samples[samples.size() / 2]};
+        double mbPerSecond = result.medianNs > 0 ? bytes / (1024.0 * 1024.0) / (result.medianNs / 1e9) : 0;
+        QTextStream(stderr) << QString("%1 %2 ms  %3 MB/s\n")
+                                       .arg(name, -40)
+                                       .arg(result.medianNs / 1e6, 10, 'f', 3)
+                                       .arg(mbPerSecond, 9, 'f', 1);
+        return result;
+    }
+
+    // 按模板重复生成指定大小的文档
+    QString generate(int targetBytes, const std::function<QString(int)> &block) {
+        QString text;
+        int bytes = 0;
+        for (int i = 0; bytes < targetBytes; ++i) {
+            QString piece = block(i);
+            bytes += piece.toUtf8().size();
+            text += piece;
+        }
+        return text;
+    }
+
+    QString proseBlock(int i) {
+        return QString("## 第 %1 节\n\n"
+                       "Lorem ipsum *dolor* sit amet, **consectetur** adipiscing elit, [link %1](note-%1.md) "
+                       "sed do eiusmod `tempor` incididunt ut labore et dolore magna aliqua.\n\n"
+                       "- item one\n- item two with _emphasis_\n- item three\n\n"
+                       "> quoted text %1\n\n")
+                .arg(i);
+    }
+
+    QString codeBlock(int i) {
+        return QString("```cpp\n"
+                       "int function_%1(int value) {\n"
+                       "    for (int i = 0; i < value; ++i) {\n"
+                       "        value += i * %1;\n"
+                       "    }\n"
+                       "    return value;\n"
+                       "}\n"
+                       "```\n\n"
+                       "Text between code blocks %1.\n\n")
+                .arg(i);
+    }
+
+    QString tableBlock(int i) {
+        QString table = "| id | name | value | note |\n|----|------|-------|------|\n";
+        for (int row = 0; row < 20; ++row) {
+            table += QString("| %1 | row-%2 | %3 | `cell` *%2* |\n").arg(i * 20 + row).arg(row).arg(row * 3.5);
+        }
+        return table + "\n";
+    }
+
+    QString cjkBlock(int i) {
+        return QString("### 标题 %1\n\n"
+                       "这是一段用于测试的中文文本，包含**加粗**、*斜体*和`行内代码`。"
+                       "春眠不觉晓，处处闻啼鸟。夜来风雨声，花落知多少。日本語のテキストも含まれています。"
+                       "한국어 텍스트도 있습니다。\n\n")
+                .arg(i);
+    }
+
+    QString mathBlock(int i) {
+        return QString("公式 %1：$E_{%1} = mc^2 + \\frac{a_%1}{\\sqrt{b^2 + %1}}$，以及\n\n"
+                       "$$\\sum_{k=0}^{%1} \\binom{n}{k} x^k = \\left( 1 + x \\right)^n$$\n\n")
+                .arg(i);
+    }
+
+    QList<Corpus> buildCorpus(bool quick, const QString &corpusDir) {
+        QList<Corpus> corpus;
+        QList<QPair<QString, int>> sizes = {{"1KB", 1024}, {"64KB", 64 * 1024}, {"1MB", 1024 * 1024}};
+        if (!quick) {
+            sizes.append({"10MB", 10 * 1024 * 1024});
+            sizes.append({"50MB", 50 * 1024 * 1024});
+        }
+        const QList<QPair<QString, std::function<QString(int)>>> kinds = {
+                {"prose", proseBlock}, {"code", codeBlock}, {"table", tableBlock}, {"cjk", cjkBlock}};
+        for (const auto &kind: kinds) {
+            for (const auto &size: sizes) {
+                corpus.append(Corpus{kind.first + "/" + size.first, generate(size.second, kind.second)});
+            }
+        }
+
+        // 真实文档
+        if (!corpusDir.isEmpty()) {
+            QDirIterator it(corpusDir, QStringList() << "*.md", QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                QString path = it.next();
+                QFile file(path);
+                if (file.open(QFile::ReadOnly)) {
+                    corpus.append(Corpus{"real/" + QDir(corpusDir).relativeFilePath(path), QString::fromUtf8(file.readAll())});
+                }
+            }
+        }
+        return corpus;
+    }
+
+    // 分块边界附近容易出错的结构，每段重复多次使其跨越切分点
+    QList<Corpus> trickyCorpus() {
+        const QList<QPair<QString, QString>> snippets = {
+                {"fence", "```\ncode\n\nnot a paragraph\n```\n\n~~~~\n```\n\ninside\n~~~~\n\n"},
+                {"html-comment", "<!--\ncomment\n\n# not a heading\n-->\n\n<div>\ntext\n\n# heading\n</div>\n\n"},
+                {"html-raw", "<script>\nlet a = 1;\n\nlet b = 2;\n</script>\n\n<pre>\n\n*x*\n</pre>\n\n"},
+                {"list", "- item\n\n  continued\n\n- next\n\n      code in item\n\nafter list\n\n1. one\n\n2) two\n\n"},
+                {"quote", "> quote\n\n> another\nlazy line\n\n>\n> # heading\n\n"},
+                {"indented", "    indented\n\n    code\n\nparagraph\n    not code\n\n"},
+                {"reference", "[forward] and [later][ref] and [missing]\n\n[ref]: /url \"title\"\n\n[forward]: <with space> 'single'\n\n"},
+                {"reference-bracket", "[a[b]: /not-a-definition\n\n[c\\[d]: /escaped\n\n[c\\[d] and [a[b]\n\n"},
+                {"setext", "Heading\n=======\n\nText\n\n---\n\n* * *\n\nSecond\n-------\n\n"},
+                {"crlf", "# title\r\n\r\n```\r\ncode\r\n\r\n```\r\n\r\n[a]: /b\r\n\r\n[a]\r\n\r\n"},
+                {"tabs", "\tcode\n\n-\titem\n\n\ttail\n\n"},
+        };
+        QList<Corpus> corpus;
+        for (const auto &snippet: snippets) {
+            corpus.append(Corpus{"tricky/" + snippet.first, snippet.second.repeated(200)});
+        }
+        QString mixed;
+        for (const auto &snippet: snippets) {
+            mixed += snippet.second;
+        }
+        corpus.append(Corpus{"tricky/mixed", mixed.repeated(100)});
+        corpus.append(Corpus{"tricky/bom", QChar(0xFEFF) + mixed.repeated(100)});
+        return corpus;
+    }
+
+    // 快照中所有块级节点在整个文档中的起始行，检查分块解析的行号换算
+    QVector<int> blockLines(const DocumentSnapshot &snapshot) {
+        QVector<int> lines;
+        snapshot.walk([&lines](cmark_node *node, cmark_event_type event, int lineOffset) {
+            cmark_node_type type = cmark_node_get_type(node);
+            if (event == CMARK_EVENT_ENTER && type >= CMARK_NODE_FIRST_BLOCK && type <= CMARK_NODE_LAST_BLOCK) {
+                lines.append(cmark_node_get_start_line(node) + lineOffset);
+            }
+        });
+        return lines;
+    }
+
+    // 分块并行解析与整体解析的差分检查，返回不一致的文档数量
+    int verifyChunked(const QList<Corpus> &corpus) {
+        QTextStream err(stderr);
+        int mismatches = 0;
+        int chunked = 0;
+        for (const Corpus &doc: corpus) {
+            const QByteArray markdown = doc.text.toUtf8();
+            BlockSplit split;
+            // 用很小的块让切分点足够多
+            if (BlockSplitter::split(markdown, 4096, split) && split.offsets.size() > 1) {
+                ++chunked;
+            }
+            const DocumentSnapshotPtr serialSnapshot = DocumentSnapshot::parseSerial(markdown);
+            const DocumentSnapshotPtr chunkedSnapshot = DocumentSnapshot::parseChunked(markdown, 4096);
+            if (blockLines(*serialSnapshot) != blockLines(*chunkedSnapshot)) {
+                ++mismatches;
+                err << "LINE MISMATCH " << doc.name << "\n";
+                continue;
+            }
+            const QByteArray serial = HtmlConverter::render(*serialSnapshot);
+            const QByteArray parallel = HtmlConverter::render(*chunkedSnapshot);
+            if (serial == parallel) {
+                continue;
+            }
+            ++mismatches;
+            qsizetype at = 0;
+            while (at < serial.size() && at < parallel.size() && serial[at] == parallel[at]) {
+                ++at;
+            }
+            err << "MISMATCH " << doc.name << " at byte " << at << "\n"
+                << "  serial:   " << serial.mid(qMax<qsizetype>(0, at - 40), 120) << "\n"
+                << "  parallel: " << parallel.mid(qMax<qsizetype>(0, at - 40), 120) << "\n";
+        }
+        err << corpus.size() << " documents, " << chunked << " split into chunks, " << mismatches << " mismatches\n";
+        return mismatches;
+    }
+
+    QJsonObject toJson(const QList<BenchResult> &results) {
+        QJsonArray array;
+        for (const BenchResult &result: results) {
+            QJsonObject item;
+            item["name"] = result.name;
+            item["bytes"] = result.bytes;
+            item["iterations"] = result.iterations;
+            item["median_ns"] = result.medianNs;
+            array.append(item);
+        }
+        QJsonObject root;
+        root["version"] = 1;
+        root["results"] = array;
+        return root;
+    }
+
+    // 与基线逐项比较，返回回归项数量
+    int compare(const QList<BenchResult> &results, const QString &baselinePath, double threshold) {
+        QFile file(baselinePath);
+        if (!file.open(QFile::ReadOnly)) {
+            QTextStream(stderr) << "无法读取基线文件: " << baselinePath << "\n";
+            return -1;
+        }
+        QHash<QString, qint64> baseline;
+        for (const QJsonValue &value: QJsonDocument::fromJson(file.readAll()).object().value("results").toArray()) {
+            QJsonObject item = value.toObject();
+            baseline.insert(item.value("name").toString(), qint64(item.value("median_ns").toDouble()));
+        }
+
+        int regressions = 0;
+        QTextStream err(stderr);
+        err << "\n与基线对比（阈值 " << threshold * 100 << "%）:\n";
+        for (const BenchResult &result: results) {
+            qint64 base = baseline.value(result.name, 0);
+            if (base <= 0) {
+                continue;
+            }
+            double change = double(result.medianNs - base) / base;
+            bool regressed = change > threshold;
+            regressions += regressed ? 1 : 0;
+            err << QString("%1 %2%  %3\n")
+                           .arg(result.name, -40)
+                           .arg(change * 100, 8, 'f', 1)
+                           .arg(regressed ? "REGRESSION" : "ok");
+        }
+        return regressions;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // QTextDocument 需要字体系统，无显示环境时使用 offscreen 平台
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bunny Note 性能基准");
+    parser.addHelpOption();
+    QCommandLineOption quickOption("quick", "只运行 1MB 以下的文档。");
+    QCommandLineOption corpusOption("corpus", "额外加入目录下的真实 .md 文档。", "dir");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "结果 JSON 输出文件（缺省为标准输出）。", "file");
+    QCommandLineOption baselineOption("baseline", "与基线 JSON 比较。", "file");
+    QCommandLineOption thresholdOption("threshold", "判定回归的耗时增幅，默认 0.10。", "ratio", "0.10");
+    QCommandLineOption verifyOption("verify", "检查分块并行解析的输出与整体解析一致。");
+    parser.addOptions({quickOption, corpusOption, outputOption, baselineOption, thresholdOption, verifyOption});
+    parser.process(app);
+
+    const QList<Corpus> corpus = buildCorpus(parser.isSet(quickOption), parser.value(corpusOption));
+    if (parser.isSet(verifyOption)) {
+        return verifyChunked(corpus + trickyCorpus()) == 0 ? 0 : 1;
+    }
+    const PageStyle style = PageTemplate::defaultStyle();
+    QTemporaryDir tempDir;
+    FileMonitor fileMonitor;
+    QList<BenchResult> results;
+
+    for (const Corpus &doc: corpus) {
+        const qint64 bytes = doc.text.toUtf8().size();
+
+        // Markdown -> HTML
+        QString html;
+        results.append(measure("convert/" + doc.name, bytes, [&]() {
+            html = HtmlConverter::convertToHtml(doc.text);
+        }));
+
+        // 大文档强制按 1MB 分块并行解析，与上一项对比加速比
+        if (bytes >= 4 * HtmlConverter::ChunkBytes) {
+            const QByteArray utf8 = doc.text.toUtf8();
+            results.append(measure("convert-serial/" + doc.name, bytes, [&]() {
+                QByteArray out = HtmlConverter::renderSerial(utf8);
+                Q_UNUSED(out);
+            }));
+            results.append(measure("convert-chunked/" + doc.name, bytes, [&]() {
+                QByteArray out = HtmlConverter::renderChunked(utf8, HtmlConverter::ChunkBytes);
+                Q_UNUSED(out);
+            }));
+        }
+
+        // 预览页面内容构建（loadMarkdown 注入外壳的脚本）
+        const QByteArray htmlUtf8 = html.toUtf8();
+        results.append(measure("page/" + doc.name, bytes, [&]() {
+            QString script = PageTemplate::setStyleScript(style) + QString::fromUtf8(PageTemplate::setContentScript(htmlUtf8, "file:///"));
+            Q_UNUSED(script);
+        }));
+
+        // 预览的完整转换路径：编辑器文本转 UTF-8 后直到注入脚本都按字节处理
+        results.append(measure("preview/" + doc.name, bytes, [&]() {
+            QByteArray out = HtmlConverter::renderHtml(doc.text.toUtf8());
+            QString script = QString::fromUtf8(PageTemplate::setContentScript(out, "file:///"));
+            Q_UNUSED(script);
+        }));
+
+        // 一次解析供多个读者使用：HTML 渲染和字数统计共享同一快照
+        results.append(measure("snapshot-shared/" + doc.name, bytes, [&]() {
+            DocumentSnapshotPtr snapshot = DocumentSnapshot::parse(doc.text.toUtf8());
+            QByteArray html = HtmlConverter::render(*snapshot);
+            int words = snapshot->wordCount();
+            Q_UNUSED(html);
+            Q_UNUSED(words);
+        }));
+
+        // 轻量预览：AST 直接构建 QTextDocument（不含布局）
+        results.append(measure("native/" + doc.name, bytes, [&]() {
+            QTextDocument document;
+            NativeRenderer::render(*DocumentSnapshot::parse(doc.text.toUtf8()), &document, PageTemplate::defaultStyle(), tempDir.path(), 800, nullptr);
+        }));
+
+        // 磁盘字节的 UTF-8 校验
+        const QByteArray raw = doc.text.toUtf8();
+        results.append(measure("utf8-validate/" + doc.name, bytes, [&]() {
+            bool valid = Utf8::isValid(raw);
+            Q_UNUSED(valid);
+        }));
+
+        // 打开文件：按字节读取、统一换行、载入文档，并交给监视器计算内容哈希（与 materializeTab 相同的步骤）
+        QString path = tempDir.filePath(QString(doc.name).replace('/', '_') + ".md");
+        QFile seed(path);
+        if (seed.open(QFile::WriteOnly)) {
+            seed.write(doc.text.toUtf8());
+            seed.close();
+        }
+        results.append(measure("open/" + doc.name, bytes, [&]() {
+            QFile file(path);
+            QByteArray content;
+            if (file.open(QFile::ReadOnly)) {
+                content = file.readAll();
+                file.close();
+            }
+            const QString text = QString::fromUtf8(content).replace("\r\n", "\n");
+            QTextDocument document;
+            document.setPlainText(text);
+            EditJournal journal(&document, text);
+            fileMonitor.watch(path, content);
+        }));
+
+        // 保存文件（与 writeTabToFile 相同的步骤）
+        QTextDocument document;
+        document.setPlainText(doc.text);
+        results.append(measure("save/" + doc.name, bytes, [&]() {
+            QFile file(path);
+            if (file.open(QFile::WriteOnly | QFile::Text)) {
+                QTextStream out(&file);
+                out << document.toPlainText();
+            }
+        }));
+    }
+
+    // 公式：冷启动（每个公式都要转换）与编辑时（只有变化的公式需要转换）
+    {
+        QString text;
+        for (int i = 0; i < 1000; ++i) {
+            text += mathBlock(i);// 共 2000 个公式
+        }
+        const qint64 bytes = text.toUtf8().size();
+        auto renderMath = [&text](MathRenderer &renderer) {
+            QVector<MathFormula> formulas;
+            QByteArray html = HtmlConverter::renderHtml(MathRenderer::extractMath(text, formulas).toUtf8());
+            html = renderer.insertMath(html, formulas);
+            Q_UNUSED(html);
+        };
+        results.append(measure("math/2000-formulas-cold", bytes, [&]() {
+            MathRenderer renderer;
+            renderMath(renderer);
+        }));
+        MathRenderer warm;
+        renderMath(warm);
+        results.append(measure("math/2000-formulas-warm", bytes, [&]() {
+            renderMath(warm);
+        }));
+    }
+
+    // 拼写词典：由生成文档中的词构建，每轮查一遍 1MB 文档中的全部词
+    SpellChecker spellChecker;
+    {
+        const QString text = generate(1024 * 1024, [](int i) { return proseBlock(i); });
+        QVector<QPair<int, int>> words;
+        QList<QByteArray> vocabulary;
+        int start = 0, length = 0;
+        while (SpellChecker::nextWord(text, start + length, start, length)) {
+            words.append({start, length});
+            // 留一部分词不收录，让检查结果里有拼错的词
+            if (length % 5 != 0) {
+                vocabulary.append(text.mid(start, length).toUtf8());
+            }
+        }
+        const qint64 bytes = text.toUtf8().size();
+        auto dictionary = QSharedPointer<SpellDictionary>::create();
+        results.append(measure("spell/build-dictionary", bytes, [&]() {
+            dictionary = QSharedPointer<SpellDictionary>::create();
+            dictionary->build(vocabulary);
+        }));
+        results.append(measure("spell/check-1MB", bytes, [&]() {
+            QVector<QPair<int, int>> wrong = SpellChecker::misspelled(*dictionary, text, words);
+            Q_UNUSED(wrong);
+        }));
+        spellChecker.setDictionary(dictionary);
+    }
+
+    // 编辑器语法高亮：5MB 文档中间连续输入时每次按键的耗时，开启高亮后应与不开启基本相同；
+    // 拼写检查只在按键时给被修改的块排队，查词典在后台进行
+    {
+        const QString text = generate(5 * 1024 * 1024, [](int i) { return i % 2 ? proseBlock(i) : codeBlock(i); });
+        const qint64 bytes = text.toUtf8().size();
+        auto typing = [&](const QString &name, bool highlight, SpellChecker *checker = nullptr) {
+            QTextDocument document;
+            document.setPlainText(text);
+            std::unique_ptr<MarkdownHighlighter> highlighter;
+            if (highlight) {
+                results.append(measure(checker ? "highlight/initial-5MB-spell" : "highlight/initial-5MB", bytes, [&]() {
+                    highlighter = std::make_unique<MarkdownHighlighter>(&document, false, checker);
+                    highlighter->rehighlight();
+                }));
+            }
+            QTextCursor cursor(document.findBlockByNumber(document.blockCount() / 2));
+            cursor.movePosition(QTextCursor::EndOfBlock);
+            results.append(measure(name, 1, [&]() {
+                cursor.insertText("x");
+            }));
+        };
+        typing("type/5MB-plain", false);
+        typing("type/5MB-highlighted", true);
+        typing("type/5MB-spell", true, &spellChecker);
+    }
+
+    // 外部修改合并：5MB 文档两边各改 50 处互不重叠的行
+    {
+        const QString base = generate(5 * 1024 * 1024, [](int i) { return proseBlock(i); });
+        QStringList mineLines = base.split('\n');
+        QStringList theirLines = mineLines;
+        const qsizetype step = mineLines.size() / 100;
+        for (int i = 0; i < 100; ++i) {
+            QStringList &lines = i % 2 ? theirLines : mineLines;
+            lines[i * step] += QString(" edit %1").arg(i);
+        }
+        const QString mine = mineLines.join('\n');
+        const QString theirs = theirLines.join('\n');
+        const qint64 bytes = base.toUtf8().size();
+        MergeResult merged;
+        results.append(measure("merge/5MB-scattered", bytes, [&]() {
+            merged = ThreeWayMerge::merge(base, mine, theirs);
+        }));
+        if (merged.conflicts != 0) {
+            QTextStream(stderr) << "merge/5MB-scattered: " << merged.conflicts << " unexpected conflicts\n";
+        }
+    }
+
+    // 不活动标签折叠：5MB 文档带 200 次编辑，存档后在新文档上恢复文本和撤销历史
+    {
+        const QString text = generate(5 * 1024 * 1024, [](int i) { return proseBlock(i); });
+        const qint64 bytes = text.toUtf8().size();
+        QTextDocument document;
+        document.setPlainText(text);
+        EditJournal journal(&document, text);
+        QTextCursor cursor(&document);
+        for (int i = 0; i < 200; ++i) {
+            cursor.setPosition(int(qint64(document.characterCount() - 1) * i / 200));
+            cursor.insertText(QString("edit %1\n").arg(i));
+        }
+        const QString edited = document.toPlainText();
+        QByteArray archive;
+        results.append(measure("tab-archive/store-5MB", bytes, [&]() {
+            archive = TabArchive::store(&document, journal, TabViewState{0, 0, 0});
+        }));
+        QTextDocument restoredDocument;
+        TabViewState state{0, 0, 0};
+        QString archived;
+        results.append(measure("tab-archive/restore-5MB", bytes, [&]() {
+            delete TabArchive::restore(archive, &restoredDocument, state, archived);
+        }));
+        if (restoredDocument.toPlainText() != edited || restoredDocument.availableUndoSteps() < 200) {
+            QTextStream(stderr) << "tab-archive/restore-5MB: restored text or undo history differs\n";
+        }
+    }
+
+    QByteArray json = QJsonDocument(toJson(results)).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile out(parser.value(outputOption));
+        if (out.open(QFile::WriteOnly)) {
+            out.write(json);
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    if (parser.isSet(baselineOption)) {
+        int regressions = compare(results, parser.value(baselineOption), parser.value(thresholdOption).toDouble());
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
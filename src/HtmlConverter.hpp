@@ -5,23 +5,223 @@
 #ifndef QMARKDOWNEDITOR_HTMLCONVERTER_HPP
 #define QMARKDOWNEDITOR_HTMLCONVERTER_HPP
 
+#include "Tracer.hpp"
+#include "Utf8.hpp"
+#include "blocksplitter.h"
+#include "documentsnapshot.h"
+#include "workstealingpool.h"
 #include <cmark.h>
+#include <QByteArray>
+#include <QFileDevice>
+#include <QIODevice>
 #include <QString>
+#include <cstring>
+#include <functional>
+#include <vector>
 
 class HtmlConverter {
 public:
-    inline static QString convertToHtml(QString markdown){
-        QByteArray markdown_bytes = markdown.toUtf8();
-        const char *markdown_c_str = markdown_bytes.constData();
+    // 超过该大小的文档切块并行解析
+    static constexpr qsizetype ParallelThreshold = DocumentSnapshot::ParallelThreshold;
+    static constexpr qsizetype ChunkBytes = DocumentSnapshot::ChunkBytes;
 
-        cmark_node *doc = cmark_parse_document(markdown_c_str, markdown_bytes.size(), CMARK_OPT_DEFAULT);
-        char *html = cmark_render_html(doc, CMARK_OPT_DEFAULT);
-        QString result = QString::fromUtf8(html);
+    // inspect 在解析后、渲染前对 AST 做只读遍历（例如收集图表代码块），不能修改节点；
+    // 大文档切块解析时按文档顺序对每一块调用一次
+    inline static QString convertToHtml(const QString &markdown, const std::function<void(cmark_node *)> &inspect = nullptr){
+        return QString::fromUtf8(renderHtml(markdown.toUtf8(), inspect));
+    }
+
+    inline static QByteArray renderHtml(const QByteArray &markdown, const std::function<void(cmark_node *)> &inspect = nullptr) {
+        return render(*DocumentSnapshot::parse(markdown), inspect);
+    }
+
+    // 整体解析
+    inline static QByteArray renderSerial(const QByteArray &markdown, const std::function<void(cmark_node *)> &inspect = nullptr) {
+        return render(*DocumentSnapshot::parseSerial(markdown), inspect);
+    }
+
+    // 在安全的块边界切开，各块并行解析和渲染后拼接，输出与 renderSerial 完全相同；
+    // 文档结构无法安全切分时退回整体解析
+    inline static QByteArray renderChunked(const QByteArray &markdown, qsizetype chunkBytes,
+                                           const std::function<void(cmark_node *)> &inspect = nullptr) {
+        return render(*DocumentSnapshot::parseChunked(markdown, chunkBytes), inspect);
+    }
+
+    // 渲染已经解析好的快照，快照本身不变，可以同时交给其他读者。
+    // markHeadings 为 true 时 AST 中的标题带 data-heading 属性，预览据此按大纲的顺序定位标题，
+    // 不会数到文档里手写的 HTML 标题
+    inline static QByteArray render(const DocumentSnapshot &snapshot, const std::function<void(cmark_node *)> &inspect = nullptr,
+                                    bool markHeadings = false) {
+        const QVector<DocumentSnapshot::Part> &parts = snapshot.parts();
+        if (inspect) {
+            for (const DocumentSnapshot::Part &part: parts) {
+                inspect(part.root);
+            }
+        }
+
+        qint64 start = Tracer::now();
+        if (parts.size() == 1) {
+            QByteArray result = renderNode(parts[0].root, markHeadings);
+            Tracer::record("html render", start, Tracer::now());
+            return result;
+        }
+
+        const int count = int(parts.size());
+        std::vector<QByteArray> html(count);
+        WorkStealingPool pool;
+        pool.run(count, [&](int i) {
+            html[i] = renderNode(parts[i].root, markHeadings);
+        });
+
+        qsizetype total = 0;
+        for (const QByteArray &part: html) {
+            total += part.size();
+        }
+        QByteArray result;
+        result.reserve(total);
+        for (const QByteArray &part: html) {
+            result += part;
+        }
+        Tracer::record("html render", start, Tracer::now());
+        return result;
+    }
+
+    // 把输入渲染成 HTML 写到 output，读写出错时返回 false。每块先快速校验 UTF-8，只有含非法序列的块才替换成 U+FFFD。
+    // 磁盘文件以内存映射打开，由 BlockSplitter 在安全的块边界切开（引用定义预先收集、拼在每块前面），
+    // 逐块解析、渲染并立即写出，常驻内存只有一块的 AST 和 HTML；无法安全切分的文档整体解析。
+    // parallel 为 true 且文件不小于 ParallelThreshold 时各块并行处理，HTML 拼好后一次写出，用内存换时间。
+    // 标准输入等不能随机读取的输入无法预先收集引用定义，分块送入 cmark_parser_feed，AST 和 HTML 仍是整篇的
+    inline static bool convertStream(QIODevice *input, QIODevice *output, bool parallel = false, qint64 chunkSize = 64 * 1024) {
+        auto *file = qobject_cast<QFileDevice *>(input);
+        const qint64 size = input->isSequential() ? 0 : input->size();
+        uchar *mapped = file && size > 0 ? file->map(0, size) : nullptr;
+        if (mapped) {
+            const QByteArray markdown = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), size);
+            bool ok;
+            if (parallel && size >= ParallelThreshold) {
+                ok = writeAll(output, renderChunked(Utf8::isValid(markdown) ? markdown : Utf8::repaired(markdown.constData(), size),
+                                                    ChunkBytes));
+            } else {
+                ok = writeChunks(markdown, output);
+            }
+            file->unmap(mapped);
+            return ok;
+        }
+
+        cmark_parser *parser = cmark_parser_new(CMARK_OPT_DEFAULT);
+        QByteArray buffer(chunkSize + 3, Qt::Uninitialized);
+        qint64 carry = 0;// 上一块末尾不完整的多字节序列
+        qint64 bytes;
+        while ((bytes = input->read(buffer.data() + carry, chunkSize)) > 0) {
+            const qint64 read = carry + bytes;
+            carry = Utf8::incompleteTail(buffer.constData(), read);
+            feedValid(parser, buffer.constData(), read - carry);
+            memmove(buffer.data(), buffer.constData() + read - carry, carry);
+        }
+        if (bytes < 0) {
+            cmark_parser_free(parser);
+            return false;// 读取出错，不输出不完整的结果
+        }
+        feedValid(parser, buffer.constData(), carry);
+        cmark_node *doc = cmark_parser_finish(parser);
+        cmark_parser_free(parser);
+        const bool ok = writeNode(doc, output);
         cmark_node_free(doc);
+        return ok;
+    }
+
+private:
+    inline static bool writeAll(QIODevice *output, const QByteArray &data) {
+        return output->write(data) == data.size();
+    }
+
+    // 渲染一棵 AST 并直接写出 cmark 的缓冲区，不再复制一份
+    inline static bool writeNode(cmark_node *root, QIODevice *output) {
+        char *html = cmark_render_html(root, CMARK_OPT_DEFAULT);
+        const qint64 length = qint64(strlen(html));
+        const bool ok = output->write(html, length) == length;
+        free(html);
+        return ok;
+    }
+
+    // 按 BlockSplitter 的边界逐块解析、渲染和写出，输出与整体解析相同
+    inline static bool writeChunks(const QByteArray &markdown, QIODevice *output) {
+        BlockSplit split;
+        if (!BlockSplitter::split(markdown, ChunkBytes, split) || split.offsets.isEmpty()) {
+            split.offsets = {0};
+            split.references.clear();
+        }
+        const qsizetype count = split.offsets.size();
+        for (qsizetype i = 0; i < count; ++i) {
+            const qsizetype begin = split.offsets[i];
+            const qsizetype end = i + 1 < count ? split.offsets[i + 1] : markdown.size();
+            QByteArray chunk;
+            chunk.reserve(split.references.size() + end - begin);
+            chunk.append(split.references).append(markdown.constData() + begin, end - begin);
+            if (!Utf8::isValid(chunk)) {
+                chunk = Utf8::repaired(chunk.constData(), chunk.size());
+            }
+            cmark_node *doc = cmark_parse_document(chunk.constData(), chunk.size(), CMARK_OPT_DEFAULT);
+            const bool ok = writeNode(doc, output);
+            cmark_node_free(doc);
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline static QByteArray renderNode(cmark_node *root, bool markHeadings) {
+        if (!markHeadings) {
+            char *html = cmark_render_html(root, CMARK_OPT_DEFAULT);
+            QByteArray result(html);
+            free(html);
+            return result;
+        }
+        // cmark 不能给标题加属性：带源码位置渲染，再把 data-sourcepos 去掉，只在标题上留下标记
+        char *html = cmark_render_html(root, CMARK_OPT_DEFAULT | CMARK_OPT_SOURCEPOS);
+        QByteArray result = replaceSourcepos(html);
         free(html);
         return result;
     }
 
+    // cmark 把 data-sourcepos="l:c-l:c" 紧接在标签名之后输出；值不是这个形式的（手写的 HTML）原样保留
+    inline static QByteArray replaceSourcepos(const char *html) {
+        static const char attribute[] = " data-sourcepos=\"";
+        const qsizetype attributeSize = sizeof(attribute) - 1;
+        QByteArray result;
+        result.reserve(qsizetype(strlen(html)));
+        const char *from = html;
+        const char *hit;
+        while ((hit = strstr(from, attribute)) != nullptr) {
+            const char *value = hit + attributeSize;
+            const char *end = value;
+            while ((*end >= '0' && *end <= '9') || *end == ':' || *end == '-') {
+                ++end;
+            }
+            if (*end != '"' || end == value) {
+                result.append(from, value - from);
+                from = value;
+                continue;
+            }
+            result.append(from, hit - from);
+            if (hit - html >= 3 && hit[-3] == '<' && hit[-2] == 'h' && hit[-1] >= '1' && hit[-1] <= '6') {
+                result.append(" data-heading");
+            }
+            from = end + 1;
+        }
+        result.append(from);
+        return result;
+    }
+
+    inline static void feedValid(cmark_parser *parser, const char *data, qsizetype size) {
+        if (Utf8::validPrefix(data, size) == size) {
+            cmark_parser_feed(parser, data, size);
+        } else {
+            QByteArray repaired = Utf8::repaired(data, size);
+            cmark_parser_feed(parser, repaired.constData(), repaired.size());
+        }
+    }
 };
 
 #endif//QMARKDOWNEDITOR_HTMLCONVERTER_HPP
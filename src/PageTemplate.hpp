@@ -0,0 +1,224 @@
+#ifndef QMARKDOWNEDITOR_PAGETEMPLATE_HPP
+#define QMARKDOWNEDITOR_PAGETEMPLATE_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QString>
+
+struct PageStyle {
+    QString backgroundColor;
+    QString textColor;
+    QString fontFamily;
+    int fontSize;
+};
+
+// 预览页面模板：静态页面（导出使用）与预览外壳共用同一份样式
+class PageTemplate {
+public:
+    // 导出和命令行模式的默认样式
+    inline static PageStyle defaultStyle() {
+        return PageStyle{"#ffffff", "#000000", "Arial", 12};
+    }
+
+    // 完整的静态 HTML 页面
+    inline static QString buildPage(const QString &html, const PageStyle &style) {
+        return pageHeader(style) + html + pageFooter();
+    }
+
+    // 静态页面拆成头尾两段，正文可以直接以字节流写在中间
+    inline static QString pageHeader(const PageStyle &style) {
+        return QString(R"(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+%1
+<style>
+:root { %2 }
+%3
+</style>
+</head>
+<body>
+<div id="content">)")
+                .arg(highlightCss(), styleVariables(style), pageCss());
+    }
+
+    inline static QString pageFooter() {
+        return QString(R"(</div>
+%1
+<script>hljs.highlightAll();</script>
+</body>
+</html>
+)")
+                .arg(highlightJs());
+    }
+
+    // 预览外壳：只加载一次，之后通过 setContentScript/setStyleScript 更新内容和样式
+    inline static QString buildShell() {
+        return QString(R"(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<base id="bunny-base" href="">
+%1
+<style>
+%2
+</style>
+</head>
+<body>
+<div id="content"></div>
+%3
+<script>
+window.bunny = {
+    setStyle: function (bg, fg, font, size) {
+        var s = document.documentElement.style;
+        s.setProperty('--bg', bg);
+        s.setProperty('--fg', fg);
+        s.setProperty('--font', "'" + font + "'");
+        s.setProperty('--font-size', size + 'pt');
+    },
+    setContent: function (html, baseUrl) {
+        document.getElementById('bunny-base').href = baseUrl;
+        document.getElementById('content').innerHTML = html;
+        if (window.hljs) {
+            document.querySelectorAll('pre code').forEach(function (el) { hljs.highlightElement(el); });
+        }
+    }
+};
+</script>
+</body>
+</html>
+)")
+                .arg(highlightCss(), pageCss(), highlightJs());
+    }
+
+    // 正文保持 UTF-8 直接转义成脚本，不经过 UTF-16
+    inline static QByteArray setContentScript(const QByteArray &html, const QString &baseUrl) {
+        QByteArray script;
+        script.reserve(html.size() + html.size() / 16 + 64);
+        script += "window.bunny.setContent(";
+        appendJsString(script, html);
+        script += ", ";
+        appendJsString(script, baseUrl.toUtf8());
+        script += ");";
+        return script;
+    }
+
+    inline static QString setStyleScript(const PageStyle &style) {
+        return QString("window.bunny.setStyle(%1, %2, %3, %4);")
+                .arg(jsString(style.backgroundColor), jsString(style.textColor), jsString(style.fontFamily),
+                     QString::number(style.fontSize));
+    }
+
+private:
+    // 转成 JavaScript 字符串字面量
+    inline static QString jsString(const QString &value) {
+        QByteArray json = QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact);
+        return QString::fromUtf8(json.mid(1, json.size() - 2));
+    }
+
+    // 按字节转义成 JavaScript 字符串字面量；多字节字符原样保留，只需处理 U+2028/U+2029
+    inline static void appendJsString(QByteArray &out, QByteArrayView value) {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        qsizetype run = 0;
+        for (qsizetype i = 0; i < value.size(); ++i) {
+            const auto c = static_cast<unsigned char>(value[i]);
+            const char *escape = nullptr;
+            if (c == '"') {
+                escape = "\\\"";
+            } else if (c == '\\') {
+                escape = "\\\\";
+            } else if (c == '\n') {
+                escape = "\\n";
+            } else if (c == '\r') {
+                escape = "\\r";
+            } else if (c == '\t') {
+                escape = "\\t";
+            } else if (c >= 0x20 && !(c == 0xE2 && i + 2 < value.size() && value[i + 1] == '\x80' &&
+                                       (value[i + 2] == '\xA8' || value[i + 2] == '\xA9'))) {
+                continue;
+            }
+            out.append(value.mid(run, i - run));
+            if (escape) {
+                out += escape;
+                run = i + 1;
+            } else if (c == 0xE2) {
+                out += value[i + 2] == '\xA8' ? "\\u2028" : "\\u2029";
+                i += 2;
+                run = i + 1;
+            } else {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xF];
+                run = i + 1;
+            }
+        }
+        out.append(value.mid(run));
+        out += '"';
+    }
+
+    inline static QString styleVariables(const PageStyle &style) {
+        return QString("--bg: %1; --fg: %2; --font: '%3'; --font-size: %4pt;")
+                .arg(style.backgroundColor, style.textColor, style.fontFamily, QString::number(style.fontSize));
+    }
+
+    // 引入 Highlight.js 的 CSS 和 JS
+    inline static QString highlightCss() {
+        return R"(<link rel="stylesheet" href="https://cdnjs.cloudflare.com/ajax/libs/highlight.js/11.7.0/styles/github.min.css">)";
+    }
+
+    inline static QString highlightJs() {
+        return R"(<script src="https://cdnjs.cloudflare.com/ajax/libs/highlight.js/11.7.0/highlight.min.js"></script>)";
+    }
+
+    inline static QString pageCss() {
+        return R"(
+body {
+    background-color: var(--bg);
+    color: var(--fg);
+    font-family: var(--font);
+    font-size: var(--font-size);
+    padding: 20px;
+    overflow-y: scroll;
+}
+.diagram {
+    margin: 1em 0;
+    text-align: center;
+}
+.diagram img {
+    max-width: 100%;
+}
+.diagram-error {
+    color: #c62828;
+    font-size: 0.9em;
+    white-space: pre-wrap;
+}
+math[display="block"] {
+    margin: 0.8em 0;
+    overflow-x: auto;
+}
+pre, code {
+    tab-size: 4;
+    -moz-tab-size: 4;
+    -o-tab-size: 4;
+}
+pre {
+    background-color: #f0f0f0;
+    color: #333333;
+    padding: 10px;
+    border-radius: 5px;
+    overflow: auto;
+}
+code {
+    background-color: #f0f0f0;
+    color: #333333;
+    padding: 2px 4px;
+    border-radius: 3px;
+}
+)";
+    }
+};
+
+#endif//QMARKDOWNEDITOR_PAGETEMPLATE_HPP
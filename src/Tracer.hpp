@@ -0,0 +1,155 @@
+#ifndef QMARKDOWNEDITOR_TRACER_HPP
+#define QMARKDOWNEDITOR_TRACER_HPP
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+struct TraceEvent {
+    const char *name;// 必须是静态字符串
+    qint64 startNs;
+    qint64 durationNs;
+    quintptr threadId;
+};
+
+struct TracePercentiles {
+    int count;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+};
+
+// 追踪：所有线程把耗时区间写入固定大小的无锁环形缓冲区，旧事件被覆盖
+class Tracer {
+public:
+    static constexpr quint64 Capacity = 16384;
+
+    inline static qint64 now() {
+        return clock().nsecsElapsed();
+    }
+
+    inline static void record(const char *name, qint64 startNs, qint64 endNs) {
+        const quint64 index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = ring[index % Capacity];
+        // 序号置 0 表示正在写入，读取方会跳过
+        slot.sequence.store(0, std::memory_order_relaxed);
+        // 保证读取方看到下面任何一个新值时也能看到序号 0（seqlock 写端）
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.startNs.store(startNs, std::memory_order_relaxed);
+        slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+        slot.threadId.store(reinterpret_cast<quintptr>(QThread::currentThreadId()), std::memory_order_relaxed);
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    // 按写入顺序复制缓冲区中完整的事件
+    inline static QVector<TraceEvent> snapshot() {
+        QVector<TraceEvent> events;
+        const quint64 end = writeIndex.load(std::memory_order_acquire);
+        const quint64 begin = end > Capacity ? end - Capacity : 0;
+        events.reserve(int(end - begin));
+        for (quint64 index = begin; index < end; ++index) {
+            const Slot &slot = ring[index % Capacity];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+                continue;
+            }
+            TraceEvent event{slot.name.load(std::memory_order_relaxed),
+                             slot.startNs.load(std::memory_order_relaxed),
+                             slot.durationNs.load(std::memory_order_relaxed),
+                             slot.threadId.load(std::memory_order_relaxed)};
+            // 复制期间被覆盖则丢弃；栅栏使上面的读取不会被排到再次检查序号之后（seqlock 读端）
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == index + 1) {
+                events.append(event);
+            }
+        }
+        return events;
+    }
+
+    inline static TracePercentiles percentiles(const char *name) {
+        QVector<qint64> durations;
+        for (const TraceEvent &event: snapshot()) {
+            if (std::strcmp(event.name, name) == 0) {
+                durations.append(event.durationNs);
+            }
+        }
+        if (durations.isEmpty()) {
+            return TracePercentiles{0, 0, 0, 0};
+        }
+        std::sort(durations.begin(), durations.end());
+        auto at = [&durations](double ratio) {
+            return durations[qMin(int(durations.size() * ratio), int(durations.size()) - 1)] / 1e6;
+        };
+        return TracePercentiles{int(durations.size()), at(0.50), at(0.95), at(0.99)};
+    }
+
+    // 导出为 Chrome trace_event JSON，可在 chrome://tracing 或 Perfetto 中打开
+    inline static QByteArray exportChromeTrace() {
+        QHash<quintptr, int> threadIds;
+        QJsonArray traceEvents;
+        for (const TraceEvent &event: snapshot()) {
+            int tid = threadIds.value(event.threadId, -1);
+            if (tid == -1) {
+                tid = threadIds.size() + 1;
+                threadIds.insert(event.threadId, tid);
+            }
+            QJsonObject item;
+            item["name"] = QString::fromUtf8(event.name);
+            item["ph"] = "X";
+            item["ts"] = event.startNs / 1000.0;
+            item["dur"] = event.durationNs / 1000.0;
+            item["pid"] = 1;
+            item["tid"] = tid;
+            traceEvents.append(item);
+        }
+        QJsonObject root;
+        root["traceEvents"] = traceEvents;
+        root["displayTimeUnit"] = "ms";
+        return QJsonDocument(root).toJson(QJsonDocument::Compact);
+    }
+
+private:
+    struct Slot {
+        std::atomic<quint64> sequence{0};
+        std::atomic<const char *> name{nullptr};
+        std::atomic<qint64> startNs{0};
+        std::atomic<qint64> durationNs{0};
+        std::atomic<quintptr> threadId{0};
+    };
+
+    inline static QElapsedTimer &clock() {
+        static QElapsedTimer timer = []() {
+            QElapsedTimer started;
+            started.start();
+            return started;
+        }();
+        return timer;
+    }
+
+    inline static Slot ring[Capacity];
+    inline static std::atomic<quint64> writeIndex{0};
+};
+
+// 作用域计时：构造时开始，析构时写入追踪缓冲区
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name) : name(name), startNs(Tracer::now()) {}
+    ~TraceSpan() { Tracer::record(name, startNs, Tracer::now()); }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name;
+    qint64 startNs;
+};
+
+#endif//QMARKDOWNEDITOR_TRACER_HPP
@@ -0,0 +1,145 @@
+#ifndef QMARKDOWNEDITOR_UTF8_HPP
+#define QMARKDOWNEDITOR_UTF8_HPP
+
+#include <QByteArray>
+#include <QtAlgorithms>
+#include <cmark.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BUNNY_UTF8_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BUNNY_UTF8_NEON
+#endif
+
+// 磁盘上读到的 Markdown 字节不一定是合法的 UTF-8。cmark 的 CMARK_OPT_VALIDATE_UTF8
+// 逐字节检查每一行，这里先用 SIMD 快速确认整个缓冲区合法，只有确实存在非法序列时才交给 cmark 修复
+class Utf8 {
+public:
+    // 合法前缀的长度，完全合法时等于 size
+    inline static qsizetype validPrefix(const char *data, qsizetype size) {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+        qsizetype i = 0;
+        while (i < size) {
+            i = skipAscii(bytes, i, size);
+            if (i >= size) {
+                break;
+            }
+            int length;
+            if (sequence(bytes, i, size, length) != Valid) {
+                return i;
+            }
+            i += length;
+        }
+        return size;
+    }
+
+    inline static bool isValid(const QByteArray &data) {
+        return validPrefix(data.constData(), data.size()) == data.size();
+    }
+
+    // 末尾不完整的多字节序列的长度（分块读取时留到下一块再检查）
+    inline static qsizetype incompleteTail(const char *data, qsizetype size) {
+        for (qsizetype back = 1; back <= 3 && back <= size; ++back) {
+            const auto c = static_cast<unsigned char>(data[size - back]);
+            if ((c & 0xC0) == 0x80) {
+                continue;// 后续字节，继续向前找首字节
+            }
+            const int expected = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+            return expected > back ? back : 0;
+        }
+        return 0;
+    }
+
+    // 解析不可信字节时使用的 cmark 选项：合法时省去 cmark 的逐行校验
+    inline static int parseOptions(const QByteArray &markdown, int options = CMARK_OPT_DEFAULT) {
+        return isValid(markdown) ? options : options | CMARK_OPT_VALIDATE_UTF8;
+    }
+
+    // 把每个非法序列的最大子段替换成 U+FFFD（与 QString::fromUtf8 的处理一致）
+    inline static QByteArray repaired(const char *data, qsizetype size) {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+        QByteArray result;
+        result.reserve(size + 16);
+        qsizetype i = 0;
+        while (i < size) {
+            qsizetype valid = validPrefix(data + i, size - i);
+            result.append(data + i, valid);
+            i += valid;
+            if (i >= size) {
+                break;
+            }
+            int length;
+            sequence(bytes, i, size, length);
+            result += "\xEF\xBF\xBD";
+            i += length;
+        }
+        return result;
+    }
+
+private:
+    enum { Valid, Invalid, Truncated };
+
+    // 跳过连续的 ASCII 字节，一次检查 16 字节的最高位
+    inline static qsizetype skipAscii(const unsigned char *bytes, qsizetype i, qsizetype size) {
+#if defined(BUNNY_UTF8_SSE2)
+        while (i + 16 <= size) {
+            int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i)));
+            if (mask) {
+                return i + qCountTrailingZeroBits(uint(mask));
+            }
+            i += 16;
+        }
+#elif defined(BUNNY_UTF8_NEON)
+        while (i + 16 <= size) {
+            if (vmaxvq_u8(vld1q_u8(bytes + i)) >= 0x80) {
+                break;
+            }
+            i += 16;
+        }
+#endif
+        while (i < size && bytes[i] < 0x80) {
+            ++i;
+        }
+        return i;
+    }
+
+    // 检查 bytes[i] 开始的多字节序列（Unicode 表 3-7）。
+    // 合法时 length 为序列长度，否则为需要替换的最大子段长度
+    inline static int sequence(const unsigned char *bytes, qsizetype i, qsizetype size, int &length) {
+        const unsigned char c = bytes[i];
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        int expected;
+        if (c >= 0xC2 && c <= 0xDF) {
+            expected = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            expected = 3;
+            low = c == 0xE0 ? 0xA0 : 0x80; // 过长编码
+            high = c == 0xED ? 0x9F : 0xBF;// 代理项
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            expected = 4;
+            low = c == 0xF0 ? 0x90 : 0x80;
+            high = c == 0xF4 ? 0x8F : 0xBF;// 超过 U+10FFFF
+        } else {
+            length = 1;
+            return Invalid;
+        }
+
+        length = 1;
+        for (int k = 1; k < expected; ++k) {
+            if (i + k >= size) {
+                return Truncated;
+            }
+            const unsigned char next = bytes[i + k];
+            if (k == 1 ? (next < low || next > high) : (next & 0xC0) != 0x80) {
+                return Invalid;
+            }
+            ++length;
+        }
+        return Valid;
+    }
+};
+
+#endif// QMARKDOWNEDITOR_UTF8_HPP
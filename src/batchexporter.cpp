@@ -0,0 +1,175 @@
+#include "batchexporter.h"
+#include "Utf8.hpp"
+#include "workstealingpool.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSemaphore>
+#include <QStringList>
+#include <atomic>
+#include <climits>
+#include <cmark.h>
+
+namespace {
+    struct OutputFormat {
+        int flag;
+        const char *suffix;
+    };
+
+    const OutputFormat outputFormats[] = {
+            {ExportHtml, ".html"},
+            {ExportLatex, ".tex"},
+            {ExportMan, ".1"},
+            {ExportCommonMark, ".md"},
+    };
+
+    char *renderAs(int flag, cmark_node *doc) {
+        switch (flag) {
+            case ExportHtml:
+                return cmark_render_html(doc, CMARK_OPT_DEFAULT);
+            case ExportLatex:
+                return cmark_render_latex(doc, CMARK_OPT_DEFAULT, 0);
+            case ExportMan:
+                return cmark_render_man(doc, CMARK_OPT_DEFAULT, 0);
+            default:
+                return cmark_render_commonmark(doc, CMARK_OPT_DEFAULT, 0);
+        }
+    }
+
+    bool writeFile(const QString &path, const QByteArray &data) {
+        QFile file(path);
+        if (!file.open(QFile::WriteOnly)) {
+            return false;
+        }
+        bool ok = file.write(data) == data.size();
+        file.close();
+        return ok;
+    }
+}
+
+QString ExportStats::summary() const {
+    return QString("导出 %1 个文件（失败 %2），耗时 %3 s，%4 files/s，%5 MB/s")
+            .arg(files)
+            .arg(failed)
+            .arg(seconds, 0, 'f', 2)
+            .arg(filesPerSecond(), 0, 'f', 1)
+            .arg(megabytesPerSecond(), 0, 'f', 2);
+}
+
+BatchExporter::BatchExporter(const QString &sourceDir, const QString &outputDir, int formats)
+    : sourceDir(sourceDir), outputDir(outputDir), formats(formats) {}
+
+int BatchExporter::parseFormats(const QString &list) {
+    int result = 0;
+    for (const QString &name: list.split(',', Qt::SkipEmptyParts)) {
+        QString format = name.trimmed().toLower();
+        if (format == "html") {
+            result |= ExportHtml;
+        } else if (format == "latex" || format == "tex") {
+            result |= ExportLatex;
+        } else if (format == "man") {
+            result |= ExportMan;
+        } else if (format == "commonmark" || format == "md") {
+            result |= ExportCommonMark;
+        } else {
+            return 0;
+        }
+    }
+    return result;
+}
+
+ExportStats BatchExporter::run(const std::function<void(int, int)> &progress, const std::function<bool()> &canceled) const {
+    QElapsedTimer timer;
+    timer.start();
+
+    QDir source(sourceDir);
+    QStringList files;
+    QDirIterator it(sourceDir, QStringList() << "*.md", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files.append(it.next());
+    }
+
+    int formatCount = 0;
+    for (const OutputFormat &format: outputFormats) {
+        formatCount += (formats & format.flag) ? 1 : 0;
+    }
+
+    // 以 KB 为单位的内存预算：读入、AST 与各格式输出都计入，超出预算的文件等待前面的写完
+    const int budgetKb = int(qBound<qint64>(1, memoryBudget / 1024, INT_MAX));
+    QSemaphore inFlight(budgetKb);
+
+    const QString outputRoot = QDir(outputDir).absolutePath();
+    std::atomic<int> done{0};
+    std::atomic<int> exported{0};
+    std::atomic<int> failed{0};
+    std::atomic<qint64> bytesIn{0};
+    std::atomic<qint64> bytesOut{0};
+
+    WorkStealingPool pool(threadCount);
+    pool.run(files.size(), [&](int index) {
+        if (canceled && canceled()) {
+            return;
+        }
+        const QString &path = files[index];
+        QFileInfo info(path);
+        const int cost = int(qMin<qint64>(info.size() * (4 + formatCount) / 1024 + 1, budgetKb));
+        inFlight.acquire(cost);
+
+        bool ok = false;
+        QFile file(path);
+        if (file.open(QFile::ReadOnly)) {
+            QByteArray markdown = file.readAll();
+            file.close();
+            bytesIn += markdown.size();
+
+            // 只有确实含非法 UTF-8 的文件才让 cmark 逐行校验
+            cmark_node *doc = cmark_parse_document(markdown.constData(), markdown.size(), Utf8::parseOptions(markdown));
+            QString relativeDir = QFileInfo(source.relativeFilePath(path)).path();
+            QString base = QDir::cleanPath(outputRoot + "/" + relativeDir + "/" + info.completeBaseName());
+            QDir().mkpath(QFileInfo(base).absolutePath());
+
+            ok = true;
+            for (const OutputFormat &format: outputFormats) {
+                if (!(formats & format.flag)) {
+                    continue;
+                }
+                QString target = base + format.suffix;
+                if (QFileInfo(target).absoluteFilePath() == info.absoluteFilePath()) {
+                    continue;// 输出目录与源目录相同时不覆盖源文件
+                }
+                char *rendered = renderAs(format.flag, doc);
+                QByteArray data = format.flag == ExportHtml
+                                          ? PageTemplate::buildPage(QString::fromUtf8(rendered), pageStyle).toUtf8()
+                                          : QByteArray(rendered);
+                free(rendered);
+                if (writeFile(target, data)) {
+                    bytesOut += data.size();
+                } else {
+                    ok = false;
+                }
+            }
+            cmark_node_free(doc);
+        }
+
+        inFlight.release(cost);
+        if (ok) {
+            ++exported;
+        } else {
+            ++failed;
+        }
+        int count = ++done;
+        if (progress) {
+            progress(count, files.size());
+        }
+    });
+
+    ExportStats stats;
+    stats.files = exported;
+    stats.failed = failed;
+    stats.bytesIn = bytesIn;
+    stats.bytesOut = bytesOut;
+    stats.seconds = timer.nsecsElapsed() / 1e9;
+    return stats;
+}
@@ -0,0 +1,52 @@
+#ifndef QMARKDOWNEDITOR_BATCHEXPORTER_H
+#define QMARKDOWNEDITOR_BATCHEXPORTER_H
+
+#include "PageTemplate.hpp"
+#include <QString>
+#include <functional>
+
+enum ExportFormat {
+    ExportHtml = 1 << 0,
+    ExportLatex = 1 << 1,
+    ExportMan = 1 << 2,
+    ExportCommonMark = 1 << 3
+};
+
+struct ExportStats {
+    int files = 0;       // 成功导出的文件数
+    int failed = 0;      // 读写失败的文件数
+    qint64 bytesIn = 0;  // 读取的 Markdown 字节数
+    qint64 bytesOut = 0; // 写出的字节数
+    double seconds = 0;
+
+    double filesPerSecond() const { return seconds > 0 ? files / seconds : 0; }
+    double megabytesPerSecond() const { return seconds > 0 ? bytesIn / (1024.0 * 1024.0) / seconds : 0; }
+    QString summary() const;
+};
+
+// 批量导出：解析目录下所有 .md 文件并用 cmark 渲染为多种格式，使用工作窃取线程池并行处理
+class BatchExporter {
+public:
+    BatchExporter(const QString &sourceDir, const QString &outputDir, int formats);
+
+    void setThreadCount(int count) { threadCount = count; }
+    void setMemoryBudget(qint64 bytes) { memoryBudget = bytes; }// 同时处理中的文件占用内存上限
+    void setPageStyle(const PageStyle &style) { pageStyle = style; }
+
+    // 阻塞执行，progress 和 canceled 在工作线程中调用；canceled 返回 true 后剩下的文件不再导出
+    ExportStats run(const std::function<void(int done, int total)> &progress = {},
+                    const std::function<bool()> &canceled = {}) const;
+
+    // 解析 "html,latex,man,commonmark" 形式的格式列表，无法识别时返回 0
+    static int parseFormats(const QString &list);
+
+private:
+    QString sourceDir;
+    QString outputDir;
+    int formats;
+    int threadCount = 0;
+    qint64 memoryBudget = 256 * 1024 * 1024;
+    PageStyle pageStyle = PageTemplate::defaultStyle();
+};
+
+#endif// QMARKDOWNEDITOR_BATCHEXPORTER_H
@@ -0,0 +1,259 @@
+#include "blocksplitter.h"
+#include <QByteArrayView>
+#include <QRegularExpression>
+#include <QString>
+
+namespace {
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    bool isBlank(QByteArrayView line) {
+        for (char c: line) {
+            if (!isSpace(c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 行首缩进的列数；制表符直接视为缩进代码
+    int indentOf(QByteArrayView line) {
+        int indent = 0;
+        for (char c: line) {
+            if (c == ' ') {
+                ++indent;
+            } else if (c == '\t') {
+                return indent + 4;
+            } else {
+                break;
+            }
+        }
+        return indent;
+    }
+
+    // 围栏代码块的开始或结束行，返回围栏字符和长度
+    bool fenceRun(QByteArrayView line, int indent, char &fenceChar, qsizetype &length) {
+        if (indent > 3 || indent >= line.size()) {
+            return false;
+        }
+        char c = line[indent];
+        if (c != '`' && c != '~') {
+            return false;
+        }
+        qsizetype run = 0;
+        while (indent + run < line.size() && line[indent + run] == c) {
+            ++run;
+        }
+        if (run < 3 || (c == '`' && line.sliced(indent + run).contains('`'))) {
+            return false;
+        }
+        fenceChar = c;
+        length = run;
+        return true;
+    }
+
+    // 列表项和引用块的开头
+    bool startsContainer(QByteArrayView line) {
+        char c = line[0];
+        if (c == '>') {
+            return true;
+        }
+        if (c == '-' || c == '+' || c == '*') {
+            return line.size() == 1 || isSpace(line[1]);
+        }
+        qsizetype digits = 0;
+        while (digits < line.size() && digits < 10 && line[digits] >= '0' && line[digits] <= '9') {
+            ++digits;
+        }
+        if (digits == 0 || digits > 9 || digits >= line.size() || (line[digits] != '.' && line[digits] != ')')) {
+            return false;
+        }
+        return digits + 1 == line.size() || isSpace(line[digits + 1]);
+    }
+
+    // 可以包含空行的 HTML 块（CommonMark 类型 1–5）：行首为开始标记时返回结束标记
+    const char *htmlBlockEnd(QByteArrayView line) {
+        if (line.isEmpty() || line[0] != '<') {
+            return nullptr;
+        }
+        struct RawTag {
+            const char *open;
+            const char *close;
+        };
+        static const RawTag rawTags[] = {
+                {"<script", "</script>"}, {"<pre", "</pre>"}, {"<style", "</style>"}, {"<textarea", "</textarea>"}};
+
+        QByteArray lower = line.toByteArray().toLower();
+        const char *end = nullptr;
+        qsizetype startLength = 0;
+        for (const RawTag &tag: rawTags) {
+            qsizetype openLength = qstrlen(tag.open);
+            if (lower.startsWith(tag.open) && (lower.size() == openLength || lower[openLength] == '>' || isSpace(lower[openLength]))) {
+                end = tag.close;
+                startLength = openLength;
+                break;
+            }
+        }
+        if (!end) {
+            if (line.startsWith("<!--")) {
+                end = "-->";
+                startLength = 4;
+            } else if (line.startsWith("<?")) {
+                end = "?>";
+                startLength = 2;
+            } else if (line.startsWith("<![CDATA[")) {
+                end = "]]>";
+                startLength = 9;
+            } else if (line.size() > 2 && line[1] == '!' && ((line[2] >= 'A' && line[2] <= 'Z') || (line[2] >= 'a' && line[2] <= 'z'))) {
+                end = ">";
+                startLength = 2;
+            } else {
+                return nullptr;
+            }
+        }
+        // 开始行本身包含结束标记时块已经结束
+        return lower.indexOf(end, startLength) == -1 ? end : nullptr;
+    }
+
+    // 单行的链接引用定义：[label]: destination "title"
+    bool isSimpleReference(QByteArrayView line) {
+        static const QRegularExpression pattern(
+                R"(^ {0,3}\[((?:[^\[\]\\]|\\.)+)\]:[ \t]*(<[^<>\n]*>|[^ \t<][^ \t]*)(?:[ \t]+("[^"]*"|'[^']*'|\([^()]*\)))?[ \t\r]*$)");
+        QRegularExpressionMatch match = pattern.match(QString::fromUtf8(line));
+        if (!match.hasMatch() || match.captured(1).trimmed().isEmpty() || match.captured(1).size() > 999) {
+            return false;
+        }
+        // 不带尖括号的地址中括号必须配对
+        QString destination = match.captured(2);
+        if (!destination.startsWith('<')) {
+            int depth = 0;
+            for (qsizetype i = 0; i < destination.size(); ++i) {
+                if (destination[i] == '\\') {
+                    ++i;
+                } else if (destination[i] == '(') {
+                    ++depth;
+                } else if (destination[i] == ')' && --depth < 0) {
+                    return false;
+                }
+            }
+            if (depth != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool BlockSplitter::split(const QByteArray &markdown, qsizetype chunkBytes, BlockSplit &split) {
+    split.offsets.clear();
+    split.references.clear();
+
+    // 单独的 \r 也是换行符，按 \n 分行时会看错结构
+    for (qsizetype i = markdown.indexOf('\r'); i != -1; i = markdown.indexOf('\r', i + 1)) {
+        if (i + 1 >= markdown.size() || markdown[i + 1] != '\n') {
+            return false;
+        }
+    }
+
+    // BOM 只在文档开头有效，不能跟在拼接的引用定义后面
+    qsizetype begin = markdown.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+    split.offsets.append(begin);
+
+    char fenceChar = 0;
+    qsizetype fenceLength = 0;   // 非 0 表示在围栏代码块中
+    const char *htmlEnd = nullptr;// 非空表示在类型 1–5 的 HTML 块中
+    bool rawHtml = false;         // 以 < 开头、到空行为止的段落或 HTML 块，其中不能判断围栏
+    bool previousBlank = true;
+    bool previousReference = false;
+    qsizetype nextSplit = begin + chunkBytes;
+
+    const qsizetype size = markdown.size();
+    for (qsizetype lineStart = begin; lineStart < size;) {
+        qsizetype lineEnd = markdown.indexOf('\n', lineStart);
+        if (lineEnd == -1) {
+            lineEnd = size;
+        }
+        QByteArrayView line(markdown.constData() + lineStart, lineEnd - lineStart);
+        const qsizetype start = lineStart;
+        lineStart = lineEnd + 1;
+
+        if (fenceLength > 0) {
+            char c;
+            qsizetype length;
+            if (fenceRun(line, indentOf(line), c, length) && c == fenceChar && length >= fenceLength &&
+                isBlank(line.sliced(indentOf(line) + length))) {
+                fenceLength = 0;
+            }
+            previousBlank = false;
+            continue;
+        }
+        if (htmlEnd) {
+            if (line.toByteArray().toLower().contains(htmlEnd)) {
+                htmlEnd = nullptr;
+            }
+            previousBlank = false;
+            continue;
+        }
+        if (isBlank(line)) {
+            previousBlank = true;
+            rawHtml = false;
+            continue;
+        }
+
+        const int indent = indentOf(line);
+        if (previousReference && indent <= 3 && !line.contains("]:")) {
+            // 下一行的标题属于上一行的引用定义
+            char first = line[indent];
+            if (first == '"' || first == '\'' || first == '(') {
+                return false;
+            }
+        }
+
+        // 空行之后顶格、且不是列表项或引用的行：之前的所有容器都已结束
+        if (previousBlank && indent == 0 && start >= nextSplit && !startsContainer(line)) {
+            split.offsets.append(start);
+            nextSplit = start + chunkBytes;
+        }
+        const bool paragraphStart = previousBlank || previousReference;
+        previousBlank = false;
+        previousReference = false;
+
+        char c;
+        qsizetype length;
+        if (fenceRun(line, indent, c, length)) {
+            // 缩进的围栏可能属于列表项，顶格以外的情况无法确定何时结束
+            if (indent > 0 || rawHtml) {
+                return false;
+            }
+            fenceChar = c;
+            fenceLength = length;
+            continue;
+        }
+
+        if (indent <= 3 && line.sliced(indent).startsWith('<')) {
+            const char *end = htmlBlockEnd(line.sliced(indent));
+            if (end && indent > 0) {
+                return false;
+            }
+            htmlEnd = end;
+            rawHtml = true;
+            continue;
+        }
+
+        if (line.contains("]:")) {
+            // 只接受顶层、段落开头的单行定义，其他形式（容器内、跨行）整体解析
+            if (!paragraphStart || !isSimpleReference(line)) {
+                return false;
+            }
+            split.references += line;
+            split.references += '\n';
+            previousReference = true;
+        }
+    }
+
+    if (!split.references.isEmpty()) {
+        split.references += '\n';
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+#ifndef QMARKDOWNEDITOR_BLOCKSPLITTER_H
+#define QMARKDOWNEDITOR_BLOCKSPLITTER_H
+
+#include <QByteArray>
+#include <QVector>
+
+struct BlockSplit {
+    QVector<qsizetype> offsets;// 每一块的起始字节偏移（升序，第一项是正文开头）
+    QByteArray references;     // 文档中全部的链接引用定义，拼在每一块前面解析
+};
+
+// 把大文档切成可以独立解析的块：每个切分点都是空行之后、顶格开始的新块，
+// 且不在围栏代码块、HTML 注释/脚本等跨行块、列表和引用之内。
+// 各块分别解析再拼接 HTML，结果与整体解析完全相同
+class BlockSplitter {
+public:
+    // 在每隔 chunkBytes 之后的第一个安全边界切分；遇到无法确定的结构时返回 false，调用方应整体解析
+    static bool split(const QByteArray &markdown, qsizetype chunkBytes, BlockSplit &split);
+};
+
+#endif// QMARKDOWNEDITOR_BLOCKSPLITTER_H
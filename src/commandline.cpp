@@ -0,0 +1,104 @@
+#include "commandline.h"
+#include "HtmlConverter.hpp"
+#include "PageTemplate.hpp"
+#include "batchexporter.h"
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <cstdio>
+#include <cstring>
+
+bool CommandLine::isHeadless(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        // QCommandLineParser 也接受 --render=in.md 的写法
+        if (std::strcmp(argv[i], "--render") == 0 || std::strcmp(argv[i], "--export") == 0 ||
+            std::strncmp(argv[i], "--render=", 9) == 0 || std::strncmp(argv[i], "--export=", 9) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int CommandLine::run(const QStringList &arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bunny Note 命令行渲染");
+    parser.addHelpOption();
+
+    QCommandLineOption renderOption("render", "将 Markdown 渲染为 HTML，- 表示标准输入。", "input");
+    QCommandLineOption exportOption("export", "批量导出目录下的所有 .md 文件。", "dir");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "输出文件（--render，缺省为标准输出）或输出目录（--export）。", "output");
+    QCommandLineOption fragmentOption("fragment", "只输出 HTML 片段，不套用页面模板。");
+    QCommandLineOption formatsOption("formats", "导出格式：html,latex,man,commonmark。", "list", "html");
+    QCommandLineOption threadsOption("threads", "导出线程数，0 表示使用 CPU 核心数。", "n", "0");
+    QCommandLineOption parallelOption("parallel", "--render 大文件时整个读入并多线程解析（更快，但不再是恒定内存）。");
+    parser.addOptions({renderOption, exportOption, outputOption, fragmentOption, formatsOption, threadsOption, parallelOption});
+    parser.process(arguments);
+
+    if (parser.isSet(exportOption)) {
+        if (!parser.isSet(outputOption)) {
+            QTextStream(stderr) << "--export 需要用 -o 指定输出目录\n";
+            return 2;
+        }
+        return exportDirectory(parser.value(exportOption), parser.value(outputOption),
+                               parser.value(formatsOption), parser.value(threadsOption).toInt());
+    }
+    return render(parser.value(renderOption), parser.value(outputOption), parser.isSet(fragmentOption), parser.isSet(parallelOption));
+}
+
+int CommandLine::render(const QString &input, const QString &output, bool fragment, bool parallel) {
+    QFile in;
+    bool opened;
+    if (input == "-") {
+        opened = in.open(stdin, QIODevice::ReadOnly);
+    } else {
+        in.setFileName(input);
+        opened = in.open(QIODevice::ReadOnly);
+    }
+    if (!opened) {
+        QTextStream(stderr) << "无法打开输入文件: " << input << "\n";
+        return 1;
+    }
+
+    QFile out;
+    if (output.isEmpty() || output == "-") {
+        opened = out.open(stdout, QIODevice::WriteOnly);
+    } else {
+        out.setFileName(output);
+        opened = out.open(QIODevice::WriteOnly);
+    }
+    if (!opened) {
+        QTextStream(stderr) << "无法打开输出文件: " << output << "\n";
+        return 1;
+    }
+
+    // 与编辑器预览使用同一个转换器和页面模板；HTML 边渲染边写出。
+    // 任何一步读写失败（磁盘满、管道关闭）都返回非零，构建流程不会拿到截断的文件
+    auto writeAll = [&out](const QByteArray &data) { return out.write(data) == data.size(); };
+    bool ok = fragment || writeAll(PageTemplate::pageHeader(PageTemplate::defaultStyle()).toUtf8());
+    ok = ok && HtmlConverter::convertStream(&in, &out, parallel);
+    ok = ok && (fragment || writeAll(PageTemplate::pageFooter().toUtf8()));
+    ok = ok && out.flush();
+    out.close();
+    if (!ok || in.error() != QFileDevice::NoError || out.error() != QFileDevice::NoError) {
+        const QString reason = in.error() != QFileDevice::NoError ? "读取 " + input + " 失败: " + in.errorString()
+                                                                : "写入 " + (output.isEmpty() ? QString("-") : output) + " 失败: " + out.errorString();
+        QTextStream(stderr) << reason << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int CommandLine::exportDirectory(const QString &sourceDir, const QString &outputDir, const QString &formatList, int threads) {
+    int formats = BatchExporter::parseFormats(formatList);
+    if (!formats) {
+        QTextStream(stderr) << "无法识别的导出格式: " << formatList << "\n";
+        return 2;
+    }
+
+    BatchExporter exporter(sourceDir, outputDir, formats);
+    exporter.setThreadCount(threads);
+    ExportStats stats = exporter.run();
+    QTextStream(stderr) << stats.summary() << "\n";
+    return stats.failed == 0 ? 0 : 1;
+}
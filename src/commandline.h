@@ -0,0 +1,21 @@
+#ifndef QMARKDOWNEDITOR_COMMANDLINE_H
+#define QMARKDOWNEDITOR_COMMANDLINE_H
+
+#include <QStringList>
+
+// 无界面的命令行模式：
+//   BunnyNote --render in.md -o out.html   渲染单个文件（输入为 - 时读标准输入，缺省 -o 时写标准输出），
+//                                          默认流式解析、内存占用恒定，--parallel 对大文件改用多线程解析
+//   BunnyNote --export notes/ -o site/ --formats html,latex   批量导出目录
+// 只依赖 QCoreApplication，不初始化 Widgets 和 WebEngine
+class CommandLine {
+public:
+    static bool isHeadless(int argc, char *argv[]);
+    static int run(const QStringList &arguments);
+
+private:
+    static int render(const QString &input, const QString &output, bool fragment, bool parallel);
+    static int exportDirectory(const QString &sourceDir, const QString &outputDir, const QString &formatList, int threads);
+};
+
+#endif// QMARKDOWNEDITOR_COMMANDLINE_H
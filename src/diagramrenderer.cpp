@@ -0,0 +1,235 @@
+#include "diagramrenderer.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QProcess>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrent>
+
+DiagramRenderer::DiagramRenderer(QObject *parent) : QObject(parent) {
+    cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/diagrams";
+    QDir().mkpath(cacheDir);
+    // 渲染器（尤其是 mmdc）启动很重，同时最多运行两个
+    renderPool.setMaxThreadCount(2);
+}
+
+QString DiagramRenderer::language(const char *fenceInfo) {
+    // 信息字符串的第一个词是语言，例如 ```mermaid 或 ```dot {scale=2}；
+    // 与 cmark 生成 class 属性时一样，以任意空白分词
+    QString info = QString::fromUtf8(fenceInfo).trimmed();
+    for (qsizetype i = 0; i < info.size(); ++i) {
+        if (info[i].isSpace()) {
+            info.truncate(i);
+            break;
+        }
+    }
+    info = info.toLower();
+    if (info == "mermaid") {
+        return "mermaid";
+    }
+    if (info == "dot" || info == "graphviz") {
+        return "dot";
+    }
+    return QString();
+}
+
+QVector<DiagramSource> DiagramRenderer::collect(cmark_node *document) {
+    QVector<DiagramSource> diagrams;
+    cmark_iter *iter = cmark_iter_new(document);
+    cmark_event_type event;
+    while ((event = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+        cmark_node *node = cmark_iter_get_node(iter);
+        if (event != CMARK_EVENT_ENTER || cmark_node_get_type(node) != CMARK_NODE_CODE_BLOCK) {
+            continue;
+        }
+        const char *info = cmark_node_get_fence_info(node);
+        QString lang = info ? language(info) : QString();
+        if (!lang.isEmpty()) {
+            diagrams.append(DiagramSource{lang, QString::fromUtf8(cmark_node_get_literal(node))});
+        }
+    }
+    cmark_iter_free(iter);
+    return diagrams;
+}
+
+QString DiagramRenderer::cacheKey(const DiagramSource &diagram) const {
+    QByteArray content = diagram.language.toUtf8() + '\0' + diagram.source.toUtf8();
+    return QString::fromLatin1(QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex());
+}
+
+QString DiagramRenderer::renderer(const QString &language) const {
+    QString name = language == "mermaid" ? "mmdc" : "dot";
+    // 优先使用随程序一起分发的渲染器
+    QString bundled = QStandardPaths::findExecutable(name, {QCoreApplication::applicationDirPath() + "/tools"});
+    return bundled.isEmpty() ? QStandardPaths::findExecutable(name) : bundled;
+}
+
+QByteArray DiagramRenderer::insertDiagrams(const QByteArray &html, const QVector<DiagramSource> &diagrams) {
+    wanted.clear();
+    if (diagrams.isEmpty()) {
+        return html;
+    }
+
+    // 图表代码块在 HTML 中的顺序与 AST 中一致
+    const QByteArrayView openTag(R"(<pre><code class="language-)");
+    const QByteArrayView closeTag("</code></pre>");
+    QByteArray result;
+    result.reserve(html.size());
+    qsizetype last = 0;
+    qsizetype from = 0;
+    int index = 0;
+    qsizetype start;
+    QHash<QString, bool> installed;// 本次检查过的渲染器
+    while (index < diagrams.size() && (start = html.indexOf(openTag, from)) != -1) {
+        qsizetype classEnd = html.indexOf("\">", start + openTag.size());
+        if (classEnd == -1) {
+            break;
+        }
+        from = classEnd;
+        QByteArray lang = html.mid(start + openTag.size(), classEnd - start - openTag.size());
+        if (language(lang.constData()).isEmpty()) {
+            continue;
+        }
+        qsizetype end = html.indexOf(closeTag, classEnd);
+        if (end == -1) {
+            break;
+        }
+        end += closeTag.size();
+        from = end;
+
+        const DiagramSource &diagram = diagrams[index++];
+        QString key = cacheKey(diagram);
+        wanted.insert(key);
+
+        auto found = results.constFind(key);
+        if (found != results.constEnd() && found->toolMissing) {
+            auto checked = installed.find(diagram.language);
+            if (checked == installed.end()) {
+                checked = installed.insert(diagram.language, !renderer(diagram.language).isEmpty());
+            }
+            if (*checked) {
+                results.remove(key);// 渲染器已经装好，重新渲染
+                found = results.constEnd();
+            }
+        }
+        if (found == results.constEnd()) {
+            // 以前渲染过的图表直接从磁盘缓存读取，重新打开文档时立即显示
+            QString svgPath = cacheDir + "/" + key + ".svg";
+            if (QFileInfo::exists(svgPath)) {
+                found = results.insert(key, Result{svgPath, QString()});
+            } else if (!queued.contains(key)) {
+                queued.insert(key);
+                queue.append(Job{key, diagram});
+            }
+        }
+
+        result.append(QByteArrayView(html).mid(last, start - last));
+        if (found != results.constEnd() && !found->svgPath.isEmpty()) {
+            result += QString(R"(<div class="diagram"><img src="%1" alt="%2"></div>)")
+                              .arg(QUrl::fromLocalFile(found->svgPath).toString(QUrl::FullyEncoded), diagram.language)
+                              .toUtf8();
+        } else {
+            // 渲染完成前（或失败时）显示源码
+            result.append(QByteArrayView(html).mid(start, end - start));
+            if (found != results.constEnd()) {
+                result += QString(R"(<div class="diagram-error">%1</div>)").arg(found->error.toHtmlEscaped()).toUtf8();
+            }
+        }
+        last = end;
+    }
+    result.append(QByteArrayView(html).mid(last));
+
+    startJobs();
+    return result;
+}
+
+void DiagramRenderer::startJobs() {
+    while (running < 2 && !queue.isEmpty()) {
+        Job job = queue.takeFirst();
+        if (!wanted.contains(job.key)) {
+            queued.remove(job.key);// 编辑过程中的中间版本，不再需要
+            continue;
+        }
+
+        QString program = renderer(job.diagram.language);
+        if (program.isEmpty()) {
+            queued.remove(job.key);
+            results.insert(job.key, Result{QString(), QString("未找到 %1 渲染器（%2）").arg(job.diagram.language,
+                                                                                  job.diagram.language == "mermaid" ? "mmdc" : "dot"),
+                                           true});
+            emit diagramsChanged();
+            continue;
+        }
+
+        ++running;
+        auto *watcher = new QFutureWatcher<Result>(this);
+        connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher, key = job.key]() {
+            --running;
+            queued.remove(key);
+            results.insert(key, watcher->result());
+            watcher->deleteLater();
+            if (wanted.contains(key)) {
+                emit diagramsChanged();
+            }
+            startJobs();
+        });
+        watcher->setFuture(QtConcurrent::run(&renderPool, &DiagramRenderer::render, job, program, cacheDir + "/" + job.key + ".svg"));
+    }
+}
+
+DiagramRenderer::Result DiagramRenderer::failure(QProcess &process) {
+    QString message = QString::fromUtf8(process.readAllStandardError()).trimmed();
+    if (message.isEmpty()) {
+        message = process.errorString();// 启动失败或超时
+    }
+    process.kill();
+    process.waitForFinished(1000);
+    return Result{QString(), message};
+}
+
+DiagramRenderer::Result DiagramRenderer::render(const Job &job, const QString &program, const QString &svgPath) {
+    QProcess process;
+    QByteArray svg;
+    if (job.diagram.language == "dot") {
+        process.start(program, {"-Tsvg"});
+        process.write(job.diagram.source.toUtf8());
+        process.closeWriteChannel();
+        if (!process.waitForFinished(30000) || process.exitCode() != 0) {
+            return failure(process);
+        }
+        svg = process.readAllStandardOutput();
+    } else {
+        // mmdc 只能读写文件
+        QTemporaryDir temp;
+        QFile input(temp.filePath("diagram.mmd"));
+        if (!input.open(QFile::WriteOnly)) {
+            return Result{QString(), "无法写入临时文件"};
+        }
+        input.write(job.diagram.source.toUtf8());
+        input.close();
+        QString output = temp.filePath("diagram.svg");
+        process.start(program, {"-i", input.fileName(), "-o", output, "-b", "transparent"});
+        if (!process.waitForFinished(60000) || process.exitCode() != 0) {
+            return failure(process);
+        }
+        QFile file(output);
+        if (file.open(QFile::ReadOnly)) {
+            svg = file.readAll();
+        }
+    }
+
+    if (svg.isEmpty()) {
+        return Result{QString(), "渲染器没有输出"};
+    }
+    QSaveFile file(svgPath);
+    if (!file.open(QFile::WriteOnly) || file.write(svg) != svg.size() || !file.commit()) {
+        return Result{QString(), "无法写入缓存"};
+    }
+    return Result{svgPath, QString()};
+}
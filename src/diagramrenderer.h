@@ -0,0 +1,64 @@
+#ifndef QMARKDOWNEDITOR_DIAGRAMRENDERER_H
+#define QMARKDOWNEDITOR_DIAGRAMRENDERER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QProcess>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <cmark.h>
+
+struct DiagramSource {
+    QString language;// mermaid / dot
+    QString source;
+};
+
+// 图表代码块：```mermaid / ```dot 在后台用本地渲染器转换成 SVG，结果按内容哈希缓存在磁盘上
+class DiagramRenderer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DiagramRenderer(QObject *parent = nullptr);
+
+    // 遍历 AST，按文档顺序收集图表代码块（根据 cmark_node_get_fence_info 判断）
+    static QVector<DiagramSource> collect(cmark_node *document);
+
+    // 把 UTF-8 HTML 中对应的代码块替换成已渲染的 SVG；尚未渲染的保留代码并在后台渲染
+    QByteArray insertDiagrams(const QByteArray &html, const QVector<DiagramSource> &diagrams);
+
+signals:
+    // 有图表渲染完成，预览需要刷新
+    void diagramsChanged();
+
+private:
+    struct Job {
+        QString key;
+        DiagramSource diagram;
+    };
+    struct Result {
+        QString svgPath;// 成功时为缓存文件
+        QString error;
+        bool toolMissing = false;// 没有找到渲染器：每次重新检查，装好后不必重启
+    };
+
+    static QString language(const char *fenceInfo);
+    QString cacheKey(const DiagramSource &diagram) const;
+    QString renderer(const QString &language) const;
+    void startJobs();
+    static Result render(const Job &job, const QString &program, const QString &svgPath);
+    static Result failure(QProcess &process);
+
+    QString cacheDir;
+    QHash<QString, Result> results;// 只在 GUI 线程访问
+    QSet<QString> queued;
+    QList<Job> queue;
+    QSet<QString> wanted;// 当前预览中的图表，切走后排队的任务不再执行
+    int running = 0;
+    QThreadPool renderPool;// 渲染器进程可能阻塞几十秒，不占用全局线程池
+};
+
+#endif// QMARKDOWNEDITOR_DIAGRAMRENDERER_H
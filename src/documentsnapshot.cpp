@@ -0,0 +1,139 @@
+#include "documentsnapshot.h"
+#include "Tracer.hpp"
+#include "blocksplitter.h"
+#include "workstealingpool.h"
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+DocumentSnapshot::~DocumentSnapshot() {
+    for (const Part &part: roots) {
+        cmark_node_free(part.root);
+    }
+}
+
+DocumentSnapshotPtr DocumentSnapshot::parse(const QByteArray &markdown, quint64 revision, int options) {
+    if (markdown.size() >= ParallelThreshold) {
+        return parseChunked(markdown, ChunkBytes, revision, options);
+    }
+    return parseSerial(markdown, revision, options);
+}
+
+DocumentSnapshotPtr DocumentSnapshot::parseSerial(const QByteArray &markdown, quint64 revision, int options) {
+    qint64 start = Tracer::now();
+    QSharedPointer<DocumentSnapshot> snapshot(new DocumentSnapshot);
+    snapshot->text = markdown;
+    snapshot->rev = revision;
+    snapshot->roots.append(Part{cmark_parse_document(markdown.constData(), markdown.size(), options), 0});
+    Tracer::record("parse", start, Tracer::now());
+    return snapshot;
+}
+
+DocumentSnapshotPtr DocumentSnapshot::parseChunked(const QByteArray &markdown, qsizetype chunkBytes, quint64 revision, int options) {
+    qint64 start = Tracer::now();
+    BlockSplit split;
+    if (!BlockSplitter::split(markdown, chunkBytes, split) || split.offsets.size() < 2) {
+        return parseSerial(markdown, revision, options);
+    }
+    Tracer::record("block split", start, Tracer::now());
+
+    const int count = int(split.offsets.size());
+    QSharedPointer<DocumentSnapshot> snapshot(new DocumentSnapshot);
+    snapshot->text = markdown;
+    snapshot->rev = revision;
+    snapshot->roots.resize(count);
+
+    // 每一块前面拼上了全部引用定义，块内行号要减去这些行
+    const int referenceLines = int(std::count(split.references.cbegin(), split.references.cend(), '\n'));
+    int linesBefore = 0;
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            const char *data = markdown.constData();
+            linesBefore += int(std::count(data + split.offsets[i - 1], data + split.offsets[i], '\n'));
+        }
+        snapshot->roots[i].lineOffset = linesBefore - referenceLines;
+    }
+
+    start = Tracer::now();
+    WorkStealingPool pool;
+    pool.run(count, [&](int i) {
+        qsizetype begin = split.offsets[i];
+        qsizetype end = i + 1 < count ? split.offsets[i + 1] : markdown.size();
+        QByteArray chunk;
+        chunk.reserve(split.references.size() + end - begin);
+        chunk.append(split.references).append(markdown.constData() + begin, end - begin);
+        snapshot->roots[i].root = cmark_parse_document(chunk.constData(), chunk.size(), options);
+    });
+    Tracer::record("parse", start, Tracer::now());
+    return snapshot;
+}
+
+void DocumentSnapshot::walk(const std::function<void(cmark_node *, cmark_event_type, int)> &visit) const {
+    for (const Part &part: roots) {
+        cmark_iter *iter = cmark_iter_new(part.root);
+        cmark_event_type event;
+        while ((event = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+            cmark_node *node = cmark_iter_get_node(iter);
+            if (node != part.root) {
+                visit(node, event, part.lineOffset);
+            }
+        }
+        cmark_iter_free(iter);
+    }
+}
+
+int DocumentSnapshot::wordCount() const {
+    int words = 0;
+    walk([&words](cmark_node *node, cmark_event_type event, int) {
+        cmark_node_type type = cmark_node_get_type(node);
+        if (event != CMARK_EVENT_ENTER || (type != CMARK_NODE_TEXT && type != CMARK_NODE_CODE && type != CMARK_NODE_CODE_BLOCK)) {
+            return;
+        }
+        bool inWord = false;
+        for (uint code: QString::fromUtf8(cmark_node_get_literal(node)).toUcs4()) {
+            const QChar::Script script = QChar::script(code);
+            if (script == QChar::Script_Han || script == QChar::Script_Hiragana || script == QChar::Script_Katakana
+                || script == QChar::Script_Hangul) {
+                ++words;
+                inWord = false;
+            } else if (QChar::isLetterOrNumber(code)) {
+                words += inWord ? 0 : 1;
+                inWord = true;
+            } else if (!inWord || (code != '\'' && code != 0x2019)) {
+                inWord = false;// 词中的撇号（don't）不拆开
+            }
+        }
+    });
+    return words;
+}
+
+QFuture<DocumentSnapshotPtr> SnapshotService::request(const QString &document, quint64 revision,
+                                                      const std::function<QByteArray()> &source) {
+    {
+        QMutexLocker locker(&mutex);
+        auto entry = entries.constFind(document);
+        if (entry != entries.constEnd() && entry->revision == revision) {
+            return entry->future;
+        }
+    }
+
+    // 取文本可能较慢（编辑器转 UTF-8），不持有锁
+    QByteArray markdown = source();
+
+    QMutexLocker locker(&mutex);
+    auto entry = entries.find(document);
+    if (entry != entries.end() && entry->revision == revision) {
+        return entry->future;// 另一个线程先启动了同一修订的解析
+    }
+    QFuture<DocumentSnapshotPtr> future = QtConcurrent::run([markdown, revision]() { return DocumentSnapshot::parse(markdown, revision); });
+    // 过期修订的请求照常解析，但不取代更新的快照
+    if (entry == entries.end() || entry->revision < revision) {
+        entries.insert(document, Entry{revision, future});
+    }
+    return future;
+}
+
+void SnapshotService::forget(const QString &document) {
+    QMutexLocker locker(&mutex);
+    entries.remove(document);
+}
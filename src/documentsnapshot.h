@@ -0,0 +1,83 @@
+#ifndef QMARKDOWNEDITOR_DOCUMENTSNAPSHOT_H
+#define QMARKDOWNEDITOR_DOCUMENTSNAPSHOT_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <cmark.h>
+#include <functional>
+
+class DocumentSnapshot;
+using DocumentSnapshotPtr = QSharedPointer<const DocumentSnapshot>;
+
+// 文档某个修订的解析结果。创建后不再修改，任意多个线程可以同时只读遍历；
+// 最后一个持有者释放时释放 AST。大文档切块并行解析，每块一个根节点，
+// 块内的行号加上该块的 lineOffset 才是文档中的行号
+class DocumentSnapshot {
+public:
+    struct Part {
+        cmark_node *root;
+        int lineOffset;
+    };
+
+    // 超过该大小的文档切块并行解析
+    static constexpr qsizetype ParallelThreshold = 4 * 1024 * 1024;
+    static constexpr qsizetype ChunkBytes = 1024 * 1024;
+
+    ~DocumentSnapshot();
+    Q_DISABLE_COPY(DocumentSnapshot)
+
+    static DocumentSnapshotPtr parse(const QByteArray &markdown, quint64 revision = 0, int options = CMARK_OPT_DEFAULT);
+    static DocumentSnapshotPtr parseSerial(const QByteArray &markdown, quint64 revision = 0, int options = CMARK_OPT_DEFAULT);
+    // 在安全的块边界切开并行解析，文档结构无法安全切分时退回整体解析
+    static DocumentSnapshotPtr parseChunked(const QByteArray &markdown, qsizetype chunkBytes, quint64 revision = 0,
+                                            int options = CMARK_OPT_DEFAULT);
+
+    quint64 revision() const { return rev; }
+    const QByteArray &source() const { return text; }
+    const QVector<Part> &parts() const { return roots; }
+
+    // 按文档顺序遍历所有节点（不含各块的 DOCUMENT 根节点）
+    void walk(const std::function<void(cmark_node *node, cmark_event_type event, int lineOffset)> &visit) const;
+
+    // 正文字数：汉字、假名和谚文每字算一个，其余连续的字母数字算一个词；不计 Markdown 标记
+    int wordCount() const;
+
+private:
+    DocumentSnapshot() = default;
+
+    QByteArray text;
+    quint64 rev = 0;
+    QVector<Part> roots;
+};
+
+// 按文档保存最新修订的快照：同一修订只解析一次，先到的请求启动解析，之后的请求共享同一个结果。
+// 新修订取代旧修订后，旧快照在最后一个读者释放时回收
+class SnapshotService {
+public:
+    // 取得 document 在 revision 时的快照。尚未解析时在调用线程调用 source 取文本，再到后台解析。
+    // 任何线程都可以调用，返回的 future 也可以在任何线程等待
+    QFuture<DocumentSnapshotPtr> request(const QString &document, quint64 revision, const std::function<QByteArray()> &source);
+
+    DocumentSnapshotPtr snapshot(const QString &document, quint64 revision, const std::function<QByteArray()> &source) {
+        return request(document, revision, source).result();
+    }
+
+    // 文档关闭或改名后调用，修订号不再延续
+    void forget(const QString &document);
+
+private:
+    struct Entry {
+        quint64 revision;
+        QFuture<DocumentSnapshotPtr> future;
+    };
+
+    QMutex mutex;
+    QHash<QString, Entry> entries;
+};
+
+#endif// QMARKDOWNEDITOR_DOCUMENTSNAPSHOT_H
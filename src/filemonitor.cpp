@@ -0,0 +1,141 @@
+#include "filemonitor.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+namespace {
+    struct DiskState {
+        bool exists = false;
+        QDateTime modified;
+        qint64 size = -1;
+        QByteArray content;
+        QByteArray hash;
+    };
+
+    QByteArray contentHash(const QByteArray &content) {
+        return QCryptographicHash::hash(content, QCryptographicHash::Sha256);
+    }
+}
+
+FileMonitor::FileMonitor(QObject *parent)
+    : QObject(parent), watcher(new QFileSystemWatcher(this)), settleTimer(new QTimer(this)) {
+    settleTimer->setSingleShot(true);
+    settleTimer->setInterval(SettleMs);
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &FileMonitor::onPathChanged);
+    connect(settleTimer, &QTimer::timeout, this, [this]() {
+        const QSet<QString> paths = std::exchange(pending, {});
+        for (const QString &path: paths) {
+            check(path);
+        }
+    });
+}
+
+void FileMonitor::watch(const QString &filePath, const QByteArray &content) {
+    QFileInfo info(filePath);
+    State &state = states[filePath];
+    state.modified = info.lastModified();
+    state.size = info.exists() ? info.size() : -1;
+    state.hash = contentHash(content);
+    ensureWatched(filePath);
+}
+
+void FileMonitor::unwatch(const QString &filePath) {
+    states.remove(filePath);
+    pending.remove(filePath);
+    watcher->removePath(filePath);
+}
+
+void FileMonitor::markWritten(const QString &filePath) {
+    auto it = states.find(filePath);
+    if (it == states.end()) {
+        return;
+    }
+    QFileInfo info(filePath);
+    it->modified = info.lastModified();
+    it->size = info.size();
+    it->hash.clear();// 写入时可能转换了换行符，不再假设磁盘上的字节
+    ensureWatched(filePath);
+}
+
+bool FileMonitor::changedOnDisk(const QString &filePath) const {
+    auto it = states.constFind(filePath);
+    if (it == states.constEnd()) {
+        return false;
+    }
+    QFileInfo info(filePath);
+    return info.exists() && (info.lastModified() != it->modified || info.size() != it->size);
+}
+
+void FileMonitor::ensureWatched(const QString &path) {
+    // 以“写临时文件再改名”方式保存的程序会让监视失效，文件重新出现后要再次加入
+    if (QFileInfo::exists(path) && !watcher->files().contains(path)) {
+        watcher->addPath(path);
+    }
+}
+
+void FileMonitor::onPathChanged(const QString &path) {
+    if (!states.contains(path)) {
+        return;
+    }
+    pending.insert(path);
+    settleTimer->start();
+}
+
+void FileMonitor::check(const QString &filePath) {
+    auto it = states.find(filePath);
+    if (it == states.end()) {
+        return;
+    }
+    ensureWatched(filePath);
+    if (!changedOnDisk(filePath)) {
+        return;// 时间和大小都没变：自己的写入，或只是属性变化
+    }
+    if (it->checking) {
+        it->recheck = true;
+        return;
+    }
+    it->checking = true;
+
+    auto *future = new QFutureWatcher<DiskState>(this);
+    connect(future, &QFutureWatcher<DiskState>::finished, this, [this, future, filePath]() {
+        const DiskState disk = future->result();
+        future->deleteLater();
+        auto it = states.find(filePath);
+        if (it == states.end()) {
+            return;// 读取期间标签已关闭
+        }
+        it->checking = false;
+        if (!disk.exists) {
+            emit fileRemoved(filePath);
+            return;
+        }
+        it->modified = disk.modified;
+        it->size = disk.size;
+        const bool changed = disk.hash != it->hash;
+        it->hash = disk.hash;
+        const bool again = std::exchange(it->recheck, false);
+        if (changed) {
+            emit fileChanged(filePath, disk.content);
+        }
+        if (again) {
+            check(filePath);
+        }
+    });
+    future->setFuture(QtConcurrent::run([filePath]() {
+        DiskState disk;
+        QFile file(filePath);
+        if (!file.open(QFile::ReadOnly)) {
+            return disk;
+        }
+        // 先取时间和大小再读：读的过程中又被修改会再来一次通知
+        QFileInfo info(filePath);
+        disk.exists = true;
+        disk.modified = info.lastModified();
+        disk.size = info.size();
+        disk.content = file.readAll();
+        disk.hash = contentHash(disk.content);
+        return disk;
+    }));
+}
@@ -0,0 +1,59 @@
+#ifndef QMARKDOWNEDITOR_FILEMONITOR_H
+#define QMARKDOWNEDITOR_FILEMONITOR_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+// 监视已打开的文件是否被其他程序修改。
+// 完全由文件系统通知驱动：通知到达后先比较修改时间和大小，只有不同时才在后台读取并比较内容哈希，
+// 内容确实变化才发出 fileChanged。自己保存产生的通知在 markWritten 之后会被忽略
+class FileMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FileMonitor(QObject *parent = nullptr);
+
+    // 开始监视，content 为编辑器刚从磁盘读入的原始字节
+    void watch(const QString &filePath, const QByteArray &content);
+    void unwatch(const QString &filePath);
+
+    // 自己写入文件后调用，记录新的修改时间和大小
+    void markWritten(const QString &filePath);
+
+    // 保存前的快速检查：修改时间或大小与记录不同（通知可能还没到）
+    bool changedOnDisk(const QString &filePath) const;
+
+    // 立即检查文件，内容变化时发出 fileChanged
+    void check(const QString &filePath);
+
+    static constexpr int SettleMs = 150;// 同步工具和 git 往往连续写入多次，合并成一次检查
+
+signals:
+    void fileChanged(const QString &filePath, const QByteArray &content);
+    void fileRemoved(const QString &filePath);
+
+private:
+    struct State {
+        QDateTime modified;
+        qint64 size = -1;
+        QByteArray hash;      // 最近一次读到的内容哈希，自己写入后为空
+        bool checking = false;// 后台读取中
+        bool recheck = false; // 读取期间又收到了通知
+    };
+
+    void onPathChanged(const QString &path);
+    void ensureWatched(const QString &path);
+
+    QFileSystemWatcher *watcher;
+    QTimer *settleTimer;
+    QSet<QString> pending;// 等待检查的文件
+    QHash<QString, State> states;
+};
+
+#endif// QMARKDOWNEDITOR_FILEMONITOR_H
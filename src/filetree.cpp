@@ -0,0 +1,246 @@
+#include "filetree.h"
+#include "linkgraph.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+
+FileTreeModel::FileTreeModel(QObject *parent) : QAbstractItemModel(parent) {}
+
+FileTreeModel::~FileTreeModel() {
+    delete root;
+}
+
+void FileTreeModel::setRootPath(const QString &path) {
+    beginResetModel();
+    delete root;
+    nodes.clear();
+    root = new Node;
+    root->path = LinkGraph::normalizePath(path);
+    root->name = QFileInfo(root->path).fileName();
+    root->dir = true;
+    endResetModel();
+    populate(root);// 根目录立即读取，子目录展开时再读取
+}
+
+QString FileTreeModel::rootPath() const {
+    return root ? root->path : QString();
+}
+
+bool FileTreeModel::lessThan(const Node *a, const Node *b) {
+    if (a->dir != b->dir) {
+        return a->dir;// 目录在前
+    }
+    return a->name.compare(b->name, Qt::CaseInsensitive) < 0;
+}
+
+void FileTreeModel::populate(Node *dir) {
+    if (!dir || !dir->dir || dir->populated) {
+        return;
+    }
+    dir->populated = true;
+
+    QDir directory(dir->path);
+    const QStringList dirs = directory.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name | QDir::IgnoreCase);
+    const QStringList files = directory.entryList(QStringList() << "*.md", QDir::Files, QDir::Name | QDir::IgnoreCase);
+    if (dirs.isEmpty() && files.isEmpty()) {
+        return;
+    }
+
+    QList<Node *> children;
+    children.reserve(dirs.size() + files.size());
+    auto add = [&](const QString &name, bool isDir) {
+        Node *node = new Node;
+        node->path = QDir::cleanPath(dir->path + '/' + name);
+        node->name = name;
+        node->dir = isDir;
+        node->parent = dir;
+        children.append(node);
+    };
+    for (const QString &name: dirs) {
+        add(name, true);
+    }
+    for (const QString &name: files) {
+        add(name, false);
+    }
+    // 与插入时使用同一排序规则，之后才能二分查找插入位置
+    std::stable_sort(children.begin(), children.end(), &FileTreeModel::lessThan);
+
+    beginInsertRows(indexFor(dir), 0, int(children.size()) - 1);
+    dir->children = children;
+    for (int row = 0; row < children.size(); ++row) {
+        children[row]->row = row;
+        nodes.insert(children[row]->path, children[row]);
+    }
+    endInsertRows();
+}
+
+QModelIndex FileTreeModel::indexForPath(const QString &path) {
+    if (!root) {
+        return QModelIndex();
+    }
+    const QString key = LinkGraph::normalizePath(path);
+    if (Node *node = nodes.value(key)) {
+        return indexFor(node);
+    }
+
+    // 在根目录之下时逐级读取所在目录
+    const QString prefix = root->path.endsWith('/') ? root->path : root->path + '/';
+    if (!key.startsWith(prefix)) {
+        return QModelIndex();
+    }
+    const QStringList parts = key.mid(prefix.size()).split('/');
+    Node *dir = root;
+    for (int i = 0; i + 1 < parts.size(); ++i) {
+        populate(dir);
+        dir = nodes.value(QDir::cleanPath(dir->path + '/' + parts[i]));
+        if (!dir || !dir->dir) {
+            return QModelIndex();
+        }
+    }
+    populate(dir);
+    return indexFor(nodes.value(key));
+}
+
+QString FileTreeModel::filePath(const QModelIndex &index) const {
+    Node *node = nodeFor(index);
+    return node ? node->path : QString();
+}
+
+bool FileTreeModel::isDir(const QModelIndex &index) const {
+    Node *node = nodeFor(index);
+    return node && node->dir;
+}
+
+void FileTreeModel::addFile(const QString &path) {
+    const QString key = LinkGraph::normalizePath(path);
+    if (!root || nodes.contains(key)) {
+        return;
+    }
+    QFileInfo info(key);
+    const QString parentPath = QDir::cleanPath(info.absolutePath());
+    Node *dir = parentPath == root->path ? root : nodes.value(parentPath);
+    if (dir && !dir->populated) {
+        return;// 读取该目录时自然会包含它
+    }
+    if (!dir) {
+        const QString prefix = root->path.endsWith('/') ? root->path : root->path + '/';
+        if (key.startsWith(prefix)) {
+            return;// 上级目录尚未读取
+        }
+        dir = root;
+    }
+
+    Node *node = new Node;
+    node->path = key;
+    node->name = info.fileName();
+    node->dir = false;
+    insertChild(dir, node);
+}
+
+void FileTreeModel::insertChild(Node *dir, Node *child) {
+    const int row = int(std::lower_bound(dir->children.begin(), dir->children.end(), child, &FileTreeModel::lessThan) - dir->children.begin());
+    beginInsertRows(indexFor(dir), row, row);
+    child->parent = dir;
+    dir->children.insert(row, child);
+    for (int i = row; i < dir->children.size(); ++i) {
+        dir->children[i]->row = i;
+    }
+    nodes.insert(child->path, child);
+    endInsertRows();
+}
+
+void FileTreeModel::removeFile(const QString &path) {
+    Node *node = nodes.value(LinkGraph::normalizePath(path));
+    if (!node || node == root) {
+        return;
+    }
+    Node *dir = node->parent;
+    const int row = node->row;
+    beginRemoveRows(indexFor(dir), row, row);
+    dir->children.removeAt(row);
+    for (int i = row; i < dir->children.size(); ++i) {
+        dir->children[i]->row = i;
+    }
+    unregister(node);
+    delete node;
+    endRemoveRows();
+}
+
+void FileTreeModel::unregister(Node *node) {
+    nodes.remove(node->path);
+    for (Node *child: node->children) {
+        unregister(child);
+    }
+}
+
+FileTreeModel::Node *FileTreeModel::nodeFor(const QModelIndex &index) const {
+    return index.isValid() ? static_cast<Node *>(index.internalPointer()) : root;
+}
+
+QModelIndex FileTreeModel::indexFor(Node *node) const {
+    if (!node || node == root) {
+        return QModelIndex();
+    }
+    return createIndex(node->row, 0, node);
+}
+
+QModelIndex FileTreeModel::index(int row, int column, const QModelIndex &parent) const {
+    Node *dir = nodeFor(parent);
+    if (!dir || column != 0 || row < 0 || row >= dir->children.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, 0, dir->children[row]);
+}
+
+QModelIndex FileTreeModel::parent(const QModelIndex &child) const {
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    return indexFor(nodeFor(child)->parent);
+}
+
+int FileTreeModel::rowCount(const QModelIndex &parent) const {
+    if (parent.column() > 0) {
+        return 0;
+    }
+    Node *node = nodeFor(parent);
+    return node ? int(node->children.size()) : 0;
+}
+
+int FileTreeModel::columnCount(const QModelIndex &) const {
+    return 1;
+}
+
+QVariant FileTreeModel::data(const QModelIndex &index, int role) const {
+    Node *node = index.isValid() ? nodeFor(index) : nullptr;
+    if (!node) {
+        return QVariant();
+    }
+    switch (role) {
+        case Qt::DisplayRole:
+            return node->name;
+        case Qt::ToolTipRole:
+        case PathRole:
+            return node->path;
+        default:
+            return QVariant();
+    }
+}
+
+bool FileTreeModel::hasChildren(const QModelIndex &parent) const {
+    Node *node = nodeFor(parent);
+    if (!node || !node->dir) {
+        return false;
+    }
+    // 未读取的目录先显示展开箭头
+    return !node->populated || !node->children.isEmpty();
+}
+
+bool FileTreeModel::canFetchMore(const QModelIndex &parent) const {
+    Node *node = nodeFor(parent);
+    return node && node->dir && !node->populated;
+}
+
+void FileTreeModel::fetchMore(const QModelIndex &parent) {
+    populate(nodeFor(parent));
+}
@@ -0,0 +1,67 @@
+#ifndef QMARKDOWNEDITOR_FILETREE_H
+#define QMARKDOWNEDITOR_FILETREE_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// 笔记目录树：子目录在第一次展开（或需要定位其中的文件）时才读取，
+// 已读取的项按绝对路径登记在哈希表中，由路径找到索引不需要遍历。
+// 只列出子目录和 .md 文件；目录树之外打开的文件挂在根目录下
+class FileTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        PathRole = Qt::UserRole + 1
+    };
+
+    explicit FileTreeModel(QObject *parent = nullptr);
+    ~FileTreeModel() override;
+
+    void setRootPath(const QString &path);
+    QString rootPath() const;
+
+    // 按需读取文件所在的各级目录并返回它的索引；不在树中时返回无效索引
+    QModelIndex indexForPath(const QString &path);
+    QString filePath(const QModelIndex &index) const;
+    bool isDir(const QModelIndex &index) const;
+
+    // 新建或打开的文件加入树中：所在目录尚未读取时不需要处理，目录树之外的文件挂在根目录下
+    void addFile(const QString &path);
+    void removeFile(const QString &path);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    struct Node {
+        QString path;// 规范化的绝对路径
+        QString name;
+        bool dir;
+        bool populated = false;// 目录内容是否已读取
+        Node *parent = nullptr;
+        int row = 0;           // 在父节点 children 中的位置，插入删除时更新
+        QList<Node *> children;
+        ~Node() { qDeleteAll(children); }
+    };
+
+    Node *nodeFor(const QModelIndex &index) const;
+    QModelIndex indexFor(Node *node) const;
+    void populate(Node *dir);
+    void insertChild(Node *dir, Node *child);
+    void unregister(Node *node);
+    static bool lessThan(const Node *a, const Node *b);
+
+    Node *root = nullptr;
+    QHash<QString, Node *> nodes;// 路径 -> 节点，只包含已读取的项
+};
+
+#endif// QMARKDOWNEDITOR_FILETREE_H
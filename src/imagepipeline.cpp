@@ -0,0 +1,330 @@
+#include "imagepipeline.h"
+#include "linkgraph.h"
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrent>
+
+ImagePipeline::ImagePipeline(QObject *parent) : QObject(parent) {
+    // 大图解码很占内存，同时最多处理两张
+    thumbnailPool.setMaxThreadCount(2);
+    cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    QDir().mkpath(cacheDir);
+}
+
+QByteArray ImagePipeline::hashFile(const QString &path) {
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    return hash.result();
+}
+
+void ImagePipeline::importFiles(const QStringList &sources, const QString &imagesDir, QObject *context,
+                                const std::function<void(const QList<ImportedImage> &)> &done) {
+    using Images = QList<ImportedImage>;
+    // watcher 挂在 context 上：context 销毁后不会再回调
+    auto *watcher = new QFutureWatcher<Images>(context);
+    connect(watcher, &QFutureWatcher<Images>::finished, context, [watcher, done]() {
+        done(watcher->result());
+        watcher->deleteLater();
+    });
+
+    watcher->setFuture(QtConcurrent::run([this, sources, imagesDir]() {
+        Images images;
+        QDir().mkpath(imagesDir);
+        for (const QString &source: sources) {
+            images.append(storeFile(source, imagesDir));
+        }
+        return images;
+    }));
+}
+
+void ImagePipeline::importImage(const QImage &image, const QString &imagesDir, const QString &baseName, QObject *context,
+                                const std::function<void(const ImportedImage &)> &done) {
+    auto *watcher = new QFutureWatcher<ImportedImage>(context);
+    connect(watcher, &QFutureWatcher<ImportedImage>::finished, context, [watcher, done]() {
+        done(watcher->result());
+        watcher->deleteLater();
+    });
+
+    // QImage 隐式共享，按值传给工作线程不会复制像素
+    watcher->setFuture(QtConcurrent::run([this, image, imagesDir, baseName]() {
+        QDir().mkpath(imagesDir);
+        QPair<QByteArray, QByteArray> encoded = encodeImage(image);
+        if (encoded.second.isEmpty()) {
+            return ImportedImage{QString(), QString(), false};
+        }
+        return storeData(encoded.second, baseName + "." + encoded.first, imagesDir);
+    }));
+}
+
+QPair<QByteArray, QByteArray> ImagePipeline::encodeImage(const QImage &image) {
+    auto encode = [&image](const char *format, int quality) {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        QImageWriter writer(&buffer, format);
+        writer.setQuality(quality);
+        return writer.write(image) ? data : QByteArray();
+    };
+
+    // 无损格式中取较小的：截图通常 PNG 就很小，WebP 无损一般还能再小一些
+    QPair<QByteArray, QByteArray> best{"png", encode("png", -1)};
+    if (QImageWriter::supportedImageFormats().contains("webp")) {
+        QByteArray webp = encode("webp", 100);// Qt 的 WebP 插件在质量 100 时使用无损编码
+        if (!webp.isEmpty() && (best.second.isEmpty() || webp.size() < best.second.size())) {
+            best = {"webp", webp};
+        }
+    }
+
+    // 照片类内容无损编码很大，JPEG 小一半以上时改用 JPEG
+    const qsizetype lossyThreshold = 512 * 1024;
+    if (!image.hasAlphaChannel() && best.second.size() > lossyThreshold) {
+        QByteArray jpeg = encode("jpg", 90);
+        if (!jpeg.isEmpty() && jpeg.size() * 2 < best.second.size()) {
+            best = {"jpg", jpeg};
+        }
+    }
+    return best;
+}
+
+void ImagePipeline::ensureIndexed(const QString &imagesDir) {
+    {
+        QMutexLocker locker(&indexMutex);
+        if (directoryIndex.contains(imagesDir)) {
+            return;
+        }
+    }
+    // 第一次向该目录导入时为已有图片建立索引。哈希在锁外计算；
+    // 两个批次同时建立时先完成的留下，此后的写入都发生在索引存在之后
+    QHash<QByteArray, QString> existing;
+    QDir dir(imagesDir);
+    for (const QString &name: dir.entryList(QDir::Files)) {
+        QByteArray existingHash = hashFile(dir.filePath(name));
+        if (!existingHash.isEmpty()) {
+            existing.insert(existingHash, name);
+        }
+    }
+    QMutexLocker locker(&indexMutex);
+    if (!directoryIndex.contains(imagesDir)) {
+        directoryIndex.insert(imagesDir, existing);
+    }
+}
+
+QString ImagePipeline::findStored(const QString &imagesDir, const QByteArray &hash) {
+    QString name;
+    {
+        QMutexLocker locker(&indexMutex);
+        name = directoryIndex.value(imagesDir).value(hash);
+    }
+    QString path = QDir(imagesDir).filePath(name);
+    return !name.isEmpty() && QFile::exists(path) ? path : QString();
+}
+
+void ImagePipeline::remember(const QString &imagesDir, const QByteArray &hash, const QString &fileName) {
+    QMutexLocker locker(&indexMutex);
+    directoryIndex[imagesDir].insert(hash, fileName);
+}
+
+QString ImagePipeline::createUnique(const QString &imagesDir, const QString &fileName, const std::function<bool(QFile &)> &write) {
+    // 以 NewOnly 创建：文件名在文件系统上原子地占下，并行的批次和其他程序都不会写到同一个文件。
+    // 同名但内容不同的图片改名保存，不覆盖也不跳过
+    QDir dir(imagesDir);
+    QFileInfo info(fileName);
+    QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    for (int i = 0;; ++i) {
+        QString candidate = i == 0 ? fileName : QString("%1-%2%3").arg(info.completeBaseName()).arg(i).arg(suffix);
+        QFile file(dir.filePath(candidate));
+        if (!file.open(QFile::WriteOnly | QFile::NewOnly)) {
+            if (file.exists()) {
+                continue;
+            }
+            return QString();
+        }
+        bool ok = write(file);
+        file.close();
+        if (!ok || file.error() != QFile::NoError) {
+            file.remove();
+            return QString();
+        }
+        return file.fileName();
+    }
+}
+
+ImportedImage ImagePipeline::storeFile(const QString &source, const QString &imagesDir) {
+    ImportedImage image{source, QString(), false};
+    // 哈希、建索引和复制都在锁外进行，多个批次可以并行
+    const QByteArray hash = hashFile(source);
+    if (hash.isEmpty()) {
+        return image;
+    }
+    ensureIndexed(imagesDir);
+    const QString stored = findStored(imagesDir, hash);
+    if (!stored.isEmpty()) {
+        image.path = stored;
+        image.reused = true;
+        return image;
+    }
+
+    QFile input(source);
+    if (!input.open(QFile::ReadOnly)) {
+        return image;
+    }
+    image.path = createUnique(imagesDir, QFileInfo(source).fileName(), [&input](QFile &output) {
+        while (!input.atEnd()) {
+            const QByteArray block = input.read(1024 * 1024);
+            if (block.isEmpty() || output.write(block) != block.size()) {
+                return false;
+            }
+        }
+        return true;
+    });
+    if (!image.path.isEmpty()) {
+        remember(imagesDir, hash, QFileInfo(image.path).fileName());
+    }
+    return image;
+}
+
+ImportedImage ImagePipeline::storeData(const QByteArray &data, const QString &fileName, const QString &imagesDir) {
+    ImportedImage image{QString(), QString(), false};
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    ensureIndexed(imagesDir);
+    const QString stored = findStored(imagesDir, hash);
+    if (!stored.isEmpty()) {
+        image.path = stored;
+        image.reused = true;
+        return image;
+    }
+
+    image.path = createUnique(imagesDir, fileName, [&data](QFile &output) {
+        return output.write(data) == data.size();
+    });
+    if (!image.path.isEmpty()) {
+        remember(imagesDir, hash, QFileInfo(image.path).fileName());
+    }
+    return image;
+}
+
+QByteArray ImagePipeline::rewritePreviewImages(const QByteArray &html, const QString &baseDir) {
+    // cmark 输出的图片固定为 <img src="..." alt="..." />
+    const QByteArrayView imageTag(R"(<img src=")");
+    QDir dir(baseDir);
+    QByteArray result;
+    result.reserve(html.size() + 64);
+    qsizetype last = 0;
+    qsizetype start;
+    while ((start = html.indexOf(imageTag, last)) != -1) {
+        qsizetype srcEnd = html.indexOf('"', start + imageTag.size());
+        if (srcEnd == -1) {
+            break;
+        }
+        result.append(QByteArrayView(html).mid(last, start - last));
+        last = srcEnd + 1;
+
+        QByteArray src = html.mid(start + imageTag.size(), srcEnd - start - imageTag.size());
+        QString path = LinkGraph::resolveTarget(dir, QString::fromUtf8(src).replace("&amp;", "&").replace("&#x27;", "'"));
+        if (!path.isEmpty()) {
+            QString shown = previewImage(path);
+            if (shown != path) {
+                src = QUrl::fromLocalFile(shown).toString(QUrl::FullyEncoded).toHtmlEscaped().toUtf8();
+            }
+        }
+        result += R"(<img loading="lazy" decoding="async" src=")" + src + '"';
+    }
+    result.append(QByteArrayView(html).mid(last));
+    return result;
+}
+
+QString ImagePipeline::previewImage(const QString &imagePath) {
+    // 与磁盘缓存一样按修改时间和大小判断原图是否变过，变过的重新生成
+    const QFileInfo info(imagePath);
+    auto thumbnail = thumbnails.constFind(imagePath);
+    if (thumbnail == thumbnails.constEnd() || thumbnail->modified != info.lastModified() || thumbnail->size != info.size()) {
+        requestThumbnail(imagePath);// 生成前先显示原图
+        return imagePath;
+    }
+    return thumbnail->path.isEmpty() ? imagePath : thumbnail->path;
+}
+
+void ImagePipeline::requestThumbnail(const QString &imagePath) {
+    if (pendingThumbnails.contains(imagePath)) {
+        return;
+    }
+    pendingThumbnails.insert(imagePath);
+    // 记下请求时原图的状态：生成期间原图又变了，下次取用时会再生成一次
+    const QFileInfo info(imagePath);
+    const QDateTime modified = info.lastModified();
+    const qint64 size = info.size();
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, imagePath, modified, size]() {
+        QString thumbnail = watcher->result();
+        pendingThumbnails.remove(imagePath);
+        thumbnails.insert(imagePath, Thumbnail{modified, size, thumbnail});
+        if (!thumbnail.isEmpty()) {
+            emit thumbnailsChanged();
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&thumbnailPool, &ImagePipeline::makeThumbnail, imagePath, cacheDir));
+}
+
+QString ImagePipeline::makeThumbnail(const QString &imagePath, const QString &cacheDir) {
+    QFileInfo info(imagePath);
+    if (!info.isFile()) {
+        return QString();
+    }
+    QImageReader reader(imagePath);
+    reader.setAutoTransform(true);
+    QSize size = reader.size();
+    if (!size.isValid()) {
+        return QString();
+    }
+    bool oversized = size.width() > ThumbnailEdge || size.height() > ThumbnailEdge;
+    if (!oversized && info.size() < ThumbnailMinBytes) {
+        return QString();// 小图直接用原图
+    }
+
+    // 缓存键包含修改时间和大小，原图被替换后自动重新生成
+    QByteArray key = QCryptographicHash::hash(
+            QString("%1|%2|%3").arg(info.absoluteFilePath()).arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size()).toUtf8(),
+            QCryptographicHash::Sha1).toHex();
+    QString jpegPath = cacheDir + "/" + key + ".jpg";
+    QString pngPath = cacheDir + "/" + key + ".png";
+    if (QFile::exists(jpegPath)) {
+        return jpegPath;
+    }
+    if (QFile::exists(pngPath)) {
+        return pngPath;
+    }
+
+    // 让解码器直接按目标尺寸解码（JPEG 可以跳过大部分像素）
+    if (oversized) {
+        reader.setScaledSize(size.scaled(ThumbnailEdge, ThumbnailEdge, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) {
+        return QString();
+    }
+
+    bool alpha = image.hasAlphaChannel();
+    QString target = alpha ? pngPath : jpegPath;
+    QSaveFile file(target);
+    if (!file.open(QFile::WriteOnly) || !image.save(&file, alpha ? "PNG" : "JPG", alpha ? -1 : 85) || !file.commit()) {
+        return QString();
+    }
+    return target;
+}
@@ -0,0 +1,82 @@
+#ifndef QMARKDOWNEDITOR_IMAGEPIPELINE_H
+#define QMARKDOWNEDITOR_IMAGEPIPELINE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+
+struct ImportedImage {
+    QString source;// 原始文件
+    QString path;  // 复制到 images/ 后的绝对路径，失败时为空
+    bool reused;   // 目录中已有相同内容的图片，未重复复制
+};
+
+// 图片管线：后台按内容哈希去重复制图片，并为预览生成缩略图
+class ImagePipeline : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ImagePipeline(QObject *parent = nullptr);
+
+    // 超过该边长或文件大小的图片在预览中使用缩略图
+    static constexpr int ThumbnailEdge = 1600;
+    static constexpr qint64 ThumbnailMinBytes = 1024 * 1024;
+
+    // 在后台把一批图片复制到 imagesDir，完成后在 context 所在线程调用 done
+    void importFiles(const QStringList &sources, const QString &imagesDir, QObject *context,
+                     const std::function<void(const QList<ImportedImage> &)> &done);
+
+    // 在后台把粘贴的位图编码并保存为 imagesDir/baseName.<格式>，格式按编码后的大小选择
+    void importImage(const QImage &image, const QString &imagesDir, const QString &baseName, QObject *context,
+                     const std::function<void(const ImportedImage &)> &done);
+
+    // 为预览 HTML（UTF-8）中的图片加上 loading="lazy"，本地大图换成缩略图
+    QByteArray rewritePreviewImages(const QByteArray &html, const QString &baseDir);
+
+    // 预览中实际显示的文件：已有缩略图时返回缩略图，否则请求生成并先返回原图
+    QString previewImage(const QString &imagePath);
+
+signals:
+    // 新的缩略图生成完成，预览需要重新渲染
+    void thumbnailsChanged();
+
+private:
+    static QByteArray hashFile(const QString &path);
+    static QPair<QByteArray, QByteArray> encodeImage(const QImage &image);
+    ImportedImage storeFile(const QString &source, const QString &imagesDir);
+    ImportedImage storeData(const QByteArray &data, const QString &fileName, const QString &imagesDir);
+    void ensureIndexed(const QString &imagesDir);
+    QString findStored(const QString &imagesDir, const QByteArray &hash);
+    void remember(const QString &imagesDir, const QByteArray &hash, const QString &fileName);
+    static QString createUnique(const QString &imagesDir, const QString &fileName, const std::function<bool(QFile &)> &write);
+    void requestThumbnail(const QString &imagePath);
+    static QString makeThumbnail(const QString &imagePath, const QString &cacheDir);
+
+    // 缩略图对应的原图状态，原图被修改后重新生成
+    struct Thumbnail {
+        QDateTime modified;
+        qint64 size;
+        QString path;// 空字符串表示不需要缩略图
+    };
+
+    QMutex indexMutex;// 只在查询和插入索引时持有，读文件和复制都在锁外
+    QHash<QString, QHash<QByteArray, QString>> directoryIndex;// images 目录 -> (内容哈希 -> 文件名)，受 indexMutex 保护
+
+    // 以下只在 GUI 线程访问
+    QHash<QString, Thumbnail> thumbnails;// 图片 -> 缩略图
+    QSet<QString> pendingThumbnails;
+    QThreadPool thumbnailPool;// 限制同时解码的大图数量
+    QString cacheDir;
+};
+
+#endif// QMARKDOWNEDITOR_IMAGEPIPELINE_H
@@ -0,0 +1,231 @@
+#include "largefileview.h"
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrent>
+#include <cstring>
+
+LargeFileView::LargeFileView(const QString &filePath, QWidget *parent) : QWidget(parent), file(filePath) {
+    text = new QPlainTextEdit(this);
+    text->setReadOnly(true);
+    text->setUndoRedoEnabled(false);
+    previousButton = new QPushButton("上一页", this);
+    nextButton = new QPushButton("下一页", this);
+    pageSlider = new QSlider(Qt::Horizontal, this);
+    pageSlider->setEnabled(false);// 索引建立完成后才能跳页
+    statusLabel = new QLabel(this);
+
+    QHBoxLayout *navigation = new QHBoxLayout();
+    navigation->addWidget(previousButton);
+    navigation->addWidget(pageSlider, 1);
+    navigation->addWidget(nextButton);
+    navigation->addWidget(statusLabel);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(text);
+    layout->addLayout(navigation);
+
+    connect(previousButton, &QPushButton::clicked, this, [this]() { setPage(current - 1); });
+    connect(nextButton, &QPushButton::clicked, this, [this]() { setPage(current + 1); });
+    // 拖动滑块时只在松开后翻页，避免逐页渲染
+    connect(pageSlider, &QSlider::valueChanged, this, [this](int value) {
+        if (!pageSlider->isSliderDown()) {
+            setPage(value);
+        }
+    });
+    connect(pageSlider, &QSlider::sliderReleased, this, [this]() { setPage(pageSlider->value()); });
+
+    if (file.open(QFile::ReadOnly)) {
+        size = file.size();
+        data = size > 0 ? file.map(0, size) : nullptr;
+    }
+    if (!data) {
+        text->setPlainText(QString("无法映射文件：%1").arg(file.errorString()));
+        previousButton->setEnabled(false);
+        nextButton->setEnabled(false);
+        return;
+    }
+
+    connect(&scanWatcher, &QFutureWatcher<PageIndex>::finished, this, [this]() {
+        if (cancelled) {
+            return;
+        }
+        // 扫描结果与翻页时逐页计算的边界相同，直接替换
+        index = scanWatcher.result();
+        indexed = true;
+        QSignalBlocker blocker(pageSlider);
+        pageSlider->setRange(0, int(index.offsets.size()) - 1);
+        pageSlider->setValue(current);
+        pageSlider->setEnabled(true);
+        updateStatus();
+    });
+    scanWatcher.setFuture(QtConcurrent::run(&LargeFileView::scan, data, size, &cancelled));
+
+    index.offsets.append(0);
+    text->setPlainText(pageText());
+    updateStatus();
+}
+
+LargeFileView::~LargeFileView() {
+    cancelled = true;
+    scanWatcher.waitForFinished();// 扫描线程还在读映射区
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+    }
+}
+
+qint64 LargeFileView::pageEnd(const uchar *data, qint64 size, qint64 start) {
+    if (size - start <= PageBytes) {
+        return size;
+    }
+    const char *bytes = reinterpret_cast<const char *>(data);
+    const qint64 limit = qMin(size, start + 4 * PageBytes);
+    char fenceChar = 0;     // 非 0 表示在围栏代码块中
+    qint64 fenceLength = 0; // 开始围栏的长度
+    qint64 firstLineEnd = -1;// PageBytes 之后的第一个行尾
+    for (qint64 pos = start; pos < limit;) {
+        const void *newline = memchr(bytes + pos, '\n', limit - pos);
+        if (!newline) {
+            break;
+        }
+        const qint64 lineEnd = static_cast<const char *>(newline) - bytes;
+        auto isBlank = [bytes](qint64 from, qint64 to) {
+            for (qint64 i = from; i < to; ++i) {
+                if (bytes[i] != ' ' && bytes[i] != '\t' && bytes[i] != '\r') {
+                    return false;
+                }
+            }
+            return true;
+        };
+        const bool blank = isBlank(pos, lineEnd);
+
+        // 围栏规则与 BlockSplitter 相同：最多缩进 3 个空格；结束围栏必须是同一字符、
+        // 不短于开始围栏且后面只有空白，代码块里的 ```lang 不会把块关上
+        qint64 indent = 0;
+        while (indent < 3 && pos + indent < lineEnd && bytes[pos + indent] == ' ') {
+            ++indent;
+        }
+        const qint64 runStart = pos + indent;
+        const char first = runStart < lineEnd ? bytes[runStart] : 0;
+        qint64 run = 0;
+        if (first == '`' || first == '~') {
+            while (runStart + run < lineEnd && bytes[runStart + run] == first) {
+                ++run;
+            }
+        }
+        if (run >= 3) {
+            const qint64 rest = runStart + run;
+            if (!fenceChar) {
+                // 反引号围栏的信息字符串中不能再有反引号
+                if (first != '`' || !memchr(bytes + rest, '`', lineEnd - rest)) {
+                    fenceChar = first;
+                    fenceLength = run;
+                }
+            } else if (first == fenceChar && run >= fenceLength && isBlank(rest, lineEnd)) {
+                fenceChar = 0;
+            }
+        }
+
+        pos = lineEnd + 1;
+        if (pos - start >= PageBytes) {
+            // 在围栏代码块之外的空行后分页，预览中每页都是完整的块
+            if (blank && !fenceChar) {
+                return pos;
+            }
+            if (firstLineEnd == -1) {
+                firstLineEnd = pos;
+            }
+        }
+    }
+    if (limit == size) {
+        return size;
+    }
+    if (firstLineEnd != -1) {
+        return firstLineEnd;
+    }
+    // 超长的单行：退回到 UTF-8 字符的开头
+    qint64 cut = start + PageBytes;
+    while (cut > start && (data[cut] & 0xC0) == 0x80) {
+        --cut;
+    }
+    return cut;
+}
+
+PageIndex LargeFileView::scan(const uchar *data, qint64 size, const std::atomic<bool> *cancelled) {
+    PageIndex result;
+    const char *bytes = reinterpret_cast<const char *>(data);
+    for (qint64 start = 0; start < size && !*cancelled;) {
+        result.offsets.append(start);
+        const qint64 end = pageEnd(data, size, start);
+        for (const char *p = bytes + start; (p = static_cast<const char *>(memchr(p, '\n', bytes + end - p))); ++p) {
+            ++result.lines;
+        }
+        start = end;
+    }
+    return result;
+}
+
+qint64 LargeFileView::pageStart(int page) const {
+    if (page < index.offsets.size()) {
+        return index.offsets[page];
+    }
+    return indexed ? size : pageEnd(data, size, index.offsets.last());
+}
+
+QString LargeFileView::pageText() const {
+    if (!data) {
+        return QString();
+    }
+    const qint64 start = index.offsets[current];
+    const qint64 end = pageStart(current + 1);
+    return QString::fromUtf8(reinterpret_cast<const char *>(data) + start, end - start);
+}
+
+void LargeFileView::setPage(int page) {
+    if (!data || page < 0 || page == current) {
+        return;
+    }
+    if (page >= index.offsets.size()) {
+        // 扫描完成前只能逐页向后翻，边界按需计算
+        if (indexed || page != index.offsets.size()) {
+            return;
+        }
+        const qint64 start = pageStart(page);
+        if (start >= size) {
+            return;
+        }
+        index.offsets.append(start);
+    }
+
+    current = page;
+    text->setPlainText(pageText());
+    {
+        QSignalBlocker blocker(pageSlider);
+        pageSlider->setValue(current);
+    }
+    updateStatus();
+    emit pageChanged();
+}
+
+void LargeFileView::setTextFont(const QFont &font) {
+    text->setFont(font);
+}
+
+void LargeFileView::setTextStyleSheet(const QString &style) {
+    text->setStyleSheet(style);
+}
+
+void LargeFileView::updateStatus() {
+    const QString fileSize = QString::number(size / (1024.0 * 1024.0), 'f', 1);
+    if (indexed) {
+        statusLabel->setText(QString("第 %1 / %2 页 · %3 行 · %4 MB · 只读")
+                                     .arg(current + 1)
+                                     .arg(index.offsets.size())
+                                     .arg(index.lines)
+                                     .arg(fileSize));
+    } else {
+        statusLabel->setText(QString("第 %1 页 · %2 MB · 只读 · 正在建立索引…").arg(current + 1).arg(fileSize));
+    }
+    previousButton->setEnabled(current > 0);
+    nextButton->setEnabled(pageStart(current + 1) < size);
+}
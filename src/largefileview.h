@@ -0,0 +1,65 @@
+#ifndef QMARKDOWNEDITOR_LARGEFILEVIEW_H
+#define QMARKDOWNEDITOR_LARGEFILEVIEW_H
+
+#include <QFile>
+#include <QFutureWatcher>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSlider>
+#include <QVector>
+#include <QWidget>
+#include <atomic>
+
+struct PageIndex {
+    QVector<qint64> offsets;// 每页的起始字节偏移
+    qint64 lines = 0;
+};
+
+// 超大文件的只读视图：文件以内存映射方式打开，后台扫描出分页索引，
+// 编辑区和预览只加载当前一页，常驻内存与文件大小无关
+class LargeFileView : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 PageBytes = 256 * 1024;
+
+    explicit LargeFileView(const QString &filePath, QWidget *parent = nullptr);
+    ~LargeFileView() override;
+
+    int currentPage() const { return current; }
+    QString pageText() const;// 当前页的文本
+    void setPage(int index);
+    void setTextFont(const QFont &font);
+    void setTextStyleSheet(const QString &style);
+
+    // 从 start 开始的一页在哪里结束：PageBytes 之后第一个围栏代码块之外的空行，
+    // 找不到时退回到行尾，单行超长时在 UTF-8 字符边界处截断
+    static qint64 pageEnd(const uchar *data, qint64 size, qint64 start);
+
+signals:
+    // 翻页后预览需要渲染新的一页
+    void pageChanged();
+
+private:
+    static PageIndex scan(const uchar *data, qint64 size, const std::atomic<bool> *cancelled);
+    qint64 pageStart(int page) const;
+    void updateStatus();
+
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 size = 0;
+    PageIndex index;         // 扫描完成前只有已经访问过的页
+    bool indexed = false;
+    int current = 0;
+    std::atomic<bool> cancelled{false};
+    QFutureWatcher<PageIndex> scanWatcher;
+
+    QPlainTextEdit *text;
+    QPushButton *previousButton;
+    QPushButton *nextButton;
+    QSlider *pageSlider;
+    QLabel *statusLabel;
+};
+
+#endif// QMARKDOWNEDITOR_LARGEFILEVIEW_H
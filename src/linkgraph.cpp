@@ -0,0 +1,171 @@
+#include "linkgraph.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrent>
+
+QString LinkGraph::resolveTarget(const QDir &baseDir, const QString &url) {
+    if (url.isEmpty() || url.startsWith('#')) {
+        return QString();
+    }
+
+    QUrl parsed(url);
+    QString path;
+    if (parsed.scheme() == "file") {
+        path = parsed.toLocalFile();
+    } else if (parsed.scheme().size() > 1) {
+        return QString();// http、mailto 等外部链接（单字母 scheme 视为 Windows 盘符）
+    } else {
+        path = url;
+        int cut = path.indexOf('#');
+        int query = path.indexOf('?');
+        if (query != -1 && (cut == -1 || query < cut)) {
+            cut = query;
+        }
+        if (cut != -1) {
+            path.truncate(cut);
+        }
+        path = QUrl::fromPercentEncoding(path.toUtf8());
+    }
+
+    if (path.isEmpty()) {
+        return QString();
+    }
+    return QDir::cleanPath(baseDir.absoluteFilePath(path));
+}
+
+LinkGraph::LinkGraph(QObject *parent) : QObject(parent) {}
+
+QString LinkGraph::normalizePath(const QString &filePath) {
+    return QDir::cleanPath(QFileInfo(filePath).absoluteFilePath());
+}
+
+QSet<QString> LinkGraph::extractLinks(const QString &filePath, const DocumentSnapshot &snapshot) {
+    QSet<QString> links;
+    QDir baseDir = QFileInfo(filePath).absoluteDir();
+    snapshot.walk([&](cmark_node *node, cmark_event_type event, int) {
+        if (event != CMARK_EVENT_ENTER) {
+            return;
+        }
+        cmark_node_type type = cmark_node_get_type(node);
+        if (type == CMARK_NODE_LINK || type == CMARK_NODE_IMAGE) {
+            QString target = resolveTarget(baseDir, QString::fromUtf8(cmark_node_get_url(node)));
+            if (!target.isEmpty()) {
+                links.insert(target);
+            }
+        }
+    });
+    return links;
+}
+
+QSet<QString> LinkGraph::extractLinks(const QString &filePath, const QByteArray &markdown) {
+    return extractLinks(filePath, *DocumentSnapshot::parse(markdown));
+}
+
+void LinkGraph::updateDocument(const QString &filePath, const DocumentSnapshot &snapshot) {
+    QString source = normalizePath(filePath);
+    documentRevision[source] = ++revision;
+    applyLinks(source, extractLinks(source, snapshot));
+}
+
+void LinkGraph::removeDocument(const QString &filePath) {
+    QString source = normalizePath(filePath);
+    documentRevision[source] = ++revision;
+    applyLinks(source, QSet<QString>());
+}
+
+void LinkGraph::applyLinks(const QString &source, const QSet<QString> &links) {
+    const QSet<QString> current = forward.value(source);
+    if (current == links) {
+        return;
+    }
+
+    // 只处理差集，代价与变化的链接数量成正比
+    const QSet<QString> removed = current - links;
+    const QSet<QString> added = links - current;
+
+    if (links.isEmpty()) {
+        forward.remove(source);
+    } else {
+        forward.insert(source, links);
+    }
+
+    for (const QString &target: removed) {
+        auto it = reverse.find(target);
+        if (it != reverse.end()) {
+            it->remove(source);
+            if (it->isEmpty()) {
+                reverse.erase(it);
+            }
+        }
+    }
+    for (const QString &target: added) {
+        reverse[target].insert(source);
+    }
+
+    for (const QString &target: removed) {
+        emit backlinksChanged(target);
+    }
+    for (const QString &target: added) {
+        emit backlinksChanged(target);
+    }
+}
+
+void LinkGraph::indexDirectory(const QString &folderPath) {
+    using LinkMap = QHash<QString, QSet<QString>>;
+    const quint64 startRevision = revision;
+    const quint64 scan = ++scanSerial;
+
+    auto *watcher = new QFutureWatcher<LinkMap>(this);
+    connect(watcher, &QFutureWatcher<LinkMap>::finished, this, [this, watcher, startRevision, scan]() {
+        watcher->deleteLater();
+        if (scan != scanSerial) {
+            return;// 扫描期间又打开了别的目录，以最新一次为准
+        }
+        const LinkMap result = watcher->result();
+        // 新目录的扫描结果取代之前的索引，之前目录中的文档不再提供反向链接
+        const QStringList sources = forward.keys();
+        for (const QString &source: sources) {
+            if (!result.contains(source) && documentRevision.value(source) <= startRevision) {
+                applyLinks(source, QSet<QString>());
+            }
+        }
+        for (auto it = result.constBegin(); it != result.constEnd(); ++it) {
+            // 扫描期间被保存过的文档以保存时的结果为准
+            if (documentRevision.value(it.key()) > startRevision) {
+                continue;
+            }
+            applyLinks(it.key(), it.value());
+        }
+    });
+
+    watcher->setFuture(QtConcurrent::run([folderPath]() {
+        LinkMap result;
+        // 与文件树一样包含子目录
+        QDirIterator files(folderPath, QStringList() << "*.md", QDir::Files, QDirIterator::Subdirectories);
+        while (files.hasNext()) {
+            QString path = normalizePath(files.next());
+            QFile file(path);
+            if (file.open(QFile::ReadOnly)) {
+                result.insert(path, extractLinks(path, file.readAll()));
+                file.close();
+            }
+        }
+        return result;
+    }));
+}
+
+QStringList LinkGraph::backlinks(const QString &filePath) const {
+    QStringList result = reverse.value(normalizePath(filePath)).values();
+    result.sort();
+    return result;
+}
+
+QStringList LinkGraph::forwardLinks(const QString &filePath) const {
+    QStringList result = forward.value(normalizePath(filePath)).values();
+    result.sort();
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef QMARKDOWNEDITOR_LINKGRAPH_H
+#define QMARKDOWNEDITOR_LINKGRAPH_H
+
+#include "documentsnapshot.h"
+#include <QDir>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// 笔记之间的链接图：正向索引（文档 -> 它引用的目标）与反向索引（目标 -> 引用它的文档）
+class LinkGraph : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LinkGraph(QObject *parent = nullptr);
+
+    // 遍历 cmark AST，收集 CMARK_NODE_LINK / CMARK_NODE_IMAGE 指向的本地目标（绝对路径）
+    static QSet<QString> extractLinks(const QString &filePath, const DocumentSnapshot &snapshot);
+    static QSet<QString> extractLinks(const QString &filePath, const QByteArray &markdown);
+
+    // 文档保存后调用：只对新增/删除的链接修改反向索引
+    void updateDocument(const QString &filePath, const DocumentSnapshot &snapshot);
+    void removeDocument(const QString &filePath);
+
+    // 在后台线程扫描目录及其子目录中的 .md 文件，完成后取代之前目录的索引
+    void indexDirectory(const QString &folderPath);
+
+    QStringList backlinks(const QString &filePath) const;
+    QStringList forwardLinks(const QString &filePath) const;
+
+    static QString normalizePath(const QString &filePath);
+
+    // 把链接地址解析成本地文件的绝对路径，外部链接与页内锚点返回空
+    static QString resolveTarget(const QDir &baseDir, const QString &url);
+
+signals:
+    // 某个目标的反向链接集合发生了变化
+    void backlinksChanged(const QString &target);
+
+private:
+    void applyLinks(const QString &source, const QSet<QString> &links);
+
+    QHash<QString, QSet<QString>> forward;// 文档 -> 目标
+    QHash<QString, QSet<QString>> reverse;// 目标 -> 文档
+    QHash<QString, quint64> documentRevision;// 文档最后一次更新时的修订号
+    quint64 revision = 0;
+    quint64 scanSerial = 0;// 最近一次 indexDirectory 的序号
+};
+
+#endif// QMARKDOWNEDITOR_LINKGRAPH_H
@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QCoreApplication>
 #include <QMainWindow>
 #include <QWidget>
 #include <QVBoxLayout>
@@ -6,15 +7,22 @@
 #include <QProgressBar>
 #include <QPixmap>
 #include <QTimer>
+#include "commandline.h"
 #include "mainwindow.h"
+#include "startupprofiler.h"
 
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
+    // 命令行渲染/导出模式：只创建 QCoreApplication，不初始化 Widgets 和 WebEngine
+    if (CommandLine::isHeadless(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return CommandLine::run(app.arguments());
+    }
 
-    // 创建主窗口的实例
-    MainWindow window;
+    StartupProfiler::start();
+    QApplication app(argc, argv);
+    StartupProfiler::mark("QApplication");
 
-    // 创建一个窗口用于加载
+    // 创建一个窗口用于加载，进度由真实的初始化阶段推进
     QWidget splashScreen;
     splashScreen.setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
 
@@ -37,24 +45,21 @@ int main(int argc, char *argv[]) {
 
     splashScreen.resize(300, 150); // 调整窗口大小以容纳图片
     splashScreen.show();
+    progressBar->setValue(20);
+    app.processEvents();
+    StartupProfiler::mark("启动画面");
+
+    // 创建主窗口的实例（只构建界面和读取设置，不加载文件和预览）
+    MainWindow window;
+    progressBar->setValue(80);
+    app.processEvents();
 
-    // 创建一个定时器用于更新进度条
-    QTimer timer;
-    QObject::connect(&timer, &QTimer::timeout, [&]() {
-        int value = progressBar->value() + 33; // 每次增加 33
-        if (value >= 100) {
-            value = 100;
-            timer.stop(); // 停止计时器
-            splashScreen.close(); // 关闭加载窗口
-
-            // 显示主窗口
-            window.show();
-        }
-        progressBar->setValue(value);
-    });
-
-    // 启动定时器，每秒更新一次
-    timer.start(1000);
+    // 编辑器可用后立即显示主窗口，文件与 WebEngine 预览在事件循环中分阶段加载
+    window.show();
+    progressBar->setValue(100);
+    splashScreen.close();
+    StartupProfiler::mark("显示主窗口");
+    QTimer::singleShot(0, &window, &MainWindow::finishStartup);
 
     return app.exec();
 }
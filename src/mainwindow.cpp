@@ -1,48 +1,222 @@
 #include "mainwindow.h"
-#include "iostream"
+#include "batchexporter.h"
+#include "startupprofiler.h"
+#include "threewaymerge.h"
 #include <QCloseEvent>
 #include <QDateTime>
+#include <QDesktopServices>
+#include <QDialog>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QFontDialog>
+#include <QFutureWatcher>
 #include <QHBoxLayout>
+#include <QHeaderView>
 #include <QIcon>
 #include <QInputDialog>
 #include <QKeySequence>
 #include <QMessageBox>
-#include <QSettings>
+#include <QPointer>
+#include <QPromise>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QScrollBar>
 #include <QShortcut>
+#include <QSignalBlocker>
+#include <QSpinBox>
+#include <QStandardPaths>
+#include <QTableWidget>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextStream>
+#include <QUrl>
 #include <QVBoxLayout>
 #include <QWebEngineProfile>
-#include <QWebEngineSettings>
+#include <QtConcurrent/QtConcurrent>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), verticalSplitter(new QSplitter(Qt::Horizontal, this)),
-      fileList(new QListWidget(this)), fileTabs(new QTabWidget(this)),
-      settings(), autoSaveTimer(new QTimer(this)), debounceTimer(new QTimer(this)) {
+      fileTree(new QTreeView(this)), fileTreeModel(new FileTreeModel(this)), fileTabs(new QTabWidget(this)),
+      settings(), autoSaveTimer(new QTimer(this)), collapseTimer(new QTimer(this)), debounceTimer(new QTimer(this)),
+      linkGraph(new LinkGraph(this)), imagePipeline(new ImagePipeline(this)),
+      diagramRenderer(new DiagramRenderer(this)), outlineModel(new OutlineModel(this)), outlineTimer(new QTimer(this)),
+      latencyHudTimer(new QTimer(this)), previewLifecycle(new PreviewLifecycle(this)),
+      versionStore(new VersionStore(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/history", this)),
+      fileMonitor(new FileMonitor(this)), spellChecker(new SpellChecker(this)) {
 
     setupUi();
+    StartupProfiler::mark("构建界面");
     settings.loadSettings();      // 加载设置
     currentTheme = settings.theme;// 使用加载的主题
+    previewLifecycle->setBudget(qint64(settings.previewMemoryMB) * 1024 * 1024);
+    spellCheckAction->setChecked(settings.spellCheck);
+    nativePreviewAction->setChecked(settings.nativePreview);
+    spellChecker->setEnabled(settings.spellCheck);
+    spellChecker->setLanguage(settings.spellLanguage);
     updatePalette(currentTheme);
-    loadLastOpenedFile();
-    applyThemeToAllTabs();// 确保主题应用到所有标签页
+    StartupProfiler::mark("加载设置");
 
     // 初始化防抖定时器
     debounceTimer->setInterval(50);// 300毫秒
     debounceTimer->setSingleShot(true);
     connect(debounceTimer, &QTimer::timeout, this, &MainWindow::refreshPreviews);
+    // 缩略图生成后重新渲染预览，换下原图
+    connect(imagePipeline, &ImagePipeline::thumbnailsChanged, this, [this]() { debounceTimer->start(); });
+    connect(diagramRenderer, &DiagramRenderer::diagramsChanged, this, [this]() { debounceTimer->start(); });
+    connect(fileMonitor, &FileMonitor::fileChanged, this, &MainWindow::onExternalChange);
+    connect(fileMonitor, &FileMonitor::fileRemoved, this, [this](const QString &filePath) {
+        statusBar()->showMessage(QString("%1 已在磁盘上被删除或移走，保存时会重新写入").arg(QFileInfo(filePath).fileName()), 5000);
+    });
 
     // 设置图标
     QIcon icon(":/wyw.ico");
     setWindowIcon(icon);
 }
 
+void MainWindow::finishStartup() {
+    // 先只创建编辑器，让文本尽快可编辑
+    restoreSession();
+    applyThemeToAllTabs();// 确保主题应用到所有标签页
+    StartupProfiler::mark("加载上次文件");
+
+    // 等编辑器绘制出第一帧后再初始化 WebEngine
+    QTimer::singleShot(0, this, &MainWindow::initPreviews);
+}
+
+void MainWindow::initPreviews() {
+    previewsReady = true;
+    if (!useNativePreview()) {
+        pagePool = new PreviewPagePool(3, this);
+    }
+    for (auto tab: openTabs) {
+        attachPreview(tab);
+    }
+    StartupProfiler::mark("初始化 WebEngine");
+
+    if (openTabs.isEmpty()) {
+        StartupProfiler::finish();
+        return;
+    }
+    connect(this, &MainWindow::previewRendered, this, []() {
+        StartupProfiler::mark("首次预览加载");
+        StartupProfiler::finish();
+    }, Qt::SingleShotConnection);
+}
+
+void MainWindow::attachPreview(FileTab *tab) {
+    if (tab->preview || tab->nativePreview || (!tab->editor && !tab->largeView)) {
+        return;// 未实例化的标签在 materializeTab 中创建预览
+    }
+    if (useNativePreview()) {
+        // 轻量预览直接由 AST 构建文档，不启动 Chromium
+        tab->nativePreview = new NativePreview(this);
+        connect(tab->nativePreview, &QTextBrowser::anchorClicked, this, &MainWindow::onPreviewLinkActivated);
+        tab->splitter->addWidget(tab->nativePreview);
+        tab->splitter->setStretchFactor(0, 2);
+        tab->splitter->setStretchFactor(1, 3);
+        tab->splitter->setSizes({height() * 2 / 5, height() * 3 / 5});
+        loadMarkdown(previewSource(tab), tab);
+        // 等文档布局完成、滚动范围确定后再恢复位置
+        QTimer::singleShot(0, tab->nativePreview, [tab]() {
+            tab->nativePreview->verticalScrollBar()->setValue(tab->scrollY);
+        });
+        return;
+    }
+    if (!pagePool) {
+        pagePool = new PreviewPagePool(3, this);
+    }
+    tab->preview = new QWebEngineView(this);
+
+    // 从页面池取一个已加载外壳的页面，省去创建页面和加载样式的延迟
+    PreviewPage *page = pagePool->take(tab->preview);
+    tab->preview->setPage(page);
+    connect(page, &PreviewPage::linkActivated, this, &MainWindow::onPreviewLinkActivated);
+    // 渲染进程崩溃或无法启动（缺少 GPU、沙箱受限等）时改用轻量预览
+    connect(page, &QWebEnginePage::renderProcessTerminated, this,
+            [this](QWebEnginePage::RenderProcessTerminationStatus status, int) {
+                if (status == QWebEnginePage::NormalTerminationStatus || webEngineFailed) {
+                    return;
+                }
+                webEngineFailed = true;
+                statusBar()->showMessage("预览渲染进程异常退出，已改用轻量预览", 5000);
+                // 不在页面自身的信号中删除页面
+                QTimer::singleShot(0, this, &MainWindow::rebuildPreviews);
+            });
+
+    // 外壳加载完成（包括重新加载）后注入内容并恢复滚动位置
+    connect(page, &QWebEnginePage::loadFinished, this, [this, tab](bool success) {
+        if (success) {
+            // 被丢弃后重新加载的页面直接注入上次的结果，不必重新转换
+            if (!tab->previewScript.isEmpty()) {
+                tab->preview->page()->runJavaScript(tab->previewScript);
+            } else {
+                loadMarkdown(previewSource(tab), tab);
+            }
+            qint64 scrollStart = Tracer::now();
+            tab->preview->page()->runJavaScript(QString("window.scrollTo(0, %1);").arg(tab->scrollY), [scrollStart](const QVariant &) {
+                Tracer::record("scroll restore", scrollStart, Tracer::now());
+            });
+        } else {
+            qDebug() << "Failed to load HTML content in preview.";
+        }
+    });
+
+    previewLifecycle->track(tab->preview);
+
+    tab->splitter->addWidget(tab->preview);
+    tab->splitter->setStretchFactor(0, 2);// 编辑区占比
+    tab->splitter->setStretchFactor(1, 3);// 预览区占比
+
+    // 设置预览区的初始大小比例 (40% 编辑区, 60% 预览区)
+    QList<int> splitterSizes;
+    splitterSizes << height() * 2 / 5 << height() * 3 / 5;
+    tab->splitter->setSizes(splitterSizes);
+
+    // 设置预览
+    if (page->isShellReady()) {
+        loadMarkdown(previewSource(tab), tab);
+    }
+}
+
+void MainWindow::detachPreview(FileTab *tab) {
+    if (tab->preview) {
+        if (tab->preview->page()->lifecycleState() == QWebEnginePage::LifecycleState::Active) {
+            tab->scrollY = int(tab->preview->page()->scrollPosition().y());
+        }
+        delete tab->preview;
+        tab->preview = nullptr;
+        tab->previewScript.clear();
+    }
+    if (tab->nativePreview) {
+        tab->scrollY = tab->nativePreview->verticalScrollBar()->value();
+        delete tab->nativePreview;
+        tab->nativePreview = nullptr;
+    }
+}
+
+void MainWindow::rebuildPreviews() {
+    if (!previewsReady) {
+        return;// initPreviews 会按当前设置创建
+    }
+    for (auto tab: openTabs) {
+        detachPreview(tab);
+        attachPreview(tab);
+    }
+    int index = fileTabs->currentIndex();
+    previewLifecycle->setCurrent(index >= 0 && index < openTabs.size() ? openTabs[index]->preview : nullptr);
+}
+
 MainWindow::~MainWindow() {
+    // 导出在线程池中运行，可能比窗口活得久：取消剩下的文件并等它结束
+    exportFuture.cancel();
+    exportFuture.waitForFinished();
+
     // 清理所有打开的标签页
     for (auto tab: openTabs) {
         delete tab->editor;
+        delete tab->largeView;
         delete tab->preview;
+        delete tab->nativePreview;
         delete tab;
     }
 }
@@ -52,8 +226,12 @@ void MainWindow::setupUi() {
     resize(1600, 1200);// 设置窗口默认大小
 
     // 设置文件列表
-    fileList->setFont(QFont("Consolas", 15));
-    connect(fileList, &QListWidget::itemClicked, this, &MainWindow::openFile);
+    // 设置文件树：行高一致时视图不必逐行测量，十万级条目也只布局可见行
+    fileTree->setModel(fileTreeModel);
+    fileTree->setHeaderHidden(true);
+    fileTree->setUniformRowHeights(true);
+    fileTree->setFont(QFont("Consolas", 15));
+    connect(fileTree, &QTreeView::clicked, this, &MainWindow::openFile);
 
     // 设置标签页
     fileTabs->setTabsClosable(true);
@@ -64,16 +242,15 @@ void MainWindow::setupUi() {
         FileTab *tab = openTabs.at(index);
         if (!tab->filePath.isEmpty()) {
             // 自动保存
-            QFile file(tab->filePath);
-            if (file.open(QFile::WriteOnly | QFile::Text)) {
-                QTextStream out(&file);
-                out << tab->editor->toPlainText();
-                file.close();
-            }
+            writeTabToFile(tab);
         }
+        fileMonitor->unwatch(tab->filePath);
+        snapshots.forget(tab->filePath);
         // 移除并删除标签页
         delete tab->editor;
+        delete tab->largeView;
         delete tab->preview;
+        delete tab->nativePreview;
         delete openTabs[index];
         openTabs.removeAt(index);
         fileTabs->removeTab(index);
@@ -84,9 +261,9 @@ void MainWindow::setupUi() {
     connect(fileTabs, &QTabWidget::currentChanged, this, &MainWindow::onTabChanged);
 
     // 创建垂直分割器并添加组件
-    verticalSplitter->addWidget(fileList);
+    verticalSplitter->addWidget(fileTree);
     verticalSplitter->addWidget(fileTabs);
-    verticalSplitter->setStretchFactor(0, 1);// fileList 占比
+    verticalSplitter->setStretchFactor(0, 1);// fileTree 占比
     verticalSplitter->setStretchFactor(1, 4);// fileTabs 占比
                                              // 设置手柄的宽度（可根据需要调整）
     verticalSplitter->setHandleWidth(8);
@@ -138,6 +315,7 @@ void MainWindow::setupUi() {
     QAction *openFileAction = new QAction("打开文件 CTRL+O", this);
     QAction *openFolderAction = new QAction("打开文件夹 CTRL+L", this);
     QAction *insertImageAction = new QAction("插入图片 CTRL+I", this);
+    QAction *batchExportAction = new QAction("批量导出 CTRL+E", this);
     fileMenu->addAction(insertImageAction);
     connect(insertImageAction, &QAction::triggered, this, &MainWindow::insertImage);
 
@@ -151,6 +329,36 @@ void MainWindow::setupUi() {
     fileMenu->addAction(saveFileAction);
     fileMenu->addAction(deleteFileAction);
     fileMenu->addAction(fontAction);
+    fileMenu->addAction(batchExportAction);
+    QAction *historyAction = new QAction("历史版本…", this);
+    fileMenu->addAction(historyAction);
+    connect(historyAction, &QAction::triggered, this, &MainWindow::showVersionHistory);
+    QAction *largeFileAction = new QAction("大文件阈值…", this);
+    fileMenu->addAction(largeFileAction);
+    connect(largeFileAction, &QAction::triggered, this, &MainWindow::setLargeFileThreshold);
+    QAction *collapseAction = new QAction("折叠不活动标签…", this);
+    fileMenu->addAction(collapseAction);
+    connect(collapseAction, &QAction::triggered, this, &MainWindow::setCollapseIdleTime);
+    spellCheckAction = new QAction("拼写检查", this);
+    spellCheckAction->setCheckable(true);
+    QAction *spellLanguageAction = new QAction("拼写词典…", this);
+    fileMenu->addAction(spellCheckAction);
+    fileMenu->addAction(spellLanguageAction);
+    connect(spellCheckAction, &QAction::toggled, this, [this](bool checked) {
+        settings.spellCheck = checked;
+        spellChecker->setEnabled(checked);
+        saveSettings();
+    });
+    connect(spellLanguageAction, &QAction::triggered, this, &MainWindow::chooseSpellLanguage);
+    nativePreviewAction = new QAction("轻量预览（不使用 Chromium）", this);
+    nativePreviewAction->setCheckable(true);
+    fileMenu->addAction(nativePreviewAction);
+    connect(nativePreviewAction, &QAction::triggered, this, [this](bool checked) {
+        settings.nativePreview = checked;
+        saveSettings();
+        rebuildPreviews();
+    });
+    connect(batchExportAction, &QAction::triggered, this, &MainWindow::batchExport);
 
     connect(newFileAction, &QAction::triggered, this, &MainWindow::createNewFile);
     connect(saveFileAction, &QAction::triggered, this, &MainWindow::saveFile);
@@ -165,6 +373,13 @@ void MainWindow::setupUi() {
             settings.fontSize = font.pointSize();
             // 更新所有打开的编辑器
             for (auto tab: openTabs) {
+                if (tab->largeView) {
+                    tab->largeView->setTextFont(font);
+                    loadMarkdown(previewSource(tab), tab);
+                }
+                if (!tab->editor) {
+                    continue;// 未实例化的标签在创建时读取设置
+                }
                 tab->editor->setFont(font);
                 loadMarkdown(tab->editor->toPlainText(), tab);
             }
@@ -172,6 +387,28 @@ void MainWindow::setupUi() {
         }
     });
 
+    // 调试菜单：按键到预览的延迟追踪
+    QMenu *debugMenu = menuBar->addMenu("调试");
+    QAction *latencyHudAction = new QAction("显示延迟 HUD", this);
+    latencyHudAction->setCheckable(true);
+    QAction *exportTraceAction = new QAction("导出追踪 (Chrome trace)", this);
+    debugMenu->addAction(latencyHudAction);
+    debugMenu->addAction(exportTraceAction);
+    QAction *previewMemoryAction = new QAction("预览内存…", this);
+    debugMenu->addAction(previewMemoryAction);
+    connect(previewMemoryAction, &QAction::triggered, this, &MainWindow::showPreviewMemory);
+    connect(latencyHudAction, &QAction::toggled, this, [this](bool checked) {
+        latencyHudLabel->setVisible(checked);
+        if (checked) {
+            updateLatencyHud();
+            latencyHudTimer->start(500);
+        } else {
+            latencyHudTimer->stop();
+        }
+    });
+    connect(exportTraceAction, &QAction::triggered, this, &MainWindow::exportTrace);
+    connect(latencyHudTimer, &QTimer::timeout, this, &MainWindow::updateLatencyHud);
+
     // 主题菜单
     QMenu *themeMenu = menuBar->addMenu("Themes");
     QStringList themes = {"Light", "Dark", "Solarized Light", "Solarized Dark"};
@@ -187,6 +424,10 @@ void MainWindow::setupUi() {
     connect(autoSaveTimer, &QTimer::timeout, this, &MainWindow::autoSaveFile);
     autoSaveTimer->start(10000);// 每10秒自动保存
 
+    // 每分钟检查一次，把长时间不活动的标签折叠成压缩存档
+    connect(collapseTimer, &QTimer::timeout, this, &MainWindow::collapseIdleTabs);
+    collapseTimer->start(60000);
+
     // 设置快捷键
     new QShortcut(QKeySequence("Ctrl+N"), this, SLOT(createNewFile()));
     new QShortcut(QKeySequence("Ctrl+S"), this, SLOT(saveFile()));
@@ -195,6 +436,7 @@ void MainWindow::setupUi() {
     new QShortcut(QKeySequence("Ctrl+O"), this, SLOT(openFileDialog()));
     new QShortcut(QKeySequence("Ctrl+L"), this, SLOT(openFolderDialog()));
     new QShortcut(QKeySequence("Ctrl+I"), this, SLOT(insertImage()));
+    new QShortcut(QKeySequence("Ctrl+E"), this, SLOT(batchExport()));
 
     // 创建状态栏
     QStatusBar *statusBar = new QStatusBar(this);
@@ -205,6 +447,36 @@ void MainWindow::setupUi() {
     statusBar->addWidget(wordCountLabel);
     lastSavedLabel = new QLabel("上次保存: 从未", this);
     statusBar->addWidget(lastSavedLabel);
+    latencyHudLabel = new QLabel(this);
+    latencyHudLabel->setVisible(false);
+    statusBar->addPermanentWidget(latencyHudLabel);
+
+    // 反向链接面板：列出引用当前文件的笔记
+    QDockWidget *backlinksDock = new QDockWidget("反向链接", this);
+    backlinksList = new QListWidget(backlinksDock);
+    backlinksDock->setWidget(backlinksList);
+    addDockWidget(Qt::RightDockWidgetArea, backlinksDock);
+    connect(backlinksList, &QListWidget::itemClicked, this, [this](QListWidgetItem *item) {
+        QFileInfo fileInfo(item->data(Qt::UserRole).toString());
+        QDir::setCurrent(fileInfo.dir().absolutePath());
+        loadFile(fileInfo.absoluteFilePath());
+    });
+    connect(linkGraph, &LinkGraph::backlinksChanged, this, &MainWindow::onBacklinksChanged);
+
+    // 大纲面板：与反向链接面板叠放
+    QDockWidget *outlineDock = new QDockWidget("大纲", this);
+    outlineView = new QListView(outlineDock);
+    outlineView->setModel(outlineModel);
+    outlineView->setUniformItemSizes(true);// 标题很多时也只按可见行布局
+    outlineView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    outlineDock->setWidget(outlineView);
+    addDockWidget(Qt::RightDockWidgetArea, outlineDock);
+    tabifyDockWidget(backlinksDock, outlineDock);
+    connect(outlineView, &QListView::clicked, this, &MainWindow::jumpToHeading);
+
+    outlineTimer->setInterval(150);
+    outlineTimer->setSingleShot(true);
+    connect(outlineTimer, &QTimer::timeout, this, &MainWindow::refreshOutline);
 }
 
 inline void MainWindow::refreshPreviews() noexcept {
@@ -212,26 +484,47 @@ inline void MainWindow::refreshPreviews() noexcept {
 
     if (currentIndex != -1 && currentIndex < openTabs.size()) {
         FileTab *currentTab = openTabs[currentIndex];
+        qint64 keystrokeNs = pendingKeystrokeNs;
+        pendingKeystrokeNs = -1;
+        if (keystrokeNs >= 0) {
+            Tracer::record("debounce wait", keystrokeNs, Tracer::now());
+        }
+        if (!currentTab->editor) {
+            return;// 大文件视图翻页时自行刷新
+        }
         QString markdown = currentTab->editor->toPlainText();
-        int scrollY = openTabs[currentIndex]->scrollY;
-        std::cout<<scrollY<<std::endl;
-        loadMarkdown(markdown, currentTab);
+        loadMarkdown(markdown, currentTab, keystrokeNs);
     }
 }
 
 
+// 编辑器与大文件视图共用的主题样式，未知主题返回空串
+static QString editorStyle(const QString &theme) {
+    if (theme == "Light") {
+        return "background-color: white; color: black;";
+    } else if (theme == "Dark") {
+        return "background-color: black; color: white;";
+    } else if (theme == "Solarized Light") {
+        return "background-color: #FDF6E3; color: #657B83;";
+    } else if (theme == "Solarized Dark") {
+        return "background-color: #073642; color: #839496;";
+    }
+    return QString();
+}
+
 void MainWindow::applyThemeToAllTabs() {
+    QString style = editorStyle(currentTheme);
     for (auto tab: openTabs) {
-        // 应用编辑器的样式
-        if (currentTheme == "Light") {
-            tab->editor->setStyleSheet("background-color: white; color: black;");
-        } else if (currentTheme == "Dark") {
-            tab->editor->setStyleSheet("background-color: black; color: white;");
-        } else if (currentTheme == "Solarized Light") {
-            tab->editor->setStyleSheet("background-color: #FDF6E3; color: #657B83;");
-        } else if (currentTheme == "Solarized Dark") {
-            tab->editor->setStyleSheet("background-color: #073642; color: #839496;");
+        if (tab->largeView) {
+            tab->largeView->setTextStyleSheet(style);
+            loadMarkdown(previewSource(tab), tab);
+        }
+        if (!tab->editor) {
+            continue;
         }
+        // 应用编辑器的样式
+        tab->editor->setStyleSheet(style);
+        tab->editor->setHighlightTheme(currentTheme.contains("Dark"));
 
         // 重新加载 Markdown 以应用主题变化
         loadMarkdown(tab->editor->toPlainText(), tab);
@@ -239,115 +532,56 @@ void MainWindow::applyThemeToAllTabs() {
 }
 
 void MainWindow::loadFileList() {
-    fileList->clear();
     QDir dir(QDir::currentPath());
-    QStringList files = dir.entryList(QStringList() << "*.md", QDir::Files);
-    fileList->addItems(files);
+    fileTreeModel->setRootPath(dir.absolutePath());
+    linkGraph->indexDirectory(dir.absolutePath());
 }
 
-void MainWindow::openFile(QListWidgetItem *item) {
-    QString fileName = item->text();
-    QString filePath = QDir::currentPath() + "/" + fileName;
+void MainWindow::openFile(const QModelIndex &index) {
+    if (!index.isValid() || fileTreeModel->isDir(index)) {
+        return;// 目录由视图展开
+    }
+    openFilePath(fileTreeModel->filePath(index));
+}
 
+void MainWindow::openFilePath(const QString &filePath) {
     // 检查文件是否已在标签页中打开
+    const QString normalized = LinkGraph::normalizePath(filePath);
     for (int i = 0; i < openTabs.size(); ++i) {
-        if (openTabs[i]->filePath == filePath) {
+        if (LinkGraph::normalizePath(openTabs[i]->filePath) == normalized) {
             fileTabs->setCurrentIndex(i);
             return;
         }
     }
 
-    // 创建新的标签页
+    // 创建新的标签页并立即实例化
+    FileTab *newTab = addTab(filePath);
+    materializeTab(newTab);
+    fileTabs->setCurrentWidget(newTab->page);
+}
+
+FileTab *MainWindow::addTab(const QString &filePath) {
+    // 只创建占位页面，编辑器和预览在首次激活时由 materializeTab 创建
     FileTab *newTab = new FileTab;
     newTab->filePath = filePath;
-    newTab->editor = new QTextEdit(this);
-    newTab->preview = new QWebEngineView(this);
+    newTab->editor = nullptr;
+    newTab->largeView = nullptr;
+    newTab->preview = nullptr;
+    newTab->nativePreview = nullptr;
+    newTab->revision = 0;
+    newTab->splitter = nullptr;
     newTab->scrollY = 0;// 初始化滚动位置
-
-    // 禁用滚动动画
-    newTab->preview->settings()->setAttribute(QWebEngineSettings::ScrollAnimatorEnabled, false);
-    newTab->preview->settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
-
-    // 启用 GPU 加速
-    newTab->preview->settings()->setAttribute(QWebEngineSettings::Accelerated2dCanvasEnabled, true);
-    newTab->preview->settings()->setAttribute(QWebEngineSettings::WebGLEnabled, true);
-
-    // 尝试禁用平滑滚动
-    newTab->preview->settings()->setAttribute(QWebEngineSettings::ScrollAnimatorEnabled, false);
-
-
-    // 应用设置
-    QFont font(settings.font, settings.fontSize);
-    newTab->editor->setFont(font);
-
-    // 设置 Tab 停靠距离为 4 个字符宽度
-    QFontMetrics metrics(font);
-    int charWidth = metrics.horizontalAdvance(' ');// 获取空格字符的宽度
-    newTab->editor->setTabStopDistance(4 * charWidth);
-
-    // 设置主题样式
-    if (currentTheme == "Light") {
-        newTab->editor->setStyleSheet("background-color: white; color: black;");
-    } else if (currentTheme == "Dark") {
-        newTab->editor->setStyleSheet("background-color: black; color: white;");
-    } else if (currentTheme == "Solarized Light") {
-        newTab->editor->setStyleSheet("background-color: #FDF6E3; color: #657B83;");
-    } else if (currentTheme == "Solarized Dark") {
-        newTab->editor->setStyleSheet("background-color: #073642; color: #839496;");
-    }
-
-    // 加载文件内容
-    QFile file(filePath);
-    if (file.open(QFile::ReadOnly | QFile::Text)) {
-        newTab->editor->setPlainText(QString::fromUtf8(file.readAll()));
-        file.close();
-    }
-
-    // 设置预览
-    loadMarkdown(newTab->editor->toPlainText(), newTab);
-
-    // 连接文本变化信号
-    connect(newTab->editor, &QTextEdit::textChanged, this, &MainWindow::onTextChanged);
+    newTab->cursorPosition = 0;
+    newTab->editorScroll = 0;
+    newTab->mergePending = false;
+    newTab->mergeSerial = 0;
+    newTab->journal = nullptr;
+    newTab->lastActive = QDateTime::currentMSecsSinceEpoch();
 
     // 创建布局
-    QWidget *tabWidget = new QWidget();
-    QVBoxLayout *layout = new QVBoxLayout(tabWidget);
-    QSplitter *splitter = new QSplitter(Qt::Vertical, tabWidget);
-
-    QString splitterStyle = R"(
-    QSplitter::handle {
-        background-color: #cccccc; /* 手柄的背景颜色 */
-    }
-    QSplitter::handle:hover {
-        background-color: #aaaaaa; /* 鼠标悬停时的颜色 */
-    }
-    QSplitter::handle:pressed {
-        background-color: #888888; /* 手柄被按下时的颜色 */
-    }
-    QSplitter::handle:horizontal {
-        width: 8px; /* 水平分隔器的手柄宽度 */
-        border-left: 1px solid #dddddd;
-        border-right: 1px solid #dddddd;
-    }
-    QSplitter::handle:vertical {
-        height: 8px; /* 垂直分隔器的手柄高度 */
-        border-top: 1px solid #dddddd;
-        border-bottom: 1px solid #dddddd;
-    }
-)";
-    splitter->setStyleSheet(splitterStyle);
-    splitter->addWidget(newTab->editor);
-    splitter->addWidget(newTab->preview);
-    splitter->setStretchFactor(0, 2);// 编辑区占比
-    splitter->setStretchFactor(1, 3);// 预览区占比
-
-    // 设置预览区的初始大小比例 (40% 编辑区, 60% 预览区)
-    QList<int> splitterSizes;
-    splitterSizes << height() * 2 / 5 << height() * 3 / 5;
-    splitter->setSizes(splitterSizes);
-
-    layout->addWidget(splitter);
-    tabWidget->setLayout(layout);
+    newTab->page = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(newTab->page);
+    newTab->page->setLayout(layout);
 
     // 添加到标签页
     QString displayName = QFileInfo(filePath).fileName();
@@ -416,14 +650,235 @@ QTabBar::close-button:pressed {
 )";
 
     fileTabs->setStyleSheet(tabWidgetStyle);
-    fileTabs->addTab(tabWidget, displayName);
-    openTabs.append(newTab);// 确保同步
-    fileTabs->setCurrentWidget(tabWidget);
+    openTabs.append(newTab);// 先加入列表，保证 currentChanged 触发时能找到对应的标签
+    fileTabs->addTab(newTab->page, displayName);
+    return newTab;
+}
+
+// 标签页中编辑区与预览区之间的分割器样式
+static QString tabSplitterStyle() {
+    return R"(
+    QSplitter::handle {
+        background-color: #cccccc; /* 手柄的背景颜色 */
+    }
+    QSplitter::handle:hover {
+        background-color: #aaaaaa; /* 鼠标悬停时的颜色 */
+    }
+    QSplitter::handle:pressed {
+        background-color: #888888; /* 手柄被按下时的颜色 */
+    }
+    QSplitter::handle:horizontal {
+        width: 8px; /* 水平分隔器的手柄宽度 */
+        border-left: 1px solid #dddddd;
+        border-right: 1px solid #dddddd;
+    }
+    QSplitter::handle:vertical {
+        height: 8px; /* 垂直分隔器的手柄高度 */
+        border-top: 1px solid #dddddd;
+        border-bottom: 1px solid #dddddd;
+    }
+)";
+}
+
+void MainWindow::materializeTab(FileTab *tab) {
+    if (tab->editor || tab->largeView) {
+        return;
+    }
+    if (QFileInfo(tab->filePath).size() >= qint64(settings.largeFileMB) * 1024 * 1024) {
+        tab->archive.clear();// 折叠期间文件变大了，按大文件重新打开
+        materializeLargeTab(tab);
+        return;
+    }
+    MarkdownEditor *editor = new MarkdownEditor(this);
+    connect(editor, &MarkdownEditor::imagePasted, this, [this, tab](const QImage &image) { pasteImage(tab, image); });
+    connect(editor, &MarkdownEditor::imageFilesPasted, this, [this, tab](const QStringList &paths) { importImageFiles(tab, paths); });
+    tab->editor = editor;
+
+    // 应用设置
+    QFont font(settings.font, settings.fontSize);
+    tab->editor->setFont(font);
+
+    // 设置 Tab 停靠距离为 4 个字符宽度
+    QFontMetrics metrics(font);
+    int charWidth = metrics.horizontalAdvance(' ');// 获取空格字符的宽度
+    tab->editor->setTabStopDistance(4 * charWidth);
+
+    // 设置主题样式
+    tab->editor->setStyleSheet(editorStyle(currentTheme));
 
-    // 更新最近打开的文件
-    saveLastOpenedFile(filePath);
+    // 加载文件内容；原始字节交给监视器作为比较基准
+    QFile file(tab->filePath);
+    QByteArray content;
+    if (file.open(QFile::ReadOnly)) {
+        content = file.readAll();
+        file.close();
+    }
+    const QString onDisk = QString::fromUtf8(content).replace("\r\n", "\n");
+    TabViewState restored{tab->cursorPosition, tab->cursorPosition, tab->editorScroll};
+    if (!tab->archive.isEmpty()) {
+        // 折叠过的标签：从存档重放出文本和撤销历史。折叠期间文件被外部修改的，
+        // 先恢复折叠时的内容，最后再按外部修改重新加载，这次加载也可以撤销
+        QString archived;
+        tab->journal = TabArchive::restore(tab->archive, tab->editor->document(), restored, archived);
+        tab->archive.clear();
+        if (tab->journal) {
+            tab->diskText = archived;
+        }
+    }
+    if (!tab->journal) {
+        tab->diskText = onDisk;
+        tab->editor->setPlainText(tab->diskText);
+        tab->journal = new EditJournal(tab->editor->document(), tab->diskText);
+    }
+    fileMonitor->watch(tab->filePath, content);
+    tab->editor->setSpellChecker(spellChecker);
+    tab->editor->setHighlightTheme(currentTheme.contains("Dark"));
+
+    // 连接文本变化信号；每次修改换一个修订号，快照按修订号共享
+    snapshots.forget(tab->filePath);
+    connect(tab->editor->document(), &QTextDocument::contentsChanged, this, [tab]() { ++tab->revision; });
+    connect(tab->editor, &QTextEdit::textChanged, this, &MainWindow::onTextChanged);
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical, tab->page);
+
+    splitter->setStyleSheet(tabSplitterStyle());
+    splitter->addWidget(tab->editor);
+    tab->splitter = splitter;
+    tab->page->layout()->addWidget(splitter);
+    if (previewsReady) {
+        attachPreview(tab);
+    }
+
+    // 恢复会话或存档中保存的选区和滚动位置
+    if (restored.position > 0 || restored.anchor > 0) {
+        const int last = tab->editor->document()->characterCount() - 1;
+        QTextCursor cursor = tab->editor->textCursor();
+        cursor.setPosition(qMin(restored.anchor, last));
+        cursor.setPosition(qMin(restored.position, last), QTextCursor::KeepAnchor);
+        tab->editor->setTextCursor(cursor);
+    }
+    if (restored.scroll > 0) {
+        // 等文档布局完成、滚动范围确定后再设置
+        QTimer::singleShot(0, tab->editor, [tab, scroll = restored.scroll]() {
+            tab->editor->verticalScrollBar()->setValue(scroll);
+        });
+    }
+    if (tab->diskText != onDisk) {
+        onExternalChange(tab->filePath, content);
+    }
+}
+
+
+void MainWindow::materializeLargeTab(FileTab *tab) {
+    // 超大文件不载入编辑器：内存映射后只读分页显示，预览只渲染当前页
+    tab->largeView = new LargeFileView(tab->filePath, this);
+    tab->largeView->setTextFont(QFont(settings.font, settings.fontSize));
+    tab->largeView->setTextStyleSheet(editorStyle(currentTheme));
+    connect(tab->largeView, &LargeFileView::pageChanged, this, [this, tab]() {
+        if (tab->preview) {
+            tab->scrollY = 0;
+            loadMarkdown(previewSource(tab), tab);
+            tab->preview->page()->runJavaScript("window.scrollTo(0, 0);");
+        } else if (tab->nativePreview) {
+            tab->scrollY = 0;
+            loadMarkdown(previewSource(tab), tab);
+            tab->nativePreview->verticalScrollBar()->setValue(0);
+        }
+    });
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical, tab->page);
+    splitter->setStyleSheet(tabSplitterStyle());
+    splitter->addWidget(tab->largeView);
+    tab->splitter = splitter;
+    tab->page->layout()->addWidget(splitter);
+    if (previewsReady) {
+        attachPreview(tab);
+    }
+}
+
+QString MainWindow::previewSource(FileTab *tab) const {
+    if (tab->largeView) {
+        return tab->largeView->pageText();
+    }
+    return tab->editor ? tab->editor->toPlainText() : QString();
 }
 
+void MainWindow::setLargeFileThreshold() {
+    bool ok;
+    int megabytes = QInputDialog::getInt(this, "大文件阈值", "超过该大小（MB）的文件以只读方式分页打开：",
+                                         settings.largeFileMB, 1, 100000, 1, &ok);
+    if (ok) {
+        settings.largeFileMB = megabytes;// 对之后打开的文件生效
+        saveSettings();
+    }
+}
+
+
+void MainWindow::setCollapseIdleTime() {
+    bool ok;
+    int minutes = QInputDialog::getInt(this, "折叠不活动标签", "不活动超过该时间（分钟）的标签压缩保存，0 表示不折叠：",
+                                       settings.collapseIdleMinutes, 0, 7 * 24 * 60, 1, &ok);
+    if (ok) {
+        settings.collapseIdleMinutes = minutes;
+        saveSettings();
+    }
+}
+
+void MainWindow::collapseIdleTabs() {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const int current = fileTabs->currentIndex();
+    if (current >= 0 && current < openTabs.size()) {
+        openTabs[current]->lastActive = now;// 离开当前标签时，不活动时间从最近一次检查算起
+    }
+    if (settings.collapseIdleMinutes <= 0) {
+        return;
+    }
+    const qint64 idleMs = qint64(settings.collapseIdleMinutes) * 60 * 1000;
+    for (int i = 0; i < openTabs.size(); ++i) {
+        FileTab *tab = openTabs[i];
+        if (i == current || !tab->editor || !tab->journal || now - tab->lastActive < idleMs) {
+            continue;
+        }
+        // 先保存，折叠的标签与磁盘一致；正在合并或保存失败的留到下次
+        if (writeTabToFile(tab) && !tab->mergePending) {
+            collapseTab(tab);
+        }
+    }
+}
+
+void MainWindow::collapseTab(FileTab *tab) {
+    QTextCursor cursor = tab->editor->textCursor();
+    const TabViewState state{cursor.anchor(), cursor.position(), tab->editor->verticalScrollBar()->value()};
+    tab->archive = TabArchive::store(tab->editor->document(), *tab->journal, state);
+    tab->cursorPosition = state.position;// 会话保存时使用
+    tab->editorScroll = state.scroll;
+
+    // 文档的 AST、预览页面和编辑器一并释放，外部修改留到恢复时再比较
+    fileMonitor->unwatch(tab->filePath);
+    snapshots.forget(tab->filePath);
+    detachPreview(tab);
+    delete tab->splitter;// 编辑器和它的编辑日志随之销毁
+    tab->splitter = nullptr;
+    tab->editor = nullptr;
+    tab->journal = nullptr;
+    tab->diskText = QString();
+}
+
+void MainWindow::chooseSpellLanguage() {
+    const QStringList languages = SpellChecker::availableLanguages();
+    if (languages.isEmpty()) {
+        QMessageBox::information(this, "拼写词典", "没有找到 Hunspell 词典（.dic 与 .aff），可以放到程序目录下的 dictionaries 文件夹中。");
+        return;
+    }
+    bool ok;
+    QString language = QInputDialog::getItem(this, "拼写词典", "拼写检查使用的词典：", languages,
+                                             qMax(0, int(languages.indexOf(settings.spellLanguage))), false, &ok);
+    if (ok && language != settings.spellLanguage) {
+        settings.spellLanguage = language;
+        spellChecker->setLanguage(language);
+        saveSettings();
+    }
+}
 
 void MainWindow::createNewFile() {
     bool ok;
@@ -441,36 +896,36 @@ void MainWindow::createNewFile() {
         }
         file.close();
 
-        // 更新文件列表
-        loadFileList();
-
-        // 打开新文件
-        QList<QListWidgetItem *> items = fileList->findItems(fullFileName, Qt::MatchExactly);
-        if (!items.isEmpty()) {
-            openFile(items.first());
-        }
+        // 加入文件树并打开
+        fileTreeModel->addFile(filePath);
+        openFilePath(filePath);
     }
 }
 
 void MainWindow::deleteFile() {
-    QListWidgetItem *item = fileList->currentItem();
-    if (item) {
-        QString fileName = item->text();
-        QString filePath = QDir::currentPath() + "/" + fileName;
+    QModelIndex index = fileTree->currentIndex();
+    if (index.isValid() && !fileTreeModel->isDir(index)) {
+        QString filePath = fileTreeModel->filePath(index);
         if (QFile::remove(filePath)) {
+            linkGraph->removeDocument(filePath);
             // 关闭已打开的标签页
             for (int i = 0; i < openTabs.size(); ++i) {
-                if (openTabs[i]->filePath == filePath) {
+                if (LinkGraph::normalizePath(openTabs[i]->filePath) == filePath) {
+                    // 先从列表中取出：removeTab 触发的 currentChanged 要按新的下标找到新的当前标签
+                    FileTab *tab = openTabs.takeAt(i);
+                    fileMonitor->unwatch(tab->filePath);
+                    snapshots.forget(tab->filePath);
+                    delete tab->editor;
+                    delete tab->largeView;
+                    delete tab->preview;
+                    delete tab->nativePreview;
                     fileTabs->removeTab(i);
-                    delete openTabs[i]->editor;
-                    delete openTabs[i]->preview;
-                    delete openTabs[i];
-                    openTabs.removeAt(i);
+                    delete tab;
                     break;
                 }
             }
-            // 从列表中移除
-            delete fileList->takeItem(fileList->row(item));
+            // 从文件树中移除
+            fileTreeModel->removeFile(filePath);
             QMessageBox::information(this, "删除文件", "文件已成功删除。");
         } else {
             QMessageBox::warning(this, "删除文件", "删除文件失败。");
@@ -487,11 +942,7 @@ void MainWindow::saveFile() {
             return;
         }
 
-        QFile file(currentTab->filePath);
-        if (file.open(QFile::WriteOnly | QFile::Text)) {
-            QTextStream out(&file);
-            out << currentTab->editor->toPlainText();
-            file.close();
+        if (writeTabToFile(currentTab)) {
             lastSavedLabel->setText(QString("上次保存: %1").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")));
         } else {
             QMessageBox::warning(this, "保存失败", "无法保存文件。");
@@ -503,19 +954,22 @@ void MainWindow::saveFileAs() {
     int currentIndex = fileTabs->currentIndex();
     if (currentIndex != -1 && currentIndex < openTabs.size()) {
         FileTab *currentTab = openTabs[currentIndex];
+        if (currentTab->largeView) {
+            QMessageBox::warning(this, "另存为", "大文件以只读方式打开，不能另存为。");
+            return;
+        }
         QString fileName = QFileDialog::getSaveFileName(this, "另存为", "", "Markdown Files (*.md);;All Files (*)");
         if (!fileName.isEmpty()) {
+            fileMonitor->unwatch(currentTab->filePath);
+            snapshots.forget(currentTab->filePath);
             currentTab->filePath = fileName;
-            QFile file(fileName);
-            if (file.open(QFile::WriteOnly | QFile::Text)) {
-                QTextStream out(&file);
-                out << currentTab->editor->toPlainText();
-                file.close();
+            currentTab->diskText = QString();// 新文件必须写入
+            if (writeTabToFile(currentTab)) {
                 // 更新标签标题
                 QString displayName = QFileInfo(fileName).fileName();
                 fileTabs->setTabText(currentIndex, displayName);
-                // 更新文件列表
-                loadFileList();
+                // 更新文件树
+                fileTreeModel->addFile(fileName);
                 lastSavedLabel->setText(QString("上次保存: %1").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")));
             } else {
                 QMessageBox::warning(this, "保存失败", "无法保存文件。");
@@ -528,20 +982,9 @@ void MainWindow::saveFileAs() {
 void MainWindow::openFileDialog() {
     QString filePath = QFileDialog::getOpenFileName(this, "打开文件", "", "Markdown Files (*.md);;All Files (*)");
     if (!filePath.isEmpty()) {
-        // 提取文件名
-        QFileInfo fileInfo(filePath);
-        QString fileName = fileInfo.fileName();
         // 设置当前目录
-        QDir::setCurrent(fileInfo.dir().absolutePath());
-        // 检查文件是否已在列表中
-        if (!fileList->findItems(fileName, Qt::MatchExactly).count()) {
-            fileList->addItem(fileName);
-        }
-        // 查找并打开文件
-        QList<QListWidgetItem *> items = fileList->findItems(fileName, Qt::MatchExactly);
-        if (!items.isEmpty()) {
-            openFile(items.first());
-        }
+        QDir::setCurrent(QFileInfo(filePath).dir().absolutePath());
+        loadFile(filePath);
     }
 }
 
@@ -553,37 +996,83 @@ void MainWindow::openFolderDialog() {
     }
 }
 
+void MainWindow::batchExport() {
+    if (exportFuture.isRunning()) {
+        QMessageBox::information(this, "批量导出", "上一次导出还没有完成。");
+        return;
+    }
+    QString sourceDir = QFileDialog::getExistingDirectory(this, "选择要导出的笔记目录", QDir::currentPath());
+    if (sourceDir.isEmpty()) {
+        return;
+    }
+    QString outputDir = QFileDialog::getExistingDirectory(this, "选择输出目录");
+    if (outputDir.isEmpty()) {
+        return;
+    }
+    bool ok;
+    QString formatList = QInputDialog::getText(this, "批量导出", "导出格式（html,latex,man,commonmark）:", QLineEdit::Normal, "html", &ok);
+    if (!ok) {
+        return;
+    }
+    int formats = BatchExporter::parseFormats(formatList);
+    if (!formats) {
+        QMessageBox::warning(this, "批量导出", "无法识别的导出格式。");
+        return;
+    }
+
+    BatchExporter exporter(sourceDir, outputDir, formats);
+    QPalette globalPalette = QApplication::palette();
+    exporter.setPageStyle(PageStyle{globalPalette.color(QPalette::Window).name(),
+                                    globalPalette.color(QPalette::WindowText).name(),
+                                    settings.font, settings.fontSize});
+
+    // 在后台线程导出，进度经 QFutureWatcher 回到界面线程；工作线程不直接访问窗口
+    statusBar()->showMessage("正在导出...");
+    auto *watcher = new QFutureWatcher<ExportStats>(this);
+    connect(watcher, &QFutureWatcher<ExportStats>::progressValueChanged, this, [this, watcher](int done) {
+        statusBar()->showMessage(QString("正在导出 %1/%2").arg(done).arg(watcher->progressMaximum()));
+    });
+    connect(watcher, &QFutureWatcher<ExportStats>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        statusBar()->clearMessage();
+        if (watcher->isCanceled()) {
+            return;
+        }
+        ExportStats stats = watcher->result();
+        qInfo().noquote() << "[export]" << stats.summary();
+        QMessageBox::information(this, "批量导出", stats.summary());
+    });
+    exportFuture = QtConcurrent::run([exporter](QPromise<ExportStats> &promise) {
+        promise.addResult(exporter.run([&promise](int done, int total) {
+            if (done % 100 == 0 || done == total) {
+                promise.setProgressRange(0, total);
+                promise.setProgressValue(done);
+            }
+        }, [&promise]() { return promise.isCanceled(); }));
+    });
+    watcher->setFuture(exportFuture);
+}
+
 void MainWindow::loadFile(const QString &filePath) {
     QFileInfo fileInfo(filePath);
     if (fileInfo.exists() && fileInfo.isFile()) {
-        // 打开文件并添加到文件列表
-        QString fileName = fileInfo.fileName();
-        if (!fileList->findItems(fileName, Qt::MatchExactly).count()) {
-            fileList->addItem(fileName);
-        }
-        QList<QListWidgetItem *> items = fileList->findItems(fileName, Qt::MatchExactly);
-        if (!items.isEmpty()) {
-            openFile(items.first());
-        }
+        // 打开文件并添加到文件树
+        fileTreeModel->addFile(fileInfo.absoluteFilePath());
+        openFilePath(fileInfo.absoluteFilePath());
     }
 }
 
 void MainWindow::loadFilesInDirectory(const QString &folderPath) {
     QDir dir(folderPath);
-    QStringList files = dir.entryList(QStringList() << "*.md", QDir::Files);
-    fileList->clear();
-    fileList->addItems(files);
+    fileTreeModel->setRootPath(dir.absolutePath());
+    linkGraph->indexDirectory(dir.absolutePath());
 }
 
 void MainWindow::autoSaveFile() {
     for (int i = 0; i < openTabs.size(); ++i) {
         FileTab *tab = openTabs[i];
         if (!tab->filePath.isEmpty()) {
-            QFile file(tab->filePath);
-            if (file.open(QFile::WriteOnly | QFile::Text)) {
-                QTextStream out(&file);
-                out << tab->editor->toPlainText();
-                file.close();
+            if (writeTabToFile(tab)) {
                 // 仅更新当前标签的保存时间
                 if (fileTabs->currentIndex() == i) {
                     lastSavedLabel->setText(QString("上次保存: %1").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")));
@@ -591,27 +1080,41 @@ void MainWindow::autoSaveFile() {
             }
         }
     }
+    // 定期保存会话，异常退出时也能恢复标签
+    saveSession();
 }
 
 void MainWindow::onTextChanged() {
+    TraceSpan span("text change");
     // 更新当前标签的预览和字数
     int currentIndex = fileTabs->currentIndex();
     if (currentIndex != -1 && currentIndex < openTabs.size()) {
         FileTab *currentTab = openTabs[currentIndex];
-        QString markdown = currentTab->editor->toPlainText();
+        currentTab->lastActive = QDateTime::currentMSecsSinceEpoch();
         //保存滚动位置
-        auto y=currentTab->preview->page()->scrollPosition().y();
+        auto y = currentTab->preview ? currentTab->preview->page()->scrollPosition().y() : 0;
         //如果y不为0，则滚动到y位置
         if(y!=0){
-            currentTab->scrollY = currentTab->preview->page()->scrollPosition().y();
-            std::cout << "scrollY: " << currentTab->scrollY << std::endl;
+            currentTab->scrollY = y;
         }
-        refreshPreviews();
 
-        // 更新字数
-        int charCount = markdown.length();
-        wordCountLabel->setText(QString("字数: %1").arg(charCount));
+        // 连续输入时只在停顿后刷新一次预览，记录第一次按键的时间
+        if (pendingKeystrokeNs < 0) {
+            pendingKeystrokeNs = Tracer::now();
+        }
+        debounceTimer->start();
+        outlineTimer->start();// 大纲和字数在停顿后一起更新
+    }
+}
+
+// 生成图片的 Markdown；路径含空格或括号时用尖括号包起来
+static QString imageMarkdown(const QString &relativePath) {
+    QString alt = QFileInfo(relativePath).completeBaseName();
+    static const QRegularExpression special(R"([\s()<>])");
+    if (relativePath.contains(special)) {
+        return QString("![%1](<%2>)").arg(alt, relativePath);
     }
+    return QString("![%1](%2)").arg(alt, relativePath);
 }
 
 void MainWindow::insertImage() {
@@ -622,146 +1125,187 @@ void MainWindow::insertImage() {
     }
 
     FileTab *currentTab = openTabs[currentIndex];
-    QString imagePath = QFileDialog::getOpenFileName(this, "选择图片", "", "Image Files (*.png *.jpg *.jpeg *.bmp *.gif);;All Files (*)");
-    if (!imagePath.isEmpty() && !currentTab->filePath.isEmpty()) {
-        QFileInfo currentFileInfo(currentTab->filePath);
-        QString imagesDir = currentFileInfo.dir().absoluteFilePath("images");
-        QDir().mkpath(imagesDir);
-
-        QString imageName = QFileInfo(imagePath).fileName();
-        QString newImagePath = imagesDir + "/" + imageName;
-
-        if (!QFile::exists(newImagePath)) {
-            if (!QFile::copy(imagePath, newImagePath)) {
-                QMessageBox::critical(this, "错误", "无法复制图片");
-                return;
+    if (!currentTab->editor) {
+        QMessageBox::warning(this, "插入图片", "大文件以只读方式打开，不能插入图片。");
+        return;
+    }
+    if (currentTab->filePath.isEmpty()) {
+        QMessageBox::warning(this, "警告", "请先保存文件后再插入图片。");
+        return;
+    }
+    QStringList imagePaths = QFileDialog::getOpenFileNames(this, "选择图片", "", "Image Files (*.png *.jpg *.jpeg *.bmp *.gif *.webp);;All Files (*)");
+    if (!imagePaths.isEmpty()) {
+        importImageFiles(currentTab, imagePaths);
+    }
+}
+
+void MainWindow::importImageFiles(FileTab *tab, const QStringList &imagePaths) {
+    if (tab->filePath.isEmpty()) {
+        QMessageBox::warning(this, "警告", "请先保存文件后再插入图片。");
+        return;
+    }
+    QDir documentDir = QFileInfo(tab->filePath).absoluteDir();
+    QString imagesDir = documentDir.absoluteFilePath("images");
+
+    // 复制在后台进行；插入位置用独立的光标记录，期间的编辑会自动移动它
+    QPointer<QTextEdit> editor = tab->editor;
+    QTextCursor insertAt(editor->document());
+    insertAt.setPosition(editor->textCursor().position());
+    imagePipeline->importFiles(imagePaths, imagesDir, this, [this, editor, insertAt, documentDir](const QList<ImportedImage> &images) mutable {
+        if (!editor || insertAt.isNull()) {
+            return;// 标签已关闭
+        }
+        QStringList links;
+        QStringList failed;
+        for (const ImportedImage &image: images) {
+            if (image.path.isEmpty()) {
+                failed.append(QFileInfo(image.source).fileName());
+            } else {
+                links.append(imageMarkdown(documentDir.relativeFilePath(image.path)));// 使用相对于文档的路径
             }
         }
+        if (!links.isEmpty()) {
+            insertAt.insertText(links.join("\n"));// 插入Markdown，textChanged 会刷新预览
+        }
+        if (!failed.isEmpty()) {
+            QMessageBox::critical(this, "错误", "无法复制图片:\n" + failed.join("\n"));
+        }
+    });
+}
 
-        QString relativePath = QDir::current().relativeFilePath(newImagePath);// 使用相对路径
+void MainWindow::pasteImage(FileTab *tab, const QImage &image) {
+    if (tab->filePath.isEmpty()) {
+        QMessageBox::warning(this, "警告", "请先保存文件后再粘贴图片。");
+        return;
+    }
+    QDir documentDir = QFileInfo(tab->filePath).absoluteDir();
+    QString baseName = "paste-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz");
+
+    // 先插入占位文本，编码完成后替换成真正的链接，期间可以继续输入
+    QString placeholder = QString("![正在保存图片…](%1)").arg(baseName);
+    QPointer<QTextEdit> editor = tab->editor;
+    QTextCursor cursor = editor->textCursor();
+    int start = cursor.selectionStart();
+    cursor.insertText(placeholder);
+    editor->setTextCursor(cursor);
+    QTextCursor placeholderAt(editor->document());
+    placeholderAt.setPosition(start);
+    placeholderAt.setPosition(start + placeholder.size(), QTextCursor::KeepAnchor);
+
+    imagePipeline->importImage(image, documentDir.absoluteFilePath("images"), baseName, this,
+                               [this, editor, placeholderAt, placeholder, documentDir](const ImportedImage &stored) mutable {
+        if (!editor || placeholderAt.isNull()) {
+            return;// 标签已关闭
+        }
+        // 占位文本被部分修改过时按内容重新查找
+        if (placeholderAt.selectedText() != placeholder) {
+            placeholderAt = editor->document()->find(placeholder);
+            if (placeholderAt.isNull()) {
+                return;// 占位文本已被删除
+            }
+        }
+        if (stored.path.isEmpty()) {
+            placeholderAt.removeSelectedText();
+            QMessageBox::critical(this, "错误", "无法保存粘贴的图片");
+            return;
+        }
+        placeholderAt.insertText(imageMarkdown(documentDir.relativeFilePath(stored.path)));
+    });
+}
 
-        QTextCursor cursor = currentTab->editor->textCursor();
-        cursor.insertText(QString("![图片](%1)").arg(relativePath));// 插入Markdown
-        currentTab->editor->setTextCursor(cursor);
 
-        QString markdown = currentTab->editor->toPlainText();
-        loadMarkdown(markdown, currentTab);// 传递正确的 FileTab*
-        onTextChanged();
-    } else {
-        QMessageBox::warning(this, "警告", "请先保存文件后再插入图片。");
+DocumentSnapshotPtr MainWindow::documentSnapshot(FileTab *tab, const QString &markdown) {
+    // 编辑器中的文档按修订共享快照；大文件视图的分页文本每页单独解析
+    if (!tab->editor) {
+        return DocumentSnapshot::parse(markdown.toUtf8());
     }
+    return snapshots.snapshot(tab->filePath, tab->revision, [&markdown]() { return markdown.toUtf8(); });
 }
 
+PageStyle MainWindow::previewStyle(FileTab *tab) const {
+    QPalette globalPalette = QApplication::palette();
+    return PageStyle{globalPalette.color(QPalette::Window).name(),
+                     globalPalette.color(QPalette::WindowText).name(),
+                     tab->editor ? tab->editor->font().family() : settings.font,
+                     tab->editor ? tab->editor->font().pointSize() : settings.fontSize};
+}
 
-#include <QTemporaryFile>
-#include <QFile>
-#include <QTextStream>
-#include <QUrl>
+void MainWindow::renderNativePreview(const QString &markdown, FileTab *tab, qint64 keystrokeNs) {
+    // 轻量预览同步构建，大图仍换成缩略图；公式和图表按源码显示
+    const QString baseDir = QFileInfo(tab->filePath).absolutePath();
+    const QDir dir(baseDir);
+    qint64 start = Tracer::now();
+    tab->nativePreview->setSnapshot(documentSnapshot(tab, markdown), previewStyle(tab), baseDir, [this, &dir](const QString &url) {
+        QString path = LinkGraph::resolveTarget(dir, url);
+        return path.isEmpty() ? path : imagePipeline->previewImage(path);
+    });
+    qint64 end = Tracer::now();
+    Tracer::record("native preview", start, end);
+    if (keystrokeNs >= 0) {
+        Tracer::record("keystroke to preview", keystrokeNs, end);
+    }
+    emit previewRendered(tab);
+}
 
-inline void MainWindow::loadMarkdown(const QString &markdown, FileTab *tab) noexcept {
+inline void MainWindow::loadMarkdown(const QString &markdown, FileTab *tab, qint64 keystrokeNs) noexcept {
+    if (tab && tab->nativePreview) {
+        renderNativePreview(markdown, tab, keystrokeNs);
+        return;
+    }
     if (!tab || !tab->preview)
         return;
 
-    // 将 Markdown 转换为 HTML
-    QString html = HtmlConverter::convertToHtml(markdown);
+    // 外壳尚未加载完成时，由 loadFinished 负责首次注入
+    auto *page = static_cast<PreviewPage *>(tab->preview->page());
+    if (!page->isShellReady())
+        return;
 
-    // 获取样式和主题
-    QPalette globalPalette = QApplication::palette();
-    QString bgColor = globalPalette.color(QPalette::Window).name();
-    QString textColor = globalPalette.color(QPalette::WindowText).name();
-    QString fontFamily = tab->editor->font().family();
-    int fontSize = tab->editor->font().pointSize();
-
-    // 引入 Highlight.js 的 CSS 和 JS
-    static QString highlightCss = R"(
-        <link rel="stylesheet"
-              href="https://cdnjs.cloudflare.com/ajax/libs/highlight.js/11.7.0/styles/github.min.css">
-    )";
-
-    static QString highlightJs = R"(
-        <script src="https://cdnjs.cloudflare.com/ajax/libs/highlight.js/11.7.0/highlight.min.js"></script>
-        <script>hljs.highlightAll();</script>
-    )";
-
-    // 构建完整的 HTML
-    QString combinedHtml = QString(R"(
-        <!DOCTYPE html>
-        <html>
-        <head>
-            %1
-            %2
-            <style>
-                body {
-                    background-color: %3;
-                    color: %4;
-                    font-family: '%5';
-                    font-size: %6pt;
-                    padding: 20px;
-                    overflow-y: scroll;
-                }
-                pre, code {
-                    tab-size: 4;
-                    -moz-tab-size: 4;
-                    -o-tab-size: 4;
-                }
-                pre {
-                    background-color: #f0f0f0;
-                    color: #333333;
-                    padding: 10px;
-                    border-radius: 5px;
-                    overflow: auto;
-                }
-                code {
-                    background-color: #f0f0f0;
-                    color: #333333;
-                    padding: 2px 4px;
-                    border-radius: 3px;
-                }
-            </style>
-        </head>
-        <body>
-            %7
-        </body>
-        </html>
-    )")
-                                   .arg(highlightCss)
-                                   .arg(highlightJs)
-                                   .arg(bgColor)
-                                   .arg(textColor)
-                                   .arg(fontFamily)
-                                   .arg(fontSize)
-                                   .arg(html);
-
-    // 将 HTML 内容保存到临时文件中
-    QString tempFilePath = QDir::temp().filePath("preview.html");
-    QFile tempFile(tempFilePath);
-    if (tempFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&tempFile);
-        out << combinedHtml;
-        tempFile.close();
-    } else {
-        qDebug() << "Failed to write to temporary HTML file.";
+    // 已丢弃的页面不能执行脚本，保存的结果也已过期，重新显示时再转换
+    if (page->lifecycleState() == QWebEnginePage::LifecycleState::Discarded) {
+        tab->previewScript.clear();
         return;
     }
 
-    // 连接 loadFinished 信号，等待页面加载完成后再设置滚动条位置
-    connect(tab->preview, &QWebEngineView::loadFinished, this, [tab](bool success) {
-        if (success) {
-            // 页面加载成功后，恢复滚动条位置
-            tab->preview->page()->runJavaScript(QString("window.scrollTo(0, %1);").arg(tab->scrollY));
-        } else {
-            qDebug() << "Failed to load HTML content in preview.";
+    // 将 Markdown 转换为 HTML：公式先换成占位符，渲染后再替换成 MathML；
+    // 图表代码块换成缓存的 SVG；大图换成后台生成的缩略图。
+    // 编辑器文本只在这里转换一次 UTF-8，之后直到注入脚本都按字节处理
+    // 没有公式时直接渲染大纲、链接等共用的快照，不再单独解析
+    QVector<MathFormula> formulas;
+    QVector<DiagramSource> diagrams;
+    const QString prepared = MathRenderer::extractMath(markdown, formulas);
+    DocumentSnapshotPtr snapshot = formulas.isEmpty() ? documentSnapshot(tab, markdown) : DocumentSnapshot::parse(prepared.toUtf8());
+    QByteArray html = HtmlConverter::render(*snapshot, [&diagrams](cmark_node *document) {
+        diagrams += DiagramRenderer::collect(document);// 大文档分块解析时逐块调用
+    }, true);
+    html = mathRenderer.insertMath(html, formulas);
+    html = diagramRenderer->insertDiagrams(html, diagrams);
+    html = imagePipeline->rewritePreviewImages(html, QFileInfo(tab->filePath).absolutePath());
+
+    // 获取样式和主题
+    PageStyle style = previewStyle(tab);
+
+    // 相对路径（图片、链接）以文档所在目录为基准
+    QString baseUrl = QUrl::fromLocalFile(QFileInfo(tab->filePath).absolutePath() + "/").toString();
+
+    qint64 buildStart = Tracer::now();
+    // runJavaScript 只接受 QString，这是唯一一次转回 UTF-16；保留一份用于丢弃后的恢复
+    QString script = PageTemplate::setStyleScript(style) + QString::fromUtf8(PageTemplate::setContentScript(html, baseUrl));
+    tab->previewScript = script;
+    qint64 loadStart = Tracer::now();
+    Tracer::record("page build", buildStart, loadStart);
+
+    // 只替换外壳中的内容，不重新加载页面，滚动位置自然保留
+    page->runJavaScript(script, [this, tab, loadStart, keystrokeNs](const QVariant &) {
+        qint64 end = Tracer::now();
+        Tracer::record("page load", loadStart, end);
+        if (keystrokeNs >= 0) {
+            Tracer::record("keystroke to preview", keystrokeNs, end);
         }
+        emit previewRendered(tab);
     });
-
-    // 加载本地 HTML 文件
-    tab->preview->setUrl(QUrl::fromLocalFile(tempFilePath));
 }
 
 
-
-
-
 void MainWindow::onThemeChanged(const QString &theme) {
     currentTheme = theme;
     updatePalette(theme);
@@ -777,36 +1321,56 @@ inline void MainWindow::updatePalette(const QString &theme) noexcept {
         // 更新编辑器和文件列表的样式
         QString style = "background-color: white; color: black;";
         for (auto tab: openTabs) {
-            tab->editor->setStyleSheet(style);
+            if (tab->editor) {
+                tab->editor->setStyleSheet(style);
+            }
+            if (tab->largeView) {
+                tab->largeView->setTextStyleSheet(style);
+            }
         }
-        fileList->setStyleSheet(style);
+        fileTree->setStyleSheet(style);
         menuBar()->setStyleSheet("QMenuBar { background: white; color: black; } QMenu { background: white; color: black; }");
     } else if (theme == "Dark") {
         palette.setColor(QPalette::Window, Qt::black);
         palette.setColor(QPalette::WindowText, Qt::white);
         QString style = "background-color: black; color: white;";
         for (auto tab: openTabs) {
-            tab->editor->setStyleSheet(style);
+            if (tab->editor) {
+                tab->editor->setStyleSheet(style);
+            }
+            if (tab->largeView) {
+                tab->largeView->setTextStyleSheet(style);
+            }
         }
-        fileList->setStyleSheet(style);
+        fileTree->setStyleSheet(style);
         menuBar()->setStyleSheet("QMenuBar { background: black; color: white; } QMenu { background: black; color: white; }");
     } else if (theme == "Solarized Light") {
         palette.setColor(QPalette::Window, QColor("#FDF6E3"));
         palette.setColor(QPalette::WindowText, QColor("#657B83"));
         QString style = "background-color: #FDF6E3; color: #657B83;";
         for (auto tab: openTabs) {
-            tab->editor->setStyleSheet(style);
+            if (tab->editor) {
+                tab->editor->setStyleSheet(style);
+            }
+            if (tab->largeView) {
+                tab->largeView->setTextStyleSheet(style);
+            }
         }
-        fileList->setStyleSheet(style);
+        fileTree->setStyleSheet(style);
         menuBar()->setStyleSheet("QMenuBar { background: #FDF6E3; color: #657B83; } QMenu { background: #FDF6E3; color: #657B83; }");
     } else if (theme == "Solarized Dark") {
         palette.setColor(QPalette::Window, QColor("#073642"));
         palette.setColor(QPalette::WindowText, QColor("#839496"));
         QString style = "background-color: #073642; color: #839496;";
         for (auto tab: openTabs) {
-            tab->editor->setStyleSheet(style);
+            if (tab->editor) {
+                tab->editor->setStyleSheet(style);
+            }
+            if (tab->largeView) {
+                tab->largeView->setTextStyleSheet(style);
+            }
         }
-        fileList->setStyleSheet(style);
+        fileTree->setStyleSheet(style);
         menuBar()->setStyleSheet("QMenuBar { background: #073642; color: #839496; } QMenu { background: #073642; color: #839496; }");
     }
 
@@ -823,9 +1387,40 @@ QString MainWindow::readFile(const QString &filePath) {
     return QString();
 }
 
+bool MainWindow::writeTabToFile(FileTab *tab) {
+    if (!tab->editor) {
+        return true;// 尚未实例化的标签没有修改
+    }
+    if (tab->mergePending) {
+        return false;// 等合并完成后再保存
+    }
+    QString markdown = tab->editor->toPlainText();
+    if (!tab->diskText.isNull() && markdown == tab->diskText) {
+        return true;// 没有修改，不覆盖磁盘上的文件
+    }
+    // 通知可能还没到：磁盘上的文件已经变了就先合并，不用旧内容覆盖
+    if (fileMonitor->changedOnDisk(tab->filePath)) {
+        fileMonitor->check(tab->filePath);
+        return false;
+    }
+    QFile file(tab->filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    out << markdown;
+    file.close();
+    tab->diskText = markdown;
+    fileMonitor->markWritten(tab->filePath);
+
+    // 保存后增量更新链接图
+    linkGraph->updateDocument(tab->filePath, *documentSnapshot(tab, markdown));
+    versionStore->snapshot(tab->filePath, markdown);
+    return true;
+}
+
 void MainWindow::loadLastOpenedFile() {
-    QSettings settings("MyApp", "MarkdownEditor");
-    QString lastFile = settings.value("lastOpenedFile", "").toString();
+    QString lastFile = settings.getLastOpenedFile();
     if (!lastFile.isEmpty()) {
         QFileInfo fileInfo(lastFile);
         if (fileInfo.exists()) {
@@ -835,9 +1430,61 @@ void MainWindow::loadLastOpenedFile() {
     }
 }
 
-void MainWindow::saveLastOpenedFile(const QString &filePath) {
-    QSettings settings("MyApp", "MarkdownEditor");
-    settings.setValue("lastOpenedFile", filePath);
+void MainWindow::restoreSession() {
+    Session session;
+    if (!session.loadSession() || session.tabs.isEmpty()) {
+        loadLastOpenedFile();// 没有会话文件时沿用旧版本记录的最近文件
+        return;
+    }
+
+    // 添加标签时不触发 currentChanged，否则第一个标签会被提前实例化
+    QSignalBlocker blocker(fileTabs);
+    int activeIndex = -1;
+    for (int i = 0; i < session.tabs.size(); ++i) {
+        const SessionTab &saved = session.tabs[i];
+        if (!QFileInfo::exists(saved.filePath)) {
+            continue;
+        }
+        // 只创建占位标签，切换到该标签时才读取文件
+        FileTab *tab = addTab(saved.filePath);
+        tab->cursorPosition = saved.cursorPosition;
+        tab->editorScroll = saved.editorScroll;
+        tab->scrollY = saved.scrollY;
+        if (i <= session.activeIndex) {
+            activeIndex = openTabs.size() - 1;
+        }
+    }
+    blocker.unblock();
+    if (openTabs.isEmpty()) {
+        return;
+    }
+
+    FileTab *active = openTabs[qMax(activeIndex, 0)];
+    QDir::setCurrent(QFileInfo(active->filePath).dir().absolutePath());
+    loadFileList();
+    fileTabs->setCurrentWidget(active->page);
+    onTabChanged(fileTabs->currentIndex());
+}
+
+void MainWindow::saveSession() {
+    Session session;
+    session.activeIndex = fileTabs->currentIndex();
+    for (auto tab: openTabs) {
+        if (tab->editor) {
+            tab->cursorPosition = tab->editor->textCursor().position();
+            tab->editorScroll = tab->editor->verticalScrollBar()->value();
+        }
+        // 冻结或丢弃的页面报告的滚动位置是 0，保留隐藏前记下的值
+        if (tab->preview) {
+            if (tab->preview->page()->lifecycleState() == QWebEnginePage::LifecycleState::Active) {
+                tab->scrollY = int(tab->preview->page()->scrollPosition().y());
+            }
+        } else if (tab->nativePreview) {
+            tab->scrollY = tab->nativePreview->verticalScrollBar()->value();
+        }
+        session.tabs.append(SessionTab{tab->filePath, tab->cursorPosition, tab->editorScroll, tab->scrollY});
+    }
+    session.saveSession();
 }
 
 void MainWindow::loadSettings() {
@@ -853,35 +1500,393 @@ void MainWindow::closeEvent(QCloseEvent *event) {
     for (int i = 0; i < openTabs.size(); ++i) {
         FileTab *tab = openTabs[i];
         if (!tab->filePath.isEmpty()) {
-            QFile file(tab->filePath);
-            if (file.open(QFile::WriteOnly | QFile::Text)) {
-                QTextStream out(&file);
-                out << tab->editor->toPlainText();
-                file.close();
-            }
+            writeTabToFile(tab);
         }
     }
     settings.theme = currentTheme;
-    if (!openTabs.isEmpty()) {
-        settings.saveLastOpenedFile(openTabs.first()->filePath);
-    }
     settings.saveSettings();
+    saveSession();
     QMainWindow::closeEvent(event);
 }
 
 void MainWindow::onTabChanged(int index) {
+    // 懒加载：标签第一次被激活时才创建编辑器和预览
+    if (index >= 0 && index < openTabs.size()) {
+        materializeTab(openTabs.at(index));
+    }
+    refreshBacklinks();
+    outlineModel->clear();
+    refreshOutline();
     if (index < 0 || index >= openTabs.size()) {
-        fileList->clearSelection();
+        fileTree->clearSelection();
         return;
     }
     FileTab *currentTab = openTabs.at(index);
-    QString fileName = QFileInfo(currentTab->filePath).fileName();
+    currentTab->lastActive = QDateTime::currentMSecsSinceEpoch();
+
+    // 记下各预览的滚动位置（页面可能随后被丢弃），再切换活动预览
+    for (auto tab: openTabs) {
+        if (tab->preview && tab->preview->page()->lifecycleState() == QWebEnginePage::LifecycleState::Active) {
+            tab->scrollY = int(tab->preview->page()->scrollPosition().y());
+        }
+    }
+    previewLifecycle->setCurrent(currentTab->preview);
+
+    // 在文件树中按路径找到对应的项并选中，scrollTo 会展开它的上级目录
+    QModelIndex treeIndex = fileTreeModel->indexForPath(currentTab->filePath);
+    if (treeIndex.isValid()) {
+        fileTree->setCurrentIndex(treeIndex);
+        fileTree->scrollTo(treeIndex);
+    } else {
+        fileTree->clearSelection();
+    }
+}
+
+void MainWindow::onBacklinksChanged(const QString &target) {
+    int currentIndex = fileTabs->currentIndex();
+    if (currentIndex != -1 && currentIndex < openTabs.size() &&
+        LinkGraph::normalizePath(openTabs[currentIndex]->filePath) == target) {
+        refreshBacklinks();
+    }
+}
+
+void MainWindow::refreshBacklinks() {
+    backlinksList->clear();
+    int currentIndex = fileTabs->currentIndex();
+    if (currentIndex == -1 || currentIndex >= openTabs.size()) {
+        return;
+    }
+    for (const QString &source: linkGraph->backlinks(openTabs[currentIndex]->filePath)) {
+        QListWidgetItem *item = new QListWidgetItem(QFileInfo(source).fileName(), backlinksList);
+        item->setToolTip(source);
+        item->setData(Qt::UserRole, source);
+    }
+}
+
+void MainWindow::refreshOutline() {
+    int currentIndex = fileTabs->currentIndex();
+    if (currentIndex == -1 || currentIndex >= openTabs.size()) {
+        outlineModel->clear();
+        return;
+    }
+
+    if (!openTabs[currentIndex]->editor) {
+        outlineModel->clear();// 大文件视图没有完整的文本
+        return;
+    }
+    // 大纲和字数读取同一修订的快照，预览随后取用时不再解析
+    using Analysis = QPair<QVector<OutlineHeading>, int>;
+    FileTab *tab = openTabs[currentIndex];
+    QFuture<DocumentSnapshotPtr> parsed = snapshots.request(tab->filePath, tab->revision, [tab]() {
+        return tab->editor->toPlainText().toUtf8();
+    });
+    const quint64 revision = ++outlineRevision;
+
+    auto *watcher = new QFutureWatcher<Analysis>(this);
+    connect(watcher, &QFutureWatcher<Analysis>::finished, this, [this, watcher, revision]() {
+        // 解析期间又发生了编辑或切换标签时丢弃过期结果
+        if (revision == outlineRevision) {
+            const Analysis result = watcher->result();
+            outlineModel->setHeadings(result.first);
+            wordCountLabel->setText(QString("字数: %1").arg(result.second));
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([parsed]() {
+        DocumentSnapshotPtr snapshot = parsed.result();
+        return Analysis(OutlineModel::extractHeadings(*snapshot), snapshot->wordCount());
+    }));
+}
+
+void MainWindow::jumpToHeading(const QModelIndex &index) {
+    int currentIndex = fileTabs->currentIndex();
+    if (!index.isValid() || currentIndex == -1 || currentIndex >= openTabs.size()) {
+        return;
+    }
+    FileTab *tab = openTabs[currentIndex];
+    if (!tab->editor) {
+        return;
+    }
+    int line = index.data(OutlineModel::LineRole).toInt();
+
+    // 编辑器：光标移到标题所在行，并把该行滚动到顶部
+    QTextBlock block = tab->editor->document()->findBlockByNumber(line - 1);
+    if (block.isValid()) {
+        QTextCursor cursor(block);
+        tab->editor->setTextCursor(cursor);
+        QScrollBar *bar = tab->editor->verticalScrollBar();
+        bar->setValue(bar->value() + tab->editor->cursorRect(cursor).top());
+        tab->editor->setFocus();
+    }
+
+    // 预览：AST 中的标题带 data-heading 标记，顺序与大纲一致，手写的 HTML 标题不计入
+    if (tab->nativePreview) {
+        tab->nativePreview->scrollToHeading(index.row());
+        return;
+    }
+    if (!tab->preview) {
+        return;
+    }
+    tab->preview->page()->runJavaScript(
+            QString("var h = document.querySelectorAll('[data-heading]')[%1]; if (h) { h.scrollIntoView(); }")
+                    .arg(index.row()));
+}
+
+void MainWindow::onPreviewLinkActivated(const QUrl &url) {
+    // 指向本地 Markdown 的链接在编辑器中打开，其余交给系统处理
+    if (url.isLocalFile() && QFileInfo(url.toLocalFile()).suffix() == "md") {
+        QFileInfo fileInfo(url.toLocalFile());
+        QDir::setCurrent(fileInfo.dir().absolutePath());
+        loadFile(fileInfo.absoluteFilePath());
+    } else {
+        QDesktopServices::openUrl(url);
+    }
+}
+
+void MainWindow::updateLatencyHud() {
+    TracePercentiles latency = Tracer::percentiles("keystroke to preview");
+    TracePercentiles parse = Tracer::percentiles("parse");
+    latencyHudLabel->setText(QString("按键→预览 p50 %1 ms  p95 %2 ms  p99 %3 ms (n=%4) | 解析 p95 %5 ms")
+                                     .arg(latency.p50Ms, 0, 'f', 1)
+                                     .arg(latency.p95Ms, 0, 'f', 1)
+                                     .arg(latency.p99Ms, 0, 'f', 1)
+                                     .arg(latency.count)
+                                     .arg(parse.p95Ms, 0, 'f', 2));
+}
+
+void MainWindow::exportTrace() {
+    QString fileName = QFileDialog::getSaveFileName(this, "导出追踪", "bunny_trace.json", "Chrome Trace (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QFile file(fileName);
+    if (file.open(QFile::WriteOnly)) {
+        file.write(Tracer::exportChromeTrace());
+        file.close();
+    } else {
+        QMessageBox::warning(this, "导出追踪", "无法写入文件。");
+    }
+}
+
+void MainWindow::showPreviewMemory() {
+    // 每个预览的生命周期状态和估算内存，预算可以在这里调整
+    auto *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("预览内存");
+    dialog->resize(640, 360);
+    auto *table = new QTableWidget(0, 4, dialog);
+    table->setHorizontalHeaderLabels({"文件", "状态", "估算内存", "隐藏时长"});
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    auto *totalLabel = new QLabel(dialog);
+    auto *budgetBox = new QSpinBox(dialog);
+    budgetBox->setRange(64, 65536);
+    budgetBox->setSuffix(" MB");
+    budgetBox->setValue(settings.previewMemoryMB);
+
+    QHBoxLayout *budgetRow = new QHBoxLayout();
+    budgetRow->addWidget(new QLabel("内存预算：", dialog));
+    budgetRow->addWidget(budgetBox);
+    budgetRow->addStretch();
+    budgetRow->addWidget(totalLabel);
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(table);
+    layout->addLayout(budgetRow);
+
+    auto refresh = [this, table, totalLabel]() {
+        const QList<PreviewStatus> statuses = previewLifecycle->statuses();
+        table->setRowCount(int(statuses.size()));
+        for (int row = 0; row < statuses.size(); ++row) {
+            const PreviewStatus &status = statuses[row];
+            QString name;
+            for (auto tab: openTabs) {
+                if (tab->preview == status.view) {
+                    name = QFileInfo(tab->filePath).fileName();
+                }
+            }
+            QString state = status.state == QWebEnginePage::LifecycleState::Active   ? "活动"
+                            : status.state == QWebEnginePage::LifecycleState::Frozen ? "冻结"
+                                                                                       : "已丢弃";
+            table->setItem(row, 0, new QTableWidgetItem(name));
+            table->setItem(row, 1, new QTableWidgetItem(state));
+            table->setItem(row, 2, new QTableWidgetItem(QString::number(status.estimatedBytes / (1024.0 * 1024.0), 'f', 1) + " MB"));
+            table->setItem(row, 3, new QTableWidgetItem(status.hiddenMs ? QString("%1 s").arg(status.hiddenMs / 1000) : "可见"));
+        }
+        totalLabel->setText(QString("合计 %1 MB（含共享 JS 堆 %2 MB）/ 预算 %3 MB")
+                                    .arg(previewLifecycle->totalEstimate() / (1024.0 * 1024.0), 0, 'f', 1)
+                                    .arg(previewLifecycle->sharedHeap() / (1024.0 * 1024.0), 0, 'f', 1)
+                                    .arg(previewLifecycle->budget() / (1024 * 1024)));
+    };
+    connect(previewLifecycle, &PreviewLifecycle::statusChanged, dialog, refresh);
+    connect(budgetBox, &QSpinBox::valueChanged, dialog, [this](int megabytes) {
+        settings.previewMemoryMB = megabytes;
+        previewLifecycle->setBudget(qint64(megabytes) * 1024 * 1024);
+        saveSettings();
+    });
+    refresh();
+    dialog->show();
+}
+
+void MainWindow::showVersionHistory() {
+    int currentIndex = fileTabs->currentIndex();
+    if (currentIndex == -1 || currentIndex >= openTabs.size()) {
+        QMessageBox::warning(this, "历史版本", "没有打开的文件。");
+        return;
+    }
+    FileTab *currentTab = openTabs[currentIndex];
+    if (!currentTab->editor) {
+        QMessageBox::warning(this, "历史版本", "大文件以只读方式打开，不能恢复历史版本。");
+        return;
+    }
+    const QString filePath = currentTab->filePath;
+    const QList<VersionInfo> history = versionStore->versions(filePath);
+    if (history.isEmpty()) {
+        QMessageBox::information(this, "历史版本", "这个文件还没有保存过的版本。");
+        return;
+    }
 
-    // 在 fileList 中找到对应的项并选中
-    QList<QListWidgetItem *> items = fileList->findItems(fileName, Qt::MatchExactly);
-    if (!items.isEmpty()) {
-        QListWidgetItem *item = items.first();
-        fileList->setCurrentItem(item);
-        fileList->scrollToItem(item);// 确保选中的项可见
+    auto *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("历史版本 - " + QFileInfo(filePath).fileName());
+    dialog->resize(420, 480);
+    auto *list = new QListWidget(dialog);
+    // 最新的版本在最上面
+    for (int i = int(history.size()) - 1; i >= 0; --i) {
+        const VersionInfo &version = history[i];
+        auto *item = new QListWidgetItem(QString("%1    %2 KB")
+                                                 .arg(version.time.toString("yyyy-MM-dd HH:mm:ss"))
+                                                 .arg(version.size / 1024.0, 0, 'f', 1),
+                                         list);
+        item->setData(Qt::UserRole, version.index);
     }
+    list->setCurrentRow(0);
+    auto *restoreButton = new QPushButton("恢复到此版本", dialog);
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(list);
+    layout->addWidget(restoreButton);
+
+    connect(restoreButton, &QPushButton::clicked, dialog, [this, dialog, list, restoreButton, filePath]() {
+        QListWidgetItem *item = list->currentItem();
+        if (!item) {
+            return;
+        }
+        const int index = item->data(Qt::UserRole).toInt();
+        restoreButton->setEnabled(false);
+        // 读块、解压和校验在后台完成
+        auto *watcher = new QFutureWatcher<QPair<bool, QByteArray>>(this);
+        connect(watcher, &QFutureWatcher<QPair<bool, QByteArray>>::finished, this, [this, watcher, filePath, guard = QPointer<QDialog>(dialog)]() {
+            const QPair<bool, QByteArray> result = watcher->result();
+            watcher->deleteLater();
+            FileTab *target = nullptr;
+            for (auto tab: openTabs) {
+                if (tab->filePath == filePath && tab->editor) {
+                    target = tab;
+                }
+            }
+            if (!result.first) {
+                QMessageBox::warning(this, "历史版本", "这个版本的数据缺失或已损坏，无法恢复。");
+            } else if (target) {
+                // 保存时会生成新的版本
+                replaceEditorText(target, QString::fromUtf8(result.second));
+            }
+            if (guard) {
+                guard->close();
+            }
+        });
+        watcher->setFuture(QtConcurrent::run([this, filePath, index]() {
+            QPair<bool, QByteArray> result;
+            result.first = versionStore->restore(filePath, index, result.second);
+            return result;
+        }));
+    });
+    dialog->show();
+}
+
+void MainWindow::replaceEditorText(FileTab *tab, const QString &text) {
+    // 整体替换为一次编辑，可以撤销；尽量保持光标和滚动位置
+    const int position = tab->editor->textCursor().position();
+    const int scroll = tab->editor->verticalScrollBar()->value();
+    QTextCursor cursor(tab->editor->document());
+    cursor.select(QTextCursor::Document);
+    cursor.insertText(text);
+    cursor.setPosition(qMin(position, tab->editor->document()->characterCount() - 1));
+    tab->editor->setTextCursor(cursor);
+    tab->editor->verticalScrollBar()->setValue(scroll);
+}
+
+void MainWindow::onExternalChange(const QString &filePath, const QByteArray &content) {
+    FileTab *tab = nullptr;
+    for (auto candidate: openTabs) {
+        if (candidate->filePath == filePath && candidate->editor) {
+            tab = candidate;
+        }
+    }
+    if (!tab) {
+        return;
+    }
+    const QString theirs = QString::fromUtf8(content).replace("\r\n", "\n");
+    if (theirs == tab->diskText) {
+        return;// 内容与最近一次读写的相同
+    }
+    const QString name = QFileInfo(filePath).fileName();
+    const QString mine = tab->editor->toPlainText();
+    if (mine == tab->diskText || mine == theirs) {
+        // 编辑器里没有未保存的修改，直接重新加载
+        tab->diskText = theirs;
+        replaceEditorText(tab, theirs);
+        statusBar()->showMessage(QString("%1 已被其他程序修改，已重新加载").arg(name), 5000);
+        return;
+    }
+
+    // 两边都有修改：在后台以上次读写的内容为共同祖先做三方合并
+    tab->mergePending = true;
+    const quint64 serial = ++tab->mergeSerial;
+    const QString base = tab->diskText;
+    const int revision = tab->editor->document()->revision();
+    auto *watcher = new QFutureWatcher<MergeResult>(this);
+    connect(watcher, &QFutureWatcher<MergeResult>::finished, this,
+            [this, watcher, filePath, content, theirs, name, serial, revision, editor = QPointer<MarkdownEditor>(tab->editor)]() {
+                const MergeResult result = watcher->result();
+                watcher->deleteLater();
+                FileTab *tab = nullptr;
+                for (auto candidate: openTabs) {
+                    if (candidate->editor == editor && candidate->filePath == filePath) {
+                        tab = candidate;
+                    }
+                }
+                if (!editor || !tab || tab->mergeSerial != serial) {
+                    return;// 合并期间标签已关闭，或文件又变了、已有更新的合并
+                }
+                tab->mergePending = false;
+                if (editor->document()->revision() != revision) {
+                    onExternalChange(filePath, content);// 合并期间又有输入，用最新的文本重来
+                    return;
+                }
+                tab->diskText = theirs;
+                if (result.conflicts == 0) {
+                    replaceEditorText(tab, result.text);
+                    statusBar()->showMessage(QString("%1 已被其他程序修改，已与未保存的修改合并").arg(name), 5000);
+                    return;
+                }
+
+                tab->mergePending = true;
+                QMessageBox box(QMessageBox::Warning, "外部修改冲突",
+                                QString("%1 已被其他程序修改，其中 %2 处与未保存的修改冲突。").arg(name).arg(result.conflicts),
+                                QMessageBox::NoButton, this);
+                QPushButton *markersButton = box.addButton("插入冲突标记", QMessageBox::AcceptRole);
+                QPushButton *diskButton = box.addButton("使用磁盘上的版本", QMessageBox::DestructiveRole);
+                box.addButton("保留我的版本", QMessageBox::RejectRole);
+                box.exec();
+                if (!editor || tab->mergeSerial != serial) {
+                    return;
+                }
+                tab->mergePending = false;
+                if (box.clickedButton() == markersButton) {
+                    replaceEditorText(tab, result.text);
+                } else if (box.clickedButton() == diskButton) {
+                    replaceEditorText(tab, theirs);
+                }
+                // 保留我的版本：下次保存时覆盖磁盘上的文件
+            });
+    watcher->setFuture(QtConcurrent::run([base, mine, theirs]() { return ThreeWayMerge::merge(base, mine, theirs); }));
 }
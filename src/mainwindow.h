@@ -2,9 +2,32 @@
 #define QMARKDOWNEDITOR_MAINWINDOW_H
 
 #include "HtmlConverter.hpp"
+#include "PageTemplate.hpp"
+#include "Tracer.hpp"
+#include "batchexporter.h"
+#include "imagepipeline.h"
+#include "largefileview.h"
+#include "diagramrenderer.h"
+#include "documentsnapshot.h"
+#include "filemonitor.h"
+#include "filetree.h"
+#include "linkgraph.h"
+#include "markdowneditor.h"
+#include "mathrenderer.h"
+#include "nativepreview.h"
+#include "outline.h"
+#include "previewlifecycle.h"
+#include "previewpagepool.h"
+#include "session.h"
 #include "settings.h"
+#include "spellchecker.h"
+#include "tabarchive.h"
+#include "versionstore.h"
 #include <QApplication>
+#include <QDockWidget>
+#include <QFuture>
 #include <QLabel>
+#include <QListView>
 #include <QListWidget>
 #include <QMainWindow>
 #include <QMap>
@@ -14,14 +37,29 @@
 #include <QTabWidget>
 #include <QTextEdit>
 #include <QTimer>
+#include <QTreeView>
 #include <QVBoxLayout>
 #include <QWebEngineView>
 
 struct FileTab {
     QString filePath;
-    QTextEdit *editor;
-    QWebEngineView *preview;
+    QWidget *page;          // 标签页容器
+    MarkdownEditor *editor; // 懒加载：标签首次激活前为空
+    LargeFileView *largeView;// 超大文件的只读视图，此时 editor 始终为空
+    QWebEngineView *preview;// WebEngine 初始化完成前为空
+    NativePreview *nativePreview;// 轻量预览模式下代替 preview，两者最多一个非空
+    QSplitter *splitter;    // 编辑区与预览区所在的分割器
     int scrollY;// 添加此字段用于存储滚动位置
+    int cursorPosition;// 会话恢复用的光标位置
+    int editorScroll;  // 会话恢复用的编辑器滚动位置
+    QString previewScript;// 最近一次注入预览的脚本，页面被丢弃后用它立即恢复
+    QString diskText;     // 最近一次读入或写入磁盘的内容，外部修改时作为三方合并的共同祖先
+    bool mergePending;    // 正在合并外部修改，期间不写入文件
+    quint64 mergeSerial;  // 合并期间文件再次变化时，只采用最新一次合并的结果
+    quint64 revision;     // 编辑器内容每次变化加一，用来共享同一修订的解析快照
+    EditJournal *journal; // 编辑器的修改记录，折叠时连同文本一起存档，随编辑器释放
+    QByteArray archive;   // 折叠后的压缩存档，此时 editor 为空，再次激活时从这里恢复
+    qint64 lastActive;    // 最近一次处于当前标签或被编辑的时间（毫秒）
 };
 
 class MainWindow : public QMainWindow {
@@ -31,8 +69,14 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+public slots:
+    void finishStartup();// 主窗口显示后分阶段加载文件和预览
+
+signals:
+    void previewRendered(FileTab *tab);// 预览内容注入完成
+
 private slots:
-    void openFile(QListWidgetItem *item);
+    void openFile(const QModelIndex &index);
     void onThemeChanged(const QString &theme);
     void onTextChanged();
     void createNewFile();
@@ -42,7 +86,20 @@ private slots:
     void insertImage();
     void openFileDialog();
     void openFolderDialog();
+    void batchExport();
+    void setLargeFileThreshold();
+    void setCollapseIdleTime();
+    void chooseSpellLanguage();
     void onTabChanged(int index);// 新增的槽函数
+    void onBacklinksChanged(const QString &target);
+    void refreshOutline();
+    void jumpToHeading(const QModelIndex &index);
+    void onPreviewLinkActivated(const QUrl &url);
+    void updateLatencyHud();
+    void exportTrace();
+    void showPreviewMemory();
+    void showVersionHistory();
+    void onExternalChange(const QString &filePath, const QByteArray &content);
 
 protected:
     void closeEvent(QCloseEvent *event) override;
@@ -51,22 +108,44 @@ private:
     void setupUi();
     void loadFileList();
     void loadFile(const QString &filePath);
+    void openFilePath(const QString &filePath);
     void loadFilesInDirectory(const QString &folderPath);
     void loadLastOpenedFile();
-    void saveLastOpenedFile(const QString &filePath);
+    void restoreSession();
+    void saveSession();
+    FileTab *addTab(const QString &filePath);
+    void materializeTab(FileTab *tab);
+    void materializeLargeTab(FileTab *tab);
+    QString previewSource(FileTab *tab) const;
+    void importImageFiles(FileTab *tab, const QStringList &imagePaths);
+    void pasteImage(FileTab *tab, const QImage &image);
     void loadSettings();
     void saveSettings();
     void updatePalette(const QString &theme) noexcept;
-    inline void loadMarkdown(const QString &markdown, FileTab *tab) noexcept;
+    inline void loadMarkdown(const QString &markdown, FileTab *tab, qint64 keystrokeNs = -1) noexcept;
     void applyThemeToAllTabs();
     inline void refreshPreviews()noexcept;
     QString readFile(const QString &filePath);
+    bool writeTabToFile(FileTab *tab);
     void autoSaveFile();
+    void refreshBacklinks();
+    void initPreviews();
+    void attachPreview(FileTab *tab);
+    void detachPreview(FileTab *tab);
+    void rebuildPreviews();// 切换预览方式后为所有标签重新创建预览
+    bool useNativePreview() const { return settings.nativePreview || webEngineFailed; }
+    PageStyle previewStyle(FileTab *tab) const;
+    DocumentSnapshotPtr documentSnapshot(FileTab *tab, const QString &markdown);// markdown 须为 tab 当前的内容
+    void renderNativePreview(const QString &markdown, FileTab *tab, qint64 keystrokeNs);
+    void replaceEditorText(FileTab *tab, const QString &text);
+    void collapseIdleTabs();
+    void collapseTab(FileTab *tab);// 释放编辑器和预览，只留压缩存档
 
 
 private:
     QSplitter *verticalSplitter;
-    QListWidget *fileList;
+    QTreeView *fileTree;
+    FileTreeModel *fileTreeModel;
     QTabWidget *fileTabs;
     Settings settings;
     QString currentTheme;
@@ -75,7 +154,31 @@ private:
 
     QList<FileTab *> openTabs;
     QTimer *autoSaveTimer;
+    QTimer *collapseTimer;// 定期折叠长时间不活动的标签
     QTimer *debounceTimer;// 新增：防抖定时器
+    LinkGraph *linkGraph;
+    ImagePipeline *imagePipeline;
+    MathRenderer mathRenderer;// 公式转换结果缓存
+    SnapshotService snapshots;// 各文档最新修订的 AST，预览、大纲、字数和链接共用
+    DiagramRenderer *diagramRenderer;
+    QListWidget *backlinksList;// 反向链接面板
+    OutlineModel *outlineModel;
+    QListView *outlineView;// 大纲面板
+    QTimer *outlineTimer;
+    quint64 outlineRevision = 0;
+    bool previewsReady = false;// WebEngine 是否已初始化
+    PreviewPagePool *pagePool = nullptr;
+    bool webEngineFailed = false;// 渲染进程异常退出后本次运行改用轻量预览
+    qint64 pendingKeystrokeNs = -1;// 尚未反映到预览的第一次按键时间
+    QLabel *latencyHudLabel;       // 状态栏延迟 HUD
+    QTimer *latencyHudTimer;
+    PreviewLifecycle *previewLifecycle;// 隐藏预览的冻结与丢弃
+    VersionStore *versionStore;        // 保存时的本地版本历史
+    FileMonitor *fileMonitor;          // 已打开文件的外部修改检测
+    SpellChecker *spellChecker;        // 所有编辑器共用的拼写词典
+    QAction *spellCheckAction;
+    QAction *nativePreviewAction;
+    QFuture<ExportStats> exportFuture;// 正在进行的批量导出，窗口销毁前取消并等待
 };
 
 #endif// QMARKDOWNEDITOR_MAINWINDOW_H
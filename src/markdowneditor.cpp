@@ -0,0 +1,60 @@
+#include "markdowneditor.h"
+#include "markdownhighlighter.h"
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMimeData>
+#include <QUrl>
+
+MarkdownEditor::MarkdownEditor(QWidget *parent) : QTextEdit(parent) {}
+
+void MarkdownEditor::setHighlightTheme(bool dark) {
+    if (highlighter) {
+        highlighter->setDark(dark);
+    } else {
+        highlighter = new MarkdownHighlighter(document(), dark, spellChecker);
+    }
+}
+
+void MarkdownEditor::setSpellChecker(SpellChecker *checker) {
+    spellChecker = checker;
+    if (highlighter) {
+        highlighter->setSpellChecker(checker);
+    }
+}
+
+QStringList MarkdownEditor::localImageFiles(const QMimeData *source) {
+    QStringList paths;
+    if (!source->hasUrls()) {
+        return paths;
+    }
+    const QList<QByteArray> formats = QImageReader::supportedImageFormats();
+    for (const QUrl &url: source->urls()) {
+        QFileInfo info(url.toLocalFile());
+        if (!url.isLocalFile() || !info.isFile() || !formats.contains(info.suffix().toLower().toUtf8())) {
+            return QStringList();// 混有非图片时按普通粘贴处理
+        }
+        paths.append(info.absoluteFilePath());
+    }
+    return paths;
+}
+
+bool MarkdownEditor::canInsertFromMimeData(const QMimeData *source) const {
+    return source->hasImage() || !localImageFiles(source).isEmpty() || QTextEdit::canInsertFromMimeData(source);
+}
+
+void MarkdownEditor::insertFromMimeData(const QMimeData *source) {
+    // 文件优先：复制文件时部分平台也会附带缩略图位图
+    QStringList paths = localImageFiles(source);
+    if (!paths.isEmpty()) {
+        emit imageFilesPasted(paths);
+        return;
+    }
+    if (source->hasImage() && !source->hasText()) {
+        QImage image = qvariant_cast<QImage>(source->imageData());
+        if (!image.isNull()) {
+            emit imagePasted(image);
+            return;
+        }
+    }
+    QTextEdit::insertFromMimeData(source);
+}
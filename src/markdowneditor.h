@@ -0,0 +1,38 @@
+#ifndef QMARKDOWNEDITOR_MARKDOWNEDITOR_H
+#define QMARKDOWNEDITOR_MARKDOWNEDITOR_H
+
+#include <QImage>
+#include <QStringList>
+#include <QTextEdit>
+
+class MarkdownHighlighter;
+class SpellChecker;
+
+// Markdown 编辑器：粘贴图片时不插入富文本，而是交给主窗口保存为文件
+class MarkdownEditor : public QTextEdit {
+    Q_OBJECT
+
+public:
+    explicit MarkdownEditor(QWidget *parent = nullptr);
+
+    // 开启语法高亮或切换配色；在载入文本之后调用，首次高亮推迟到下一轮事件循环
+    void setHighlightTheme(bool dark);
+    // 拼写检查随高亮一起开启，可以在高亮创建之前设置
+    void setSpellChecker(SpellChecker *checker);
+
+signals:
+    void imagePasted(const QImage &image);           // 剪贴板中的位图（截图等）
+    void imageFilesPasted(const QStringList &paths);// 从文件管理器复制或拖入的图片文件
+
+protected:
+    bool canInsertFromMimeData(const QMimeData *source) const override;
+    void insertFromMimeData(const QMimeData *source) override;
+
+private:
+    static QStringList localImageFiles(const QMimeData *source);
+
+    MarkdownHighlighter *highlighter = nullptr;
+    SpellChecker *spellChecker = nullptr;
+};
+
+#endif// QMARKDOWNEDITOR_MARKDOWNEDITOR_H
@@ -0,0 +1,591 @@
+#include "markdownhighlighter.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextBlock>
+#include <QtConcurrent/QtConcurrent>
+
+namespace {
+    // 不做拼写检查的格式（代码、HTML、链接）
+    const int NoSpellProperty = QTextFormat::UserProperty + 1;
+
+    // 块上次检查的内容；结果返回时据此确认块没有变化
+    class SpellBlockData : public QTextBlockUserData {
+    public:
+        size_t key = 0;
+        bool shown = false;// 已经按缓存的结果画出
+    };
+
+    bool isBlank(const QString &text, int from) {
+        for (int i = from; i < text.size(); ++i) {
+            if (text[i] != ' ' && text[i] != '\t') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 连续相同字符的个数
+    int runLength(const QString &text, int at, QChar c) {
+        int length = 0;
+        while (at + length < text.size() && text[at + length] == c) {
+            ++length;
+        }
+        return length;
+    }
+
+    // 分隔线：三个以上相同的 * - _，中间可以有空格
+    bool isThematicBreak(const QString &text, int at) {
+        QChar c = text[at];
+        if (c != '*' && c != '-' && c != '_') {
+            return false;
+        }
+        int count = 0;
+        for (int i = at; i < text.size(); ++i) {
+            if (text[i] == c) {
+                ++count;
+            } else if (text[i] != ' ' && text[i] != '\t') {
+                return false;
+            }
+        }
+        return count >= 3;
+    }
+
+    // 列表标记之后的内容起点，不是列表项时返回 -1
+    int listContent(const QString &text, int at) {
+        int end = at;
+        QChar c = text[at];
+        if (c == '-' || c == '+' || c == '*') {
+            end = at + 1;
+        } else {
+            while (end < text.size() && end - at < 9 && text[end].isDigit()) {
+                ++end;
+            }
+            if (end == at || end >= text.size() || (text[end] != '.' && text[end] != ')')) {
+                return -1;
+            }
+            ++end;
+        }
+        if (end == text.size()) {
+            return end;
+        }
+        if (text[end] != ' ' && text[end] != '\t') {
+            return -1;
+        }
+        // 标记后 1–4 个空格，更多时内容从第一个空格后开始（其余属于缩进代码）
+        int spaces = runLength(text, end, ' ');
+        return end + (spaces >= 1 && spaces <= 4 ? spaces : 1);
+    }
+
+    bool startsWithTag(const QString &text, int at, const char *const *tags, int count) {
+        for (int i = 0; i < count; ++i) {
+            const QLatin1String tag(tags[i]);
+            if (QStringView(text).mid(at).startsWith(tag, Qt::CaseInsensitive)) {
+                int end = at + tag.size();
+                if (end == text.size() || text[end] == '>' || text[end] == ' ' || text[end] == '\t' ||
+                    (text[end] == '/' && tag.at(1) != '/')) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+MarkdownHighlighter::MarkdownHighlighter(QTextDocument *document, bool dark, SpellChecker *checker)
+    : QSyntaxHighlighter(document), dark(dark), spellResults(200000),
+      spellWatcher(new QFutureWatcher<QList<SpellJob>>(this)), spellTimer(new QTimer(this)) {
+    buildFormats();
+    spellTimer->setSingleShot(true);
+    spellTimer->setInterval(0);
+    connect(spellTimer, &QTimer::timeout, this, &MarkdownHighlighter::processSpelling);
+    connect(spellWatcher, &QFutureWatcher<QList<SpellJob>>::finished, this, [this]() {
+        if (dispatchedGeneration == spellGeneration) {
+            for (const SpellJob &job: spellWatcher->result()) {
+                spellPending.remove(job.key);
+                spellResults.insert(job.key, new QVector<QPair<int, int>>(job.words));
+                spellReady.append(job);
+            }
+        }
+        processSpelling();
+    });
+    // 首次高亮由 QSyntaxHighlighter 推迟执行，这里只记下词典
+    if (checker) {
+        spellChecker = checker;
+        dictionary = checker->dictionary();
+        connect(checker, &SpellChecker::dictionaryChanged, this, &MarkdownHighlighter::onDictionaryChanged);
+    }
+}
+
+void MarkdownHighlighter::setDark(bool value) {
+    if (dark == value) {
+        return;
+    }
+    dark = value;
+    buildFormats();
+    rehighlight();
+}
+
+void MarkdownHighlighter::buildFormats() {
+    const QStringList monospace{"Consolas", "Menlo", "monospace"};
+
+    headingFormat = QTextCharFormat();
+    headingFormat.setFontWeight(QFont::Bold);
+    headingFormat.setForeground(QColor(dark ? "#78aeed" : "#1a5fb4"));
+
+    emphasisFormat = QTextCharFormat();
+    emphasisFormat.setFontItalic(true);
+
+    strongFormat = QTextCharFormat();
+    strongFormat.setFontWeight(QFont::Bold);
+
+    codeFormat = QTextCharFormat();
+    codeFormat.setFontFamilies(monospace);
+    codeFormat.setForeground(QColor(dark ? "#ff7b72" : "#c01c28"));
+    codeFormat.setBackground(QColor(dark ? "#2d2d2d" : "#f0f0f0"));
+
+    codeBlockFormat = QTextCharFormat();
+    codeBlockFormat.setFontFamilies(monospace);
+    codeBlockFormat.setForeground(QColor(dark ? "#c0c0c0" : "#4d4d4d"));
+    codeBlockFormat.setBackground(QColor(dark ? "#262626" : "#f5f5f5"));
+
+    linkFormat = QTextCharFormat();
+    linkFormat.setForeground(QColor(dark ? "#78aeed" : "#1c71d8"));
+    linkFormat.setFontUnderline(true);
+
+    quoteFormat = QTextCharFormat();
+    quoteFormat.setForeground(QColor(dark ? "#9aa5b1" : "#6a737d"));
+    quoteFormat.setFontItalic(true);
+
+    markerFormat = QTextCharFormat();
+    markerFormat.setForeground(QColor(dark ? "#ffa348" : "#e66100"));
+    markerFormat.setFontWeight(QFont::Bold);
+
+    htmlFormat = QTextCharFormat();
+    htmlFormat.setForeground(QColor(dark ? "#9a9a9a" : "#8a8a8a"));
+
+    ruleFormat = QTextCharFormat();
+    ruleFormat.setForeground(QColor(dark ? "#808080" : "#999999"));
+
+    spellFormat = QTextCharFormat();
+    spellFormat.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+    spellFormat.setUnderlineColor(QColor(dark ? "#ff6b6b" : "#e01b24"));
+
+    for (QTextCharFormat *skipped: {&codeFormat, &codeBlockFormat, &linkFormat, &htmlFormat}) {
+        skipped->setProperty(NoSpellProperty, true);
+    }
+}
+
+int MarkdownHighlighter::packState(int mode, int extra, int listIndent, bool paragraph) {
+    return mode | (qMin(extra, 255) << 2) | (qMin(listIndent, 63) << 10) | (paragraph ? 1 << 16 : 0);
+}
+
+void MarkdownHighlighter::highlightBlock(const QString &text) {
+    highlightMarkdown(text);
+    if (dictionary) {
+        checkSpelling(text);
+    }
+}
+
+void MarkdownHighlighter::highlightMarkdown(const QString &text) {
+    const int previous = qMax(previousBlockState(), 0);
+    const int mode = previous & 3;
+    const int extra = (previous >> 2) & 0xFF;
+    int listIndent = (previous >> 10) & 0x3F;
+    const bool paragraph = previous & (1 << 16);
+
+    // 行首缩进：列数与第一个非空白字符的位置
+    int indent = 0;
+    int at = 0;
+    while (at < text.size() && (text[at] == ' ' || text[at] == '\t')) {
+        indent = text[at] == '\t' ? indent + 4 - indent % 4 : indent + 1;
+        ++at;
+    }
+
+    if (mode == BacktickFence || mode == TildeFence) {
+        setFormat(0, text.size(), codeBlockFormat);
+        QChar fence = mode == BacktickFence ? '`' : '~';
+        int run = at < text.size() ? runLength(text, at, fence) : 0;
+        bool closes = indent - listIndent <= 3 && run >= extra && isBlank(text, at + run);
+        setCurrentBlockState(closes ? packState(Normal, 0, listIndent, false) : previous);
+        return;
+    }
+
+    if (mode == HtmlBlock) {
+        setFormat(0, text.size(), htmlFormat);
+        bool closes;
+        switch (extra) {
+            case CommentEnd:
+                closes = text.contains("-->");
+                break;
+            case ProcessingEnd:
+                closes = text.contains("?>");
+                break;
+            case CdataEnd:
+                closes = text.contains("]]>");
+                break;
+            case DeclarationEnd:
+                closes = text.contains('>');
+                break;
+            case RawTagEnd:
+                closes = text.contains("</script>", Qt::CaseInsensitive) || text.contains("</pre>", Qt::CaseInsensitive) ||
+                         text.contains("</style>", Qt::CaseInsensitive) || text.contains("</textarea>", Qt::CaseInsensitive);
+                break;
+            default:
+                // 以空行结束的 HTML 块，空行本身不属于块
+                if (isBlank(text, 0)) {
+                    setFormat(0, text.size(), QTextCharFormat());
+                    setCurrentBlockState(packState(Normal, 0, listIndent, false));
+                    return;
+                }
+                closes = false;
+        }
+        setCurrentBlockState(closes ? packState(Normal, 0, listIndent, false) : previous);
+        return;
+    }
+
+    // 空行保留列表上下文，列表项之间可以有空行
+    if (at == text.size()) {
+        setCurrentBlockState(packState(Normal, 0, listIndent, false));
+        return;
+    }
+
+    // 缩进不足的非列表行结束列表（段落的惰性延续行除外）
+    if (indent < listIndent && !paragraph) {
+        listIndent = 0;
+    }
+    const int base = listIndent > 0 && indent >= listIndent ? listIndent : 0;
+    const int relative = indent - base;
+
+    // 缩进代码块不能打断段落
+    if (relative >= 4 && !paragraph) {
+        setFormat(0, text.size(), codeBlockFormat);
+        setCurrentBlockState(packState(Normal, 0, listIndent, false));
+        return;
+    }
+
+    const QChar first = text[at];
+
+    // 围栏代码块
+    if ((first == '`' || first == '~') && relative <= 3) {
+        int run = runLength(text, at, first);
+        if (run >= 3 && !(first == '`' && text.indexOf('`', at + run) != -1)) {
+            setFormat(0, text.size(), codeBlockFormat);
+            setFormat(at, run, markerFormat);
+            setCurrentBlockState(packState(first == '`' ? BacktickFence : TildeFence, run, listIndent, false));
+            return;
+        }
+    }
+
+    // HTML 块
+    if (first == '<' && relative <= 3 && startHtmlBlock(text, at, paragraph, listIndent)) {
+        return;
+    }
+
+    // ATX 标题
+    if (first == '#' && relative <= 3) {
+        int level = runLength(text, at, '#');
+        if (level <= 6 && (at + level == text.size() || text[at + level] == ' ' || text[at + level] == '\t')) {
+            setFormat(0, text.size(), headingFormat);
+            setFormat(at, level, markerFormat);
+            highlightInline(text, at + level);
+            setCurrentBlockState(packState(Normal, 0, listIndent, false));
+            return;
+        }
+    }
+
+    // setext 标题的下划线
+    if (paragraph && relative <= 3 && (first == '=' || first == '-')) {
+        int run = runLength(text, at, first);
+        if (isBlank(text, at + run)) {
+            setFormat(at, run, markerFormat);
+            setCurrentBlockState(packState(Normal, 0, listIndent, false));
+            return;
+        }
+    }
+
+    // 分隔线（优先于以 * 或 - 开头的列表项）
+    if (relative <= 3 && isThematicBreak(text, at)) {
+        setFormat(0, text.size(), ruleFormat);
+        setCurrentBlockState(packState(Normal, 0, listIndent, false));
+        return;
+    }
+
+    // 引用块
+    if (first == '>' && relative <= 3) {
+        int content = at;
+        while (content < text.size() && (text[content] == '>' || text[content] == ' ')) {
+            ++content;
+        }
+        setFormat(at, content - at, markerFormat);
+        setFormat(content, text.size() - content, quoteFormat);
+        highlightInline(text, content);
+        setCurrentBlockState(packState(Normal, 0, listIndent, content < text.size()));
+        return;
+    }
+
+    // 列表项：记录内容的缩进，之后缩进到这里的行属于该项
+    if (relative <= 3) {
+        int content = listContent(text, at);
+        if (content != -1) {
+            setFormat(at, content - at, markerFormat);
+            highlightInline(text, content);
+            int contentIndent = indent + (content - at);
+            setCurrentBlockState(packState(Normal, 0, contentIndent, !isBlank(text, content)));
+            return;
+        }
+    }
+
+    // 普通段落
+    highlightInline(text, at);
+    setCurrentBlockState(packState(Normal, 0, listIndent, true));
+}
+
+bool MarkdownHighlighter::startHtmlBlock(const QString &text, int at, bool paragraph, int listIndent) {
+    static const char *const rawTags[] = {"<script", "<pre", "<style", "<textarea"};
+    QStringView line = QStringView(text).mid(at);
+    int end;
+    bool closed;
+    if (startsWithTag(text, at, rawTags, 4)) {
+        end = RawTagEnd;
+        closed = line.contains(u"</script>", Qt::CaseInsensitive) || line.contains(u"</pre>", Qt::CaseInsensitive) ||
+                 line.contains(u"</style>", Qt::CaseInsensitive) || line.contains(u"</textarea>", Qt::CaseInsensitive);
+    } else if (line.startsWith(u"<!--")) {
+        end = CommentEnd;
+        closed = line.mid(4).contains(u"-->");
+    } else if (line.startsWith(u"<?")) {
+        end = ProcessingEnd;
+        closed = line.mid(2).contains(u"?>");
+    } else if (line.startsWith(u"<![CDATA[")) {
+        end = CdataEnd;
+        closed = line.mid(9).contains(u"]]>");
+    } else if (line.size() > 2 && line[1] == '!' && line[2].isLetter()) {
+        end = DeclarationEnd;
+        closed = line.contains('>');
+    } else if (!paragraph && line.size() > 1 && (line[1].isLetter() || (line[1] == '/' && line.size() > 2 && line[2].isLetter()))) {
+        // 其他标签开头的块到空行结束（这类块不能打断段落）
+        end = BlankLineEnd;
+        closed = false;
+    } else {
+        return false;
+    }
+    setFormat(0, text.size(), htmlFormat);
+    setCurrentBlockState(closed ? packState(Normal, 0, listIndent, false) : packState(HtmlBlock, end, listIndent, false));
+    return true;
+}
+
+void MarkdownHighlighter::highlightInline(const QString &text, int from) {
+    const int size = text.size();
+    for (int i = from; i < size; ++i) {
+        const QChar c = text[i];
+        if (c == '\\') {
+            ++i;// 转义字符
+            continue;
+        }
+
+        // 行内代码：找到长度相同的反引号串
+        if (c == '`') {
+            int run = runLength(text, i, '`');
+            int close = i + run;
+            while ((close = text.indexOf('`', close)) != -1) {
+                int closeRun = runLength(text, close, '`');
+                if (closeRun == run) {
+                    break;
+                }
+                close += closeRun;
+            }
+            if (close == -1) {
+                i += run - 1;
+                continue;
+            }
+            setFormat(i, close + run - i, codeFormat);
+            i = close + run - 1;
+            continue;
+        }
+
+        // 强调：* 可以在词中，_ 只能在词边界
+        if (c == '*' || c == '_') {
+            int run = runLength(text, i, c);
+            bool opener = i + run < size && !text[i + run].isSpace() &&
+                          (c == '*' || i == 0 || !text[i - 1].isLetterOrNumber());
+            if (!opener || run > 3) {
+                i += run - 1;
+                continue;
+            }
+            const QString delimiter(run, c);
+            int close = i + run;
+            while ((close = text.indexOf(delimiter, close)) != -1) {
+                bool closer = !text[close - 1].isSpace() && runLength(text, close, c) == run &&
+                              (c == '*' || close + run == size || !text[close + run].isLetterOrNumber());
+                if (closer) {
+                    break;
+                }
+                close += runLength(text, close, c);
+            }
+            if (close == -1) {
+                i += run - 1;
+                continue;
+            }
+            QTextCharFormat format = run == 1 ? emphasisFormat : strongFormat;
+            if (run == 3) {
+                format.setFontItalic(true);
+            }
+            setFormat(i, run, markerFormat);
+            for (int k = i + run; k < close; ++k) {
+                QTextCharFormat merged = this->format(k);
+                merged.merge(format);
+                setFormat(k, 1, merged);
+            }
+            setFormat(close, run, markerFormat);
+            // 继续扫描强调内部的其他标记
+            i += run - 1;
+            continue;
+        }
+
+        // 链接和图片：[文本](地址) 或 [文本][引用]
+        if (c == '[') {
+            int label = text.indexOf(']', i + 1);
+            if (label != -1 && label + 1 < size && (text[label + 1] == '(' || text[label + 1] == '[')) {
+                QChar closer = text[label + 1] == '(' ? ')' : ']';
+                int end = text.indexOf(closer, label + 2);
+                if (end != -1) {
+                    int start = i > from && text[i - 1] == '!' ? i - 1 : i;
+                    setFormat(start, end + 1 - start, linkFormat);
+                    i = end;
+                }
+            }
+            continue;
+        }
+
+        // 自动链接与行内 HTML
+        if (c == '<') {
+            int end = text.indexOf('>', i + 1);
+            if (end == -1) {
+                continue;
+            }
+            QStringView inside = QStringView(text).mid(i + 1, end - i - 1);
+            if (inside.startsWith(u"http://") || inside.startsWith(u"https://") || inside.startsWith(u"mailto:")) {
+                setFormat(i, end + 1 - i, linkFormat);
+                i = end;
+            } else if (!inside.isEmpty() && (inside[0].isLetter() || inside[0] == '/' || inside[0] == '!')) {
+                setFormat(i, end + 1 - i, htmlFormat);
+                i = end;
+            }
+        }
+    }
+}
+
+void MarkdownHighlighter::setSpellChecker(SpellChecker *checker) {
+    if (spellChecker == checker) {
+        return;
+    }
+    if (spellChecker) {
+        disconnect(spellChecker, nullptr, this, nullptr);
+    }
+    spellChecker = checker;
+    if (checker) {
+        connect(checker, &SpellChecker::dictionaryChanged, this, &MarkdownHighlighter::onDictionaryChanged);
+    }
+    onDictionaryChanged();
+}
+
+void MarkdownHighlighter::onDictionaryChanged() {
+    QSharedPointer<const SpellDictionary> next = spellChecker ? spellChecker->dictionary() : nullptr;
+    if (next == dictionary) {
+        return;
+    }
+    dictionary = next;
+    ++spellGeneration;
+    spellResults.clear();
+    spellPending.clear();
+    spellQueue.clear();
+    spellReady.clear();
+    sweepBlock = -1;
+    rehighlight();
+}
+
+void MarkdownHighlighter::checkSpelling(const QString &text) {
+    // 只检查正文：代码、HTML 和链接的格式带有 NoSpellProperty
+    QVector<QPair<int, int>> words;
+    int start = 0, length = 0;
+    while (SpellChecker::nextWord(text, start + length, start, length)) {
+        if (!format(start).boolProperty(NoSpellProperty)) {
+            words.append({start, length});
+        }
+    }
+    auto *data = static_cast<SpellBlockData *>(currentBlockUserData());
+    if (words.isEmpty()) {
+        if (data) {
+            data->key = 0;
+            data->shown = true;
+        }
+        return;
+    }
+    const size_t key = qHashMulti(0, text, words);
+    if (!data) {
+        data = new SpellBlockData;
+        setCurrentBlockUserData(data);
+    }
+    data->key = key;
+
+    // 内容相同的块（包括状态变化引起的重新高亮）直接使用缓存的结果
+    if (const QVector<QPair<int, int>> *wrong = spellResults.object(key)) {
+        data->shown = true;
+        for (auto word: *wrong) {
+            for (int k = word.first; k < word.first + word.second; ++k) {
+                QTextCharFormat merged = format(k);
+                merged.merge(spellFormat);
+                setFormat(k, 1, merged);
+            }
+        }
+        return;
+    }
+    data->shown = false;
+    if (!spellPending.contains(key)) {
+        spellPending.insert(key);
+        spellQueue.append(SpellJob{currentBlock().blockNumber(), key, text, words});
+        spellTimer->start();
+    }
+}
+
+void MarkdownHighlighter::processSpelling() {
+    // 同一时间只有一个后台任务，期间排队的块等它结束后一起送出
+    if (!spellQueue.isEmpty() && !spellWatcher->isRunning()) {
+        dispatchedGeneration = spellGeneration;
+        spellWatcher->setFuture(QtConcurrent::run([dictionary = dictionary, jobs = std::exchange(spellQueue, {})]() mutable {
+            for (SpellJob &job: jobs) {
+                job.words = SpellChecker::misspelled(*dictionary, job.text, job.words);
+                job.text.clear();
+            }
+            return jobs;
+        }));
+    }
+
+    // 分片重新高亮有结果的块，大文档首次检查时也不阻塞输入
+    QElapsedTimer clock;
+    clock.start();
+    while (!spellReady.isEmpty() && clock.elapsed() < SpellSliceMs) {
+        const SpellJob job = spellReady.takeFirst();
+        QTextBlock block = document()->findBlockByNumber(job.block);
+        auto *data = static_cast<SpellBlockData *>(block.userData());
+        if (data && data->key == job.key) {
+            if (!data->shown && spellResults.contains(job.key)) {
+                rehighlightBlock(block);
+            }
+        } else if (sweepBlock < 0) {
+            sweepBlock = 0;// 结果返回前有编辑，块号已经变化
+        }
+    }
+    if (spellReady.isEmpty() && sweepBlock >= 0) {
+        QTextBlock block = document()->findBlockByNumber(sweepBlock);
+        for (; block.isValid() && clock.elapsed() < SpellSliceMs; block = block.next()) {
+            auto *data = static_cast<SpellBlockData *>(block.userData());
+            if (data && !data->shown && spellResults.contains(data->key)) {
+                rehighlightBlock(block);
+            }
+        }
+        sweepBlock = block.isValid() ? block.blockNumber() : -1;
+    }
+    if (!spellReady.isEmpty() || sweepBlock >= 0) {
+        spellTimer->start();
+    }
+}
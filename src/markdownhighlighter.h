@@ -0,0 +1,85 @@
+#ifndef QMARKDOWNEDITOR_MARKDOWNHIGHLIGHTER_H
+#define QMARKDOWNEDITOR_MARKDOWNHIGHLIGHTER_H
+
+#include "spellchecker.h"
+#include <QCache>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QSet>
+#include <QSyntaxHighlighter>
+#include <QTextCharFormat>
+#include <QTimer>
+
+// 编辑器中的 Markdown 语法高亮。
+// 跨行结构（围栏代码块、HTML 块、列表缩进、段落延续）记录在每个文本块的状态中，
+// 编辑时 QSyntaxHighlighter 只重新高亮被修改的块，以及之后状态确实发生变化的块。
+// 拼写检查跟随同样的增量：被重新高亮、且内容没有缓存结果的块才送到后台查词典，
+// 结果返回后分片重新高亮这些块，画出波浪线
+class MarkdownHighlighter : public QSyntaxHighlighter {
+    Q_OBJECT
+
+public:
+    explicit MarkdownHighlighter(QTextDocument *document, bool dark = false, SpellChecker *checker = nullptr);
+
+    // 深色主题使用另一套颜色
+    void setDark(bool dark);
+
+    // 开启拼写检查，checker 为空时关闭。代码、HTML 和链接不检查
+    void setSpellChecker(SpellChecker *checker);
+
+    static constexpr int SpellSliceMs = 8;// 每轮事件循环应用拼写结果的时间上限
+
+protected:
+    void highlightBlock(const QString &text) override;
+
+private:
+    // 块状态：低 2 位为所在的多行结构，其后 8 位为围栏长度或 HTML 块的结束方式，
+    // 再 6 位为列表项内容的缩进，最高一位表示段落尚未结束（决定缩进代码和 setext 标题）
+    enum Mode { Normal = 0, BacktickFence = 1, TildeFence = 2, HtmlBlock = 3 };
+    enum HtmlEnd { CommentEnd, ProcessingEnd, CdataEnd, DeclarationEnd, RawTagEnd, BlankLineEnd };
+    static int packState(int mode, int extra, int listIndent, bool paragraph);
+
+    // 一个块的待检查内容；送回时 words 换成拼错的词
+    struct SpellJob {
+        int block;
+        size_t key;
+        QString text;
+        QVector<QPair<int, int>> words;
+    };
+
+    void highlightMarkdown(const QString &text);
+    void checkSpelling(const QString &text);
+    void onDictionaryChanged();
+    void processSpelling();
+
+    void buildFormats();
+    bool startHtmlBlock(const QString &text, int at, bool paragraph, int listIndent);
+    void highlightInline(const QString &text, int from);
+
+    bool dark;
+    QTextCharFormat headingFormat;
+    QTextCharFormat emphasisFormat;
+    QTextCharFormat strongFormat;
+    QTextCharFormat codeFormat;
+    QTextCharFormat codeBlockFormat;
+    QTextCharFormat linkFormat;
+    QTextCharFormat quoteFormat;
+    QTextCharFormat markerFormat;
+    QTextCharFormat htmlFormat;
+    QTextCharFormat ruleFormat;
+    QTextCharFormat spellFormat;
+
+    QPointer<SpellChecker> spellChecker;
+    QSharedPointer<const SpellDictionary> dictionary;
+    QCache<size_t, QVector<QPair<int, int>>> spellResults;// 块文本与词位置的哈希 -> 拼错的词
+    QSet<size_t> spellPending;                            // 已送出、结果未到
+    QList<SpellJob> spellQueue;                           // 等待送到后台的块
+    QList<SpellJob> spellReady;                           // 结果已到、等待重新高亮的块
+    QFutureWatcher<QList<SpellJob>> *spellWatcher;
+    QTimer *spellTimer;
+    int spellGeneration = 0;  // 词典变化后丢弃还在路上的结果
+    int dispatchedGeneration = 0;
+    int sweepBlock = -1;      // 块号在检查期间变化时，从这里扫描找回结果；-1 表示不需要
+};
+
+#endif// QMARKDOWNEDITOR_MARKDOWNHIGHLIGHTER_H
@@ -0,0 +1,885 @@
+#include "mathrenderer.h"
+#include <QByteArrayView>
+#include <QHash>
+#include <QSet>
+#include <QStringView>
+
+namespace {
+    // 占位符使用私用区字符，cmark 会把它们当作普通文本原样输出
+    const QChar TokenStart(0xE000);
+    const QChar TokenEnd(0xE001);
+
+    struct MathAtom {
+        QString xml;
+        bool movableLimits = false;// \sum、\lim 等：块级公式中上下标放在正上/正下方
+        bool limits = false;       // \underbrace 等：上下标总是放在正上/正下方
+    };
+
+    QString escapeXml(QStringView text) {
+        QString result;
+        result.reserve(text.size());
+        for (QChar c: text) {
+            if (c == '<') {
+                result += "&lt;";
+            } else if (c == '>') {
+                result += "&gt;";
+            } else if (c == '&') {
+                result += "&amp;";
+            } else if (c == '"') {
+                result += "&quot;";
+            } else {
+                result += c;
+            }
+        }
+        return result;
+    }
+
+    QString element(const char *tag, const QString &content) {
+        return QString("<%1>%2</%1>").arg(QLatin1String(tag), content);
+    }
+
+    QString mo(const QString &text) {
+        return element("mo", escapeXml(text));
+    }
+
+    const QHash<QString, QString> &greekLetters() {
+        static const QHash<QString, QString> letters = {
+                {"alpha", "α"}, {"beta", "β"}, {"gamma", "γ"}, {"delta", "δ"}, {"epsilon", "ϵ"}, {"varepsilon", "ε"},
+                {"zeta", "ζ"}, {"eta", "η"}, {"theta", "θ"}, {"vartheta", "ϑ"}, {"iota", "ι"}, {"kappa", "κ"},
+                {"lambda", "λ"}, {"mu", "μ"}, {"nu", "ν"}, {"xi", "ξ"}, {"omicron", "ο"}, {"pi", "π"},
+                {"varpi", "ϖ"}, {"rho", "ρ"}, {"varrho", "ϱ"}, {"sigma", "σ"}, {"varsigma", "ς"}, {"tau", "τ"},
+                {"upsilon", "υ"}, {"phi", "ϕ"}, {"varphi", "φ"}, {"chi", "χ"}, {"psi", "ψ"}, {"omega", "ω"},
+                {"infty", "∞"}, {"partial", "∂"}, {"nabla", "∇"}, {"emptyset", "∅"}, {"varnothing", "∅"},
+                {"hbar", "ℏ"}, {"ell", "ℓ"}, {"Re", "ℜ"}, {"Im", "ℑ"}, {"aleph", "ℵ"}, {"imath", "ı"}, {"jmath", "ȷ"},
+                {"top", "⊤"}, {"bot", "⊥"}, {"angle", "∠"}, {"triangle", "△"}, {"prime", "′"}};
+        return letters;
+    }
+
+    const QHash<QString, QString> &uprightLetters() {
+        static const QHash<QString, QString> letters = {
+                {"Gamma", "Γ"}, {"Delta", "Δ"}, {"Theta", "Θ"}, {"Lambda", "Λ"}, {"Xi", "Ξ"}, {"Pi", "Π"},
+                {"Sigma", "Σ"}, {"Upsilon", "Υ"}, {"Phi", "Φ"}, {"Psi", "Ψ"}, {"Omega", "Ω"}};
+        return letters;
+    }
+
+    const QHash<QString, QString> &operators() {
+        static const QHash<QString, QString> symbols = {
+                {"cdot", "⋅"}, {"times", "×"}, {"div", "÷"}, {"pm", "±"}, {"mp", "∓"}, {"ast", "∗"}, {"star", "⋆"},
+                {"circ", "∘"}, {"bullet", "∙"}, {"le", "≤"}, {"leq", "≤"}, {"ge", "≥"}, {"geq", "≥"}, {"ne", "≠"},
+                {"neq", "≠"}, {"approx", "≈"}, {"equiv", "≡"}, {"sim", "∼"}, {"simeq", "≃"}, {"cong", "≅"},
+                {"propto", "∝"}, {"ll", "≪"}, {"gg", "≫"}, {"in", "∈"}, {"notin", "∉"}, {"ni", "∋"}, {"subset", "⊂"},
+                {"subseteq", "⊆"}, {"supset", "⊃"}, {"supseteq", "⊇"}, {"cup", "∪"}, {"cap", "∩"}, {"setminus", "∖"},
+                {"wedge", "∧"}, {"land", "∧"}, {"vee", "∨"}, {"lor", "∨"}, {"neg", "¬"}, {"lnot", "¬"}, {"forall", "∀"},
+                {"exists", "∃"}, {"nexists", "∄"}, {"to", "→"}, {"rightarrow", "→"}, {"leftarrow", "←"}, {"gets", "←"},
+                {"leftrightarrow", "↔"}, {"Rightarrow", "⇒"}, {"Leftarrow", "⇐"}, {"Leftrightarrow", "⇔"}, {"iff", "⟺"},
+                {"implies", "⟹"}, {"mapsto", "↦"}, {"uparrow", "↑"}, {"downarrow", "↓"}, {"longrightarrow", "⟶"},
+                {"longleftarrow", "⟵"}, {"parallel", "∥"}, {"perp", "⊥"}, {"mid", "∣"}, {"oplus", "⊕"}, {"otimes", "⊗"},
+                {"odot", "⊙"}, {"ldots", "…"}, {"dots", "…"}, {"cdots", "⋯"}, {"vdots", "⋮"}, {"ddots", "⋱"},
+                {"colon", ":"}, {"langle", "⟨"}, {"rangle", "⟩"}, {"lfloor", "⌊"}, {"rfloor", "⌋"}, {"lceil", "⌈"},
+                {"rceil", "⌉"}, {"vert", "|"}, {"Vert", "‖"}, {"lvert", "|"}, {"rvert", "|"}, {"lVert", "‖"},
+                {"rVert", "‖"}, {"backslash", "\\"}, {"lbrace", "{"}, {"rbrace", "}"}};
+        return symbols;
+    }
+
+    const QHash<QString, QString> &largeOperators() {
+        static const QHash<QString, QString> symbols = {
+                {"sum", "∑"}, {"prod", "∏"}, {"coprod", "∐"}, {"bigcup", "⋃"}, {"bigcap", "⋂"}, {"bigvee", "⋁"},
+                {"bigwedge", "⋀"}, {"bigoplus", "⨁"}, {"bigotimes", "⨂"}, {"bigodot", "⨀"}};
+        return symbols;
+    }
+
+    // 积分号的上下限在 TeX 中默认放在右侧
+    const QHash<QString, QString> &integrals() {
+        static const QHash<QString, QString> symbols = {
+                {"int", "∫"}, {"iint", "∬"}, {"iiint", "∭"}, {"oint", "∮"}};
+        return symbols;
+    }
+
+    const QSet<QString> &functionNames() {
+        static const QSet<QString> names = {
+                "sin", "cos", "tan", "cot", "sec", "csc", "arcsin", "arccos", "arctan", "sinh", "cosh", "tanh",
+                "coth", "log", "ln", "lg", "exp", "deg", "dim", "ker", "hom", "arg"};
+        return names;
+    }
+
+    const QSet<QString> &limitFunctionNames() {
+        static const QSet<QString> names = {"lim", "limsup", "liminf", "max", "min", "sup", "inf", "det", "Pr", "gcd"};
+        return names;
+    }
+
+    const QHash<QString, QString> &accents() {
+        static const QHash<QString, QString> marks = {
+                {"hat", "^"}, {"widehat", "^"}, {"bar", "¯"}, {"overline", "¯"}, {"vec", "→"},
+                {"overrightarrow", "→"}, {"overleftarrow", "←"}, {"dot", "˙"}, {"ddot", "¨"}, {"tilde", "˜"},
+                {"widetilde", "˜"}, {"check", "ˇ"}, {"breve", "˘"}, {"acute", "´"}, {"grave", "`"}};
+        return marks;
+    }
+
+    // LaTeX 数学模式的递归下降解析，直接输出 MathML
+    class TexParser {
+    public:
+        TexParser(const QString &tex, bool display) : tex(tex), display(display) {}
+
+        QString parse() {
+            QString row;
+            while (pos < tex.size()) {
+                row += parseRow();
+                if (pos < tex.size()) {
+                    row += stray();
+                }
+            }
+            return row;
+        }
+
+    private:
+        static constexpr int MaxDepth = 64;
+
+        QString parseRow() {
+            QString row;
+            while (true) {
+                skipSpaces();
+                if (pos >= tex.size() || atStop()) {
+                    break;
+                }
+                row += parseAtom();
+            }
+            return row;
+        }
+
+        // } & \\ \end \right 由外层处理
+        bool atStop() const {
+            QChar c = tex[pos];
+            if (c == '}' || c == '&') {
+                return true;
+            }
+            if (c == '\\' && pos + 1 < tex.size() && tex[pos + 1] == '\\') {
+                return true;
+            }
+            QString command = peekCommand();
+            return command == "end" || command == "right";
+        }
+
+        // 出现在不该出现的位置的结束符：原样显示，不丢内容也不死循环
+        QString stray() {
+            QChar c = tex[pos];
+            if (c == '}' || c == '&') {
+                ++pos;
+                return mo(QString(c));
+            }
+            if (c == '\\' && pos + 1 < tex.size() && tex[pos + 1] == '\\') {
+                pos += 2;
+                return QString();
+            }
+            QString command = readCommand();
+            if (command == "end") {
+                readRawGroup();
+                return QString();
+            }
+            return delimiter(readDelimiter(), "true");
+        }
+
+        QString peekCommand() const {
+            if (pos >= tex.size() || tex[pos] != '\\') {
+                return QString();
+            }
+            qsizetype end = pos + 1;
+            while (end < tex.size() && tex[end].isLetter()) {
+                ++end;
+            }
+            return tex.mid(pos + 1, end - pos - 1);
+        }
+
+        QString readCommand() {
+            QString command = peekCommand();
+            pos += 1 + command.size();
+            return command;
+        }
+
+        void skipSpaces() {
+            while (pos < tex.size() && tex[pos].isSpace()) {
+                ++pos;
+            }
+        }
+
+        // 读取 {...} 中的原文（\text 等）
+        QString readRawGroup() {
+            skipSpaces();
+            if (pos >= tex.size() || tex[pos] != '{') {
+                return pos < tex.size() ? QString(tex[pos++]) : QString();
+            }
+            int depth = 0;
+            qsizetype start = pos + 1;
+            for (; pos < tex.size(); ++pos) {
+                if (tex[pos] == '\\') {
+                    ++pos;
+                } else if (tex[pos] == '{') {
+                    ++depth;
+                } else if (tex[pos] == '}' && --depth == 0) {
+                    return tex.mid(start, pos++ - start);
+                }
+            }
+            return tex.mid(start);
+        }
+
+        QString parseAtom() {
+            MathAtom base = parsePrimary();
+            QString sub;
+            QString sup;
+            QString primes;
+            int primeCount = 0;
+            bool hasSub = false;
+            bool hasSup = false;
+            while (true) {
+                skipSpaces();
+                if (pos >= tex.size()) {
+                    break;
+                }
+                QChar c = tex[pos];
+                if (c == '^' && !hasSup) {
+                    ++pos;
+                    sup = parseArgument();
+                    hasSup = true;
+                } else if (c == '_' && !hasSub) {
+                    ++pos;
+                    sub = parseArgument();
+                    hasSub = true;
+                } else if (c == '\'') {
+                    ++pos;
+                    primes += "<mo>′</mo>";
+                    ++primeCount;
+                } else {
+                    break;
+                }
+            }
+            if (!primes.isEmpty()) {
+                sup = hasSup ? "<mrow>" + primes + sup + "</mrow>" : (primeCount == 1 ? primes : "<mrow>" + primes + "</mrow>");
+                hasSup = true;
+            }
+            if (!hasSub && !hasSup) {
+                return base.xml;
+            }
+
+            bool under = base.limits || (base.movableLimits && display);
+            if (hasSub && hasSup) {
+                return QString("<%1>%2%3%4</%1>").arg(under ? "munderover" : "msubsup", base.xml, sub, sup);
+            }
+            if (hasSub) {
+                return QString("<%1>%2%3</%1>").arg(under ? "munder" : "msub", base.xml, sub);
+            }
+            return QString("<%1>%2%3</%1>").arg(under ? "mover" : "msup", base.xml, sup);
+        }
+
+        // 命令参数或上下标：一个 {...} 分组、一个命令或一个字符
+        QString parseArgument() {
+            skipSpaces();
+            if (pos >= tex.size() || atStop()) {
+                return "<mrow></mrow>";
+            }
+            if (tex[pos] == '{' || tex[pos] == '\\') {
+                return parsePrimary().xml;
+            }
+            return token(tex[pos++]);
+        }
+
+        QString parseGroup() {
+            ++pos;// {
+            if (++depth > MaxDepth) {
+                pos = tex.size();
+                return "<merror><mtext>嵌套过深</mtext></merror>";
+            }
+            QString row = parseRow();
+            --depth;
+            if (pos < tex.size() && tex[pos] == '}') {
+                ++pos;
+            }
+            return "<mrow>" + row + "</mrow>";
+        }
+
+        MathAtom parsePrimary() {
+            QChar c = tex[pos];
+            if (c == '{') {
+                return MathAtom{parseGroup()};
+            }
+            if (c == '^' || c == '_') {
+                return MathAtom{"<mrow></mrow>"};// 没有底数的上下标
+            }
+            if (c == '\\') {
+                if (++depth > MaxDepth) {
+                    pos = tex.size();
+                    return MathAtom{"<merror><mtext>嵌套过深</mtext></merror>"};
+                }
+                MathAtom atom = parseCommand();
+                --depth;
+                return atom;
+            }
+            if (c.isDigit() || (c == '.' && pos + 1 < tex.size() && tex[pos + 1].isDigit())) {
+                qsizetype start = pos;
+                while (pos < tex.size() && (tex[pos].isDigit() || tex[pos] == '.')) {
+                    ++pos;
+                }
+                return MathAtom{element("mn", styled(QStringView(tex).mid(start, pos - start)))};
+            }
+            if (c.isHighSurrogate() && pos + 1 < tex.size()) {
+                pos += 2;
+                return MathAtom{element("mi", tex.mid(pos - 2, 2))};
+            }
+            ++pos;
+            return MathAtom{token(c)};
+        }
+
+        QString token(QChar c) {
+            if (c.isLetter()) {
+                if (variant == "normal") {
+                    return QString("<mi mathvariant=\"normal\">%1</mi>").arg(c);
+                }
+                return element("mi", styled(QStringView(&c, 1)));
+            }
+            if (c.isDigit()) {
+                return element("mn", styled(QStringView(&c, 1)));
+            }
+            if (c == '~') {
+                return "<mspace width=\"0.25em\"></mspace>";
+            }
+            if (c == '-') {
+                return "<mo>−</mo>";
+            }
+            if (c == '*') {
+                return "<mo>∗</mo>";
+            }
+            return mo(QString(c));
+        }
+
+        // \mathbf、\mathbb、\mathcal 映射到 Unicode 数学字母区，\mathrm 用 mathvariant="normal"
+        QString styled(QStringView text) const {
+            if (variant.isEmpty() || variant == "normal") {
+                return escapeXml(text);
+            }
+            QString result;
+            for (QChar c: text) {
+                char32_t code = c.unicode();
+                char32_t mapped = 0;
+                if (variant == "bold") {
+                    if (c >= 'A' && c <= 'Z') mapped = 0x1D400 + (code - 'A');
+                    else if (c >= 'a' && c <= 'z') mapped = 0x1D41A + (code - 'a');
+                    else if (c >= '0' && c <= '9') mapped = 0x1D7CE + (code - '0');
+                } else if (variant == "bb") {
+                    static const QHash<QChar, char32_t> holes = {{'C', 0x2102}, {'H', 0x210D}, {'N', 0x2115}, {'P', 0x2119},
+                                                                 {'Q', 0x211A}, {'R', 0x211D}, {'Z', 0x2124}};
+                    if (holes.contains(c)) mapped = holes.value(c);
+                    else if (c >= 'A' && c <= 'Z') mapped = 0x1D538 + (code - 'A');
+                    else if (c >= 'a' && c <= 'z') mapped = 0x1D552 + (code - 'a');
+                    else if (c >= '0' && c <= '9') mapped = 0x1D7D8 + (code - '0');
+                } else if (variant == "cal") {
+                    static const QHash<QChar, char32_t> holes = {{'B', 0x212C}, {'E', 0x2130}, {'F', 0x2131}, {'H', 0x210B},
+                                                                 {'I', 0x2110}, {'L', 0x2112}, {'M', 0x2133}, {'R', 0x211B}};
+                    if (holes.contains(c)) mapped = holes.value(c);
+                    else if (c >= 'A' && c <= 'Z') mapped = 0x1D49C + (code - 'A');
+                }
+                if (mapped) {
+                    result += QString::fromUcs4(&mapped, 1);
+                } else {
+                    result += escapeXml(QStringView(&c, 1));
+                }
+            }
+            return result;
+        }
+
+        QString withVariant(const QString &newVariant) {
+            QString saved = variant;
+            variant = newVariant;
+            QString argument = parseArgument();
+            variant = saved;
+            return argument;
+        }
+
+        QString readDelimiter() {
+            skipSpaces();
+            if (pos >= tex.size()) {
+                return QString();
+            }
+            if (tex[pos] == '\\') {
+                if (pos + 1 < tex.size() && !tex[pos + 1].isLetter()) {
+                    pos += 2;
+                    QChar c = tex[pos - 1];
+                    return c == '|' ? QString("‖") : QString(c);
+                }
+                QString command = readCommand();
+                return operators().value(command, QString());
+            }
+            QChar c = tex[pos++];
+            return c == '.' ? QString() : QString(c);
+        }
+
+        static QString delimiter(const QString &text, const char *stretchy) {
+            if (text.isEmpty()) {
+                return QString();
+            }
+            return QString("<mo fence=\"true\" stretchy=\"%1\">%2</mo>").arg(QLatin1String(stretchy), escapeXml(text));
+        }
+
+        MathAtom parseCommand() {
+            ++pos;// 反斜杠
+            if (pos >= tex.size()) {
+                return MathAtom{mo("\\")};
+            }
+            QChar c = tex[pos];
+            if (!c.isLetter()) {
+                ++pos;
+                switch (c.unicode()) {
+                    case ',':
+                        return MathAtom{"<mspace width=\"0.1667em\"></mspace>"};
+                    case ':':
+                    case '>':
+                        return MathAtom{"<mspace width=\"0.2222em\"></mspace>"};
+                    case ';':
+                        return MathAtom{"<mspace width=\"0.2778em\"></mspace>"};
+                    case ' ':
+                        return MathAtom{"<mspace width=\"0.25em\"></mspace>"};
+                    case '!':
+                        return MathAtom{QString()};
+                    case '|':
+                        return MathAtom{mo("‖")};
+                    default:
+                        return MathAtom{mo(QString(c))};
+                }
+            }
+
+            QString name;
+            while (pos < tex.size() && tex[pos].isLetter()) {
+                name += tex[pos++];
+            }
+
+            if (greekLetters().contains(name)) {
+                return MathAtom{element("mi", greekLetters().value(name))};
+            }
+            if (uprightLetters().contains(name)) {
+                return MathAtom{QString("<mi mathvariant=\"normal\">%1</mi>").arg(uprightLetters().value(name))};
+            }
+            if (operators().contains(name)) {
+                return MathAtom{mo(operators().value(name))};
+            }
+            if (largeOperators().contains(name)) {
+                return MathAtom{QString("<mo largeop=\"true\" movablelimits=\"true\">%1</mo>").arg(largeOperators().value(name)), true};
+            }
+            if (integrals().contains(name)) {
+                return MathAtom{QString("<mo largeop=\"true\">%1</mo>").arg(integrals().value(name))};
+            }
+            if (functionNames().contains(name)) {
+                return MathAtom{element("mi", name)};
+            }
+            if (limitFunctionNames().contains(name)) {
+                return MathAtom{element("mi", name), true};
+            }
+            if (accents().contains(name)) {
+                QString argument = parseArgument();
+                bool wide = name.startsWith("wide") || name.startsWith("over");
+                return MathAtom{QString("<mover accent=\"true\">%1<mo stretchy=\"%2\">%3</mo></mover>")
+                                        .arg(argument, wide ? "true" : "false", escapeXml(accents().value(name)))};
+            }
+
+            if (name == "frac" || name == "dfrac" || name == "tfrac" || name == "cfrac") {
+                QString numerator = parseArgument();
+                QString denominator = parseArgument();
+                return MathAtom{element("mfrac", numerator + denominator)};
+            }
+            if (name == "binom") {
+                QString top = parseArgument();
+                QString bottom = parseArgument();
+                return MathAtom{"<mrow><mo>(</mo><mfrac linethickness=\"0\">" + top + bottom + "</mfrac><mo>)</mo></mrow>"};
+            }
+            if (name == "sqrt") {
+                skipSpaces();
+                if (pos < tex.size() && tex[pos] == '[') {
+                    qsizetype close = tex.indexOf(']', pos);
+                    if (close != -1) {
+                        QString index = TexParser(tex.mid(pos + 1, close - pos - 1), false).parse();
+                        pos = close + 1;
+                        QString radicand = parseArgument();
+                        return MathAtom{element("mroot", radicand + "<mrow>" + index + "</mrow>")};
+                    }
+                }
+                return MathAtom{element("msqrt", parseArgument())};
+            }
+            if (name == "underline") {
+                return MathAtom{"<munder accentunder=\"true\">" + parseArgument() + "<mo stretchy=\"true\">_</mo></munder>"};
+            }
+            if (name == "overbrace" || name == "underbrace") {
+                bool over = name == "overbrace";
+                QString argument = parseArgument();
+                return MathAtom{QString("<%1>%2<mo stretchy=\"true\">%3</mo></%1>").arg(over ? "mover" : "munder", argument, over ? "⏞" : "⏟"),
+                                false, true};
+            }
+            if (name == "text" || name == "textrm" || name == "textit" || name == "textbf" || name == "mbox") {
+                return MathAtom{element("mtext", escapeXml(readRawGroup()))};
+            }
+            if (name == "operatorname") {
+                return MathAtom{element("mi", escapeXml(readRawGroup()))};
+            }
+            if (name == "mathrm" || name == "mathup") {
+                return MathAtom{withVariant("normal")};
+            }
+            if (name == "mathbf" || name == "boldsymbol" || name == "bm") {
+                return MathAtom{withVariant("bold")};
+            }
+            if (name == "mathbb") {
+                return MathAtom{withVariant("bb")};
+            }
+            if (name == "mathcal" || name == "mathscr") {
+                return MathAtom{withVariant("cal")};
+            }
+            if (name == "mathit" || name == "mathsf" || name == "mathtt") {
+                return MathAtom{withVariant(QString())};
+            }
+            if (name == "left") {
+                QString open = delimiter(readDelimiter(), "true");
+                QString body = parseRow();
+                QString close;
+                if (peekCommand() == "right") {
+                    readCommand();
+                    close = delimiter(readDelimiter(), "true");
+                }
+                return MathAtom{"<mrow>" + open + body + close + "</mrow>"};
+            }
+            if (name == "middle") {
+                return MathAtom{delimiter(readDelimiter(), "true")};
+            }
+            static const QHash<QString, QString> bigSizes = {
+                    {"big", "1.2em"}, {"bigl", "1.2em"}, {"bigr", "1.2em"}, {"Big", "1.8em"}, {"Bigl", "1.8em"}, {"Bigr", "1.8em"},
+                    {"bigg", "2.4em"}, {"biggl", "2.4em"}, {"biggr", "2.4em"}, {"Bigg", "3em"}, {"Biggl", "3em"}, {"Biggr", "3em"}};
+            if (bigSizes.contains(name)) {
+                QString size = bigSizes.value(name);
+                return MathAtom{QString("<mo minsize=\"%1\" maxsize=\"%1\">%2</mo>").arg(size, escapeXml(readDelimiter()))};
+            }
+            if (name == "quad") {
+                return MathAtom{"<mspace width=\"1em\"></mspace>"};
+            }
+            if (name == "qquad") {
+                return MathAtom{"<mspace width=\"2em\"></mspace>"};
+            }
+            if (name == "not") {
+                skipSpaces();
+                if (pos < tex.size() && tex[pos] == '=') {
+                    ++pos;
+                    return MathAtom{mo("≠")};
+                }
+                if (peekCommand() == "in") {
+                    readCommand();
+                    return MathAtom{mo("∉")};
+                }
+                return MathAtom{QString()};
+            }
+            if (name == "begin") {
+                return MathAtom{parseEnvironment(readRawGroup())};
+            }
+            if (name == "label" || name == "tag") {
+                readRawGroup();
+                return MathAtom{QString()};
+            }
+            if (name == "displaystyle" || name == "textstyle" || name == "limits" || name == "nolimits" ||
+                name == "nonumber" || name == "notag" || name == "mathstrut") {
+                return MathAtom{QString()};
+            }
+            return MathAtom{"<merror><mtext>\\" + escapeXml(name) + "</mtext></merror>"};
+        }
+
+        QString parseEnvironment(const QString &name) {
+            if (name == "array") {
+                readRawGroup();// 列格式
+            }
+
+            QList<QStringList> rows;
+            QStringList cells;
+            while (pos < tex.size()) {
+                cells.append(parseRow());
+                if (pos >= tex.size()) {
+                    break;
+                }
+                QChar c = tex[pos];
+                if (c == '&') {
+                    ++pos;
+                    continue;
+                }
+                if (c == '\\' && pos + 1 < tex.size() && tex[pos + 1] == '\\') {
+                    pos += 2;
+                    rows.append(cells);
+                    cells.clear();
+                    continue;
+                }
+                if (peekCommand() == "end") {
+                    readCommand();
+                    readRawGroup();
+                    break;
+                }
+                cells.last() += stray();
+            }
+            // 最后一行后面的 \\ 不产生空行
+            if (!(cells.size() == 1 && cells.first().isEmpty() && !rows.isEmpty())) {
+                rows.append(cells);
+            }
+
+            QString table;
+            for (const QStringList &row: rows) {
+                table += "<mtr>";
+                for (const QString &cell: row) {
+                    table += "<mtd>" + cell + "</mtd>";
+                }
+                table += "</mtr>";
+            }
+
+            QString open;
+            QString close;
+            QString align;
+            if (name == "pmatrix") {
+                open = "(";
+                close = ")";
+            } else if (name == "bmatrix") {
+                open = "[";
+                close = "]";
+            } else if (name == "Bmatrix") {
+                open = "{";
+                close = "}";
+            } else if (name == "vmatrix") {
+                open = "|";
+                close = "|";
+            } else if (name == "Vmatrix") {
+                open = "‖";
+                close = "‖";
+            } else if (name == "cases") {
+                open = "{";
+                align = " columnalign=\"left left\"";
+            } else if (name.startsWith("align") || name == "split") {
+                align = " columnalign=\"right left right left right left\"";
+            }
+            return "<mrow>" + delimiter(open, "true") + "<mtable" + align + ">" + table + "</mtable>" +
+                   delimiter(close, "true") + "</mrow>";
+        }
+
+        const QString &tex;
+        bool display;
+        qsizetype pos = 0;
+        int depth = 0;
+        QString variant;
+    };
+}
+
+QString MathRenderer::toMathml(const QString &tex, bool display) {
+    QString body = TexParser(tex, display).parse();
+    return QString("<math display=\"%1\"><semantics><mrow>%2</mrow><annotation encoding=\"application/x-tex\">%3</annotation></semantics></math>")
+            .arg(display ? "block" : "inline", body, escapeXml(tex));
+}
+
+QString MathRenderer::extractMath(const QString &markdown, QVector<MathFormula> &formulas) {
+    formulas.clear();
+    if (!markdown.contains('$')) {
+        return markdown;
+    }
+
+    auto placeholder = [&formulas](const QString &tex, bool display) {
+        formulas.append(MathFormula{tex, display});
+        return TokenStart + QString::number(formulas.size() - 1) + TokenEnd;
+    };
+
+    QString result;
+    result.reserve(markdown.size());
+    const qsizetype size = markdown.size();
+    QChar fenceChar;
+    qsizetype fenceLength = 0;// 0 表示不在围栏代码块中
+    bool paragraph = false;   // 上一行是段落文字：缩进的行是段落的延续，不是代码块
+    bool indentedCode = false;// 在缩进代码块中，空行不结束代码块
+    int listIndent = 0;       // 最近一个列表项内容的缩进列，代码块要在此基础上再缩进 4 列
+    bool lineStart = true;
+    qsizetype i = 0;
+    while (i < size) {
+        if (lineStart) {
+            lineStart = false;
+            qsizetype lineEnd = markdown.indexOf('\n', i);
+            lineEnd = lineEnd == -1 ? size : lineEnd + 1;
+            qsizetype j = i;
+            while (j < i + 3 && j < size && markdown[j] == ' ') {
+                ++j;
+            }
+            QChar c = j < size ? markdown[j] : QChar();
+            qsizetype run = 0;
+            if (c == '`' || c == '~') {
+                while (j + run < size && markdown[j + run] == c) {
+                    ++run;
+                }
+            }
+            bool fence = false;
+            if (fenceLength > 0) {
+                // 围栏代码块中的行原样复制，直到遇到同样的结束围栏
+                if (c == fenceChar && run >= fenceLength && QStringView(markdown).mid(j + run, lineEnd - j - run).trimmed().isEmpty()) {
+                    fenceLength = 0;
+                }
+                fence = true;
+            } else if (run >= 3 && !(c == '`' && QStringView(markdown).mid(j + run, lineEnd - j - run).contains('`'))) {
+                fenceChar = c;
+                fenceLength = run;
+                fence = true;
+            }
+            if (fence) {
+                result += QStringView(markdown).mid(i, lineEnd - i);
+                i = lineEnd;
+                lineStart = true;
+                paragraph = false;
+                indentedCode = false;
+                continue;
+            }
+
+            // 缩进代码块的行同样原样复制，否则公式会被换成 MathML 插进 <pre><code>
+            int column = 0;
+            qsizetype k = i;
+            while (k < lineEnd && (markdown[k] == ' ' || markdown[k] == '\t')) {
+                column = markdown[k] == '\t' ? column + 4 - column % 4 : column + 1;
+                ++k;
+            }
+            const bool blank = k == lineEnd || markdown[k] == '\n' || markdown[k] == '\r';
+            const bool code = !blank && (indentedCode || !paragraph) && column >= listIndent + 4;
+            if (blank || code) {
+                result += QStringView(markdown).mid(i, lineEnd - i);
+                i = lineEnd;
+                lineStart = true;
+                paragraph = false;
+                indentedCode = code || (blank && indentedCode);
+                continue;
+            }
+            indentedCode = false;
+
+            // 列表项标记：- * + 或 1. 1)，其后的内容缩进决定后续行是否属于这一项
+            qsizetype marker = k;
+            if (markdown[k] == '-' || markdown[k] == '*' || markdown[k] == '+') {
+                ++marker;
+            } else {
+                while (marker < lineEnd && marker - k < 9 && markdown[marker].isDigit()) {
+                    ++marker;
+                }
+                marker = marker > k && marker < lineEnd && (markdown[marker] == '.' || markdown[marker] == ')') ? marker + 1 : k;
+            }
+            if (marker > k && marker < lineEnd && (markdown[marker] == ' ' || markdown[marker] == '\t')) {
+                listIndent = column + int(marker - k) + 1;
+            } else if (!paragraph && column < listIndent) {
+                listIndent = 0;// 缩进不够的新段落已经离开了列表
+            }
+            paragraph = markdown[k] != '#';// ATX 标题只占一行
+        }
+
+        QChar c = markdown[i];
+        if (c == '\n') {
+            result += c;
+            ++i;
+            lineStart = true;
+            continue;
+        }
+        if (c == '\\' && i + 1 < size && markdown[i + 1] != '\n') {
+            result += QStringView(markdown).mid(i, 2);// 转义字符（包括 \$）
+            i += 2;
+            continue;
+        }
+        if (c == '`') {
+            // 行内代码原样复制
+            qsizetype run = 0;
+            while (i + run < size && markdown[i + run] == '`') {
+                ++run;
+            }
+            QString fence(run, '`');
+            qsizetype close = i + run;
+            while ((close = markdown.indexOf(fence, close)) != -1) {
+                if (close + run < size && markdown[close + run] == '`') {
+                    while (close < size && markdown[close] == '`') {
+                        ++close;
+                    }
+                    continue;
+                }
+                break;
+            }
+            qsizetype end = close == -1 ? i + run : close + run;
+            result += QStringView(markdown).mid(i, end - i);
+            i = end;
+            continue;
+        }
+        if (c == '$') {
+            if (i + 1 < size && markdown[i + 1] == '$') {
+                // 块级公式，可以跨行但不能跨段落
+                qsizetype close = markdown.indexOf("$$", i + 2);
+                if (close > i + 2 && !QStringView(markdown).mid(i + 2, close - i - 2).contains(u"\n\n")) {
+                    result += placeholder(markdown.mid(i + 2, close - i - 2).trimmed(), true);
+                    i = close + 2;
+                    continue;
+                }
+                result += "$$";
+                i += 2;
+                continue;
+            }
+            // 行内公式：$ 后不能是空白，结束的 $ 前不能是空白、后面不能紧跟数字（避免把 $5 和 $10 当成公式）
+            if (i + 1 < size && !markdown[i + 1].isSpace()) {
+                qsizetype j = i + 1;
+                while (j < size && markdown[j] != '$') {
+                    if (markdown[j] == '\\') {
+                        ++j;
+                    } else if (markdown[j] == '\n' && j + 1 < size && markdown[j + 1] == '\n') {
+                        j = size;
+                        break;
+                    }
+                    ++j;
+                }
+                if (j < size && !markdown[j - 1].isSpace() && !(j + 1 < size && markdown[j + 1].isDigit())) {
+                    result += placeholder(markdown.mid(i + 1, j - i - 1), false);
+                    i = j + 1;
+                    continue;
+                }
+            }
+            result += c;
+            ++i;
+            continue;
+        }
+        result += c;
+        ++i;
+    }
+    return result;
+}
+
+QByteArray MathRenderer::insertMath(const QByteArray &html, const QVector<MathFormula> &formulas) {
+    if (formulas.isEmpty()) {
+        return html;
+    }
+
+    // 占位符字符的 UTF-8 编码
+    const QByteArray tokenStart = QString(TokenStart).toUtf8();
+    const QByteArray tokenEnd = QString(TokenEnd).toUtf8();
+    QByteArray result;
+    result.reserve(html.size() + formulas.size() * 128);
+    qsizetype last = 0;
+    qsizetype start;
+    while ((start = html.indexOf(tokenStart, last)) != -1) {
+        qsizetype end = html.indexOf(tokenEnd, start);
+        if (end == -1) {
+            break;
+        }
+        result.append(QByteArrayView(html).mid(last, start - last));
+        last = end + tokenEnd.size();
+
+        bool ok;
+        int index = QByteArrayView(html).mid(start + tokenStart.size(), end - start - tokenStart.size()).toInt(&ok);
+        if (!ok || index < 0 || index >= formulas.size()) {
+            continue;
+        }
+        const MathFormula &formula = formulas[index];
+
+        // 图片的 alt 等属性中不能放 MathML，还原成原文
+        if (html.lastIndexOf('<', start) > html.lastIndexOf('>', start)) {
+            result += escapeXml(formula.display ? "$$" + formula.tex + "$$" : "$" + formula.tex + "$").toUtf8();
+            continue;
+        }
+
+        QString key = (formula.display ? "D" : "I") + formula.tex;
+        if (QByteArray *cached = cache.object(key)) {
+            result += *cached;
+        } else {
+            QByteArray mathml = toMathml(formula.tex, formula.display).toUtf8();
+            result += mathml;
+            cache.insert(key, new QByteArray(mathml));
+        }
+    }
+    result.append(QByteArrayView(html).mid(last));
+    return result;
+}
@@ -0,0 +1,31 @@
+#ifndef QMARKDOWNEDITOR_MATHRENDERER_H
+#define QMARKDOWNEDITOR_MATHRENDERER_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QString>
+#include <QVector>
+
+struct MathFormula {
+    QString tex;
+    bool display;// $$...$$ 为块级公式
+};
+
+// 数学公式：渲染前把 $...$ / $$...$$ 换成占位符，渲染后再替换成 MathML。
+// MathML 由 Chromium 原生排版，不需要额外的脚本；每个公式的转换结果按原文缓存
+class MathRenderer {
+public:
+    // 把 Markdown 中的公式换成占位符，公式按出现顺序写入 formulas（代码块和行内代码中的 $ 不处理）
+    static QString extractMath(const QString &markdown, QVector<MathFormula> &formulas);
+
+    // 把 UTF-8 HTML 中的占位符替换成 MathML，没有变化的公式直接取缓存
+    QByteArray insertMath(const QByteArray &html, const QVector<MathFormula> &formulas);
+
+    // 把一个 LaTeX 公式转换为 MathML（支持常用的命令、环境和符号）
+    static QString toMathml(const QString &tex, bool display);
+
+private:
+    QCache<QString, QByteArray> cache{20000};// 转换结果按 UTF-8 保存
+};
+
+#endif// QMARKDOWNEDITOR_MATHRENDERER_H
@@ -0,0 +1,54 @@
+#include "nativepreview.h"
+#include <QScrollBar>
+
+NativePreview::NativePreview(QWidget *parent) : QTextBrowser(parent) {
+    // 链接交给主窗口处理（本地 Markdown 在编辑器中打开）
+    setOpenLinks(false);
+    setFrameShape(QFrame::NoFrame);
+}
+
+void NativePreview::setSnapshot(const DocumentSnapshotPtr &snapshot, const PageStyle &style, const QString &baseDir,
+                                const NativeRenderer::ImageResolver &resolveImage) {
+    // 在新文档中构建，构建期间旧内容保持显示，也不会为每次插入触发重新布局
+    auto *document = new QTextDocument(this);
+    const int maxImageWidth = qMax(200, viewport()->width() - 40);
+    NativeRenderer::render(*snapshot, document, style, baseDir, maxImageWidth, resolveImage);
+
+    QPalette palette = this->palette();
+    palette.setColor(QPalette::Base, QColor(style.backgroundColor));
+    palette.setColor(QPalette::Text, QColor(style.textColor));
+    setPalette(palette);
+
+    const int scroll = verticalScrollBar()->value();
+    QTextDocument *previous = this->document();
+    setDocument(document);
+    if (previous && previous->parent() == this) {
+        previous->deleteLater();
+    }
+    verticalScrollBar()->setValue(scroll);
+}
+
+void NativePreview::scrollToHeading(int index) {
+    scrollToAnchor(NativeRenderer::headingAnchor(index));
+}
+
+QVariant NativePreview::loadResource(int type, const QUrl &name) {
+    if (type != QTextDocument::ImageResource || !name.isLocalFile()) {
+        return QTextBrowser::loadResource(type, name);
+    }
+    const QString path = name.toLocalFile();
+    if (QImage *cached = imageCache().object(path)) {
+        return *cached;
+    }
+    QImage image(path);
+    if (image.isNull()) {
+        return QVariant();
+    }
+    imageCache().insert(path, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    return image;
+}
+
+QCache<QString, QImage> &NativePreview::imageCache() {
+    static QCache<QString, QImage> cache(ImageCacheKB);
+    return cache;
+}
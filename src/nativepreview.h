@@ -0,0 +1,31 @@
+#ifndef QMARKDOWNEDITOR_NATIVEPREVIEW_H
+#define QMARKDOWNEDITOR_NATIVEPREVIEW_H
+
+#include "nativerenderer.h"
+#include <QCache>
+#include <QImage>
+#include <QTextBrowser>
+
+// 不依赖 Chromium 的预览视图：NativeRenderer 构建的文档显示在 QTextBrowser 中。
+// 每次更新都构建新文档再替换，滚动位置保持不变；解码后的图片在所有视图间共享，
+// 重新构建文档时不必再次读取
+class NativePreview : public QTextBrowser {
+    Q_OBJECT
+
+public:
+    explicit NativePreview(QWidget *parent = nullptr);
+
+    void setSnapshot(const DocumentSnapshotPtr &snapshot, const PageStyle &style, const QString &baseDir,
+                     const NativeRenderer::ImageResolver &resolveImage);
+    void scrollToHeading(int index);
+
+    static constexpr int ImageCacheKB = 128 * 1024;// 共享图片缓存的上限
+
+protected:
+    QVariant loadResource(int type, const QUrl &name) override;
+
+private:
+    static QCache<QString, QImage> &imageCache();
+};
+
+#endif// QMARKDOWNEDITOR_NATIVEPREVIEW_H
@@ -0,0 +1,267 @@
+#include "nativerenderer.h"
+#include <QColor>
+#include <QImageReader>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextList>
+#include <QUrl>
+
+namespace {
+    struct ListState {
+        QTextListFormat format;
+        QTextList *list = nullptr;
+        bool itemStarted = false;// 当前列表项的第一个块已经创建，后续块只缩进不加项目符号
+    };
+
+    QString literal(cmark_node *node) {
+        const char *text = cmark_node_get_literal(node);
+        return text ? QString::fromUtf8(text) : QString();
+    }
+
+    // 紧凑列表中的段落不留段后间距
+    bool inTightList(cmark_node *paragraph) {
+        cmark_node *item = cmark_node_parent(paragraph);
+        if (!item || cmark_node_get_type(item) != CMARK_NODE_ITEM) {
+            return false;
+        }
+        cmark_node *list = cmark_node_parent(item);
+        return list && cmark_node_get_list_tight(list);
+    }
+}
+
+void NativeRenderer::render(const DocumentSnapshot &snapshot, QTextDocument *document, const PageStyle &style,
+                            const QString &baseDir, int maxImageWidth, const ImageResolver &resolveImage) {
+    // 颜色随主题的背景深浅变化，与预览页面的样式保持接近
+    const bool dark = QColor(style.backgroundColor).lightness() < 128;
+    const QColor textColor(style.textColor);
+    const QColor mutedColor = dark ? QColor("#9aa5b1") : QColor("#6a737d");
+    const QColor linkColor = dark ? QColor("#78aeed") : QColor("#1c71d8");
+    const QColor codeBackground = dark ? QColor("#2d2d2d") : QColor("#f3f3f3");
+    const QStringList monospace{"Consolas", "Menlo", "monospace"};
+    const qreal paragraphSpacing = style.fontSize * 0.8;
+    const QUrl baseUrl = QUrl::fromLocalFile(baseDir + "/");
+
+    document->clear();
+    document->setDefaultFont(QFont(style.fontFamily, style.fontSize));
+    document->setDocumentMargin(16);
+
+    QTextCharFormat baseFormat;
+    baseFormat.setForeground(textColor);
+    QList<QTextCharFormat> formats{baseFormat};// 行内格式栈，栈顶为当前文字的格式
+    QList<ListState> lists;
+    QTextCursor cursor(document);
+    bool firstBlock = true;
+    int quoteDepth = 0;
+    int headingCount = 0;
+
+    // 新建一个块：文档的第一个块直接复用，列表项的第一个块加入列表
+    auto startBlock = [&](QTextBlockFormat blockFormat, const QTextCharFormat &charFormat) {
+        blockFormat.setLeftMargin(blockFormat.leftMargin() + quoteDepth * 20);
+        if (firstBlock) {
+            cursor.setBlockFormat(blockFormat);
+            cursor.setBlockCharFormat(charFormat);
+            firstBlock = false;
+        } else {
+            cursor.insertBlock(blockFormat, charFormat);
+        }
+        if (lists.isEmpty()) {
+            return;
+        }
+        ListState &state = lists.last();
+        if (!state.itemStarted) {
+            state.itemStarted = true;
+            if (state.list) {
+                state.list->add(cursor.block());
+            } else {
+                state.list = cursor.createList(state.format);
+            }
+        } else {
+            QTextBlockFormat continued = cursor.blockFormat();
+            continued.setIndent(lists.size());
+            cursor.setBlockFormat(continued);
+        }
+    };
+    auto pushFormat = [&](const std::function<void(QTextCharFormat &)> &change) {
+        QTextCharFormat format = formats.last();
+        change(format);
+        formats.append(format);
+    };
+
+    cmark_node *skipUntil = nullptr;// 已显示为图片的节点，其中的替代文字不再输出
+    snapshot.walk([&](cmark_node *node, cmark_event_type event, int) {
+        if (skipUntil) {
+            if (node == skipUntil && event == CMARK_EVENT_EXIT) {
+                skipUntil = nullptr;
+            }
+            return;
+        }
+        const bool entering = event == CMARK_EVENT_ENTER;
+
+        switch (cmark_node_get_type(node)) {
+            case CMARK_NODE_PARAGRAPH:
+                if (entering) {
+                    QTextBlockFormat block;
+                    block.setBottomMargin(inTightList(node) ? 2 : paragraphSpacing);
+                    startBlock(block, formats.last());
+                }
+                break;
+            case CMARK_NODE_HEADING:
+                if (entering) {
+                    static const qreal scale[] = {2.0, 1.5, 1.25, 1.1, 1.0, 0.9};
+                    const int level = qBound(1, cmark_node_get_heading_level(node), 6);
+                    QTextBlockFormat block;
+                    block.setHeadingLevel(level);
+                    block.setTopMargin(paragraphSpacing);
+                    block.setBottomMargin(paragraphSpacing * 0.6);
+                    pushFormat([&](QTextCharFormat &format) {
+                        format.setFontWeight(QFont::Bold);
+                        format.setFontPointSize(style.fontSize * scale[level - 1]);
+                        format.setAnchor(true);
+                        format.setAnchorNames({headingAnchor(headingCount++)});
+                    });
+                    startBlock(block, formats.last());
+                } else {
+                    formats.removeLast();
+                }
+                break;
+            case CMARK_NODE_CODE_BLOCK:
+            case CMARK_NODE_HTML_BLOCK: {
+                // 逐行建块，避免插入换行时把后续行也加进列表
+                QTextBlockFormat block;
+                block.setBackground(codeBackground);
+                block.setNonBreakableLines(true);
+                block.setLeftMargin(8);
+                QTextCharFormat code = baseFormat;
+                code.setFontFamilies(monospace);
+                if (cmark_node_get_type(node) == CMARK_NODE_HTML_BLOCK) {
+                    code.setForeground(mutedColor);
+                }
+                QString text = literal(node);
+                if (text.endsWith('\n')) {
+                    text.chop(1);
+                }
+                const QStringList lines = text.split('\n');
+                for (int i = 0; i < lines.size(); ++i) {
+                    if (i == lines.size() - 1) {
+                        block.setBottomMargin(paragraphSpacing);
+                    }
+                    startBlock(block, code);
+                    cursor.insertText(lines[i], code);
+                }
+                break;
+            }
+            case CMARK_NODE_THEMATIC_BREAK: {
+                QTextBlockFormat block;
+                block.setProperty(QTextFormat::BlockTrailingHorizontalRulerWidth, QTextLength(QTextLength::PercentageLength, 100));
+                startBlock(block, baseFormat);
+                break;
+            }
+            case CMARK_NODE_BLOCK_QUOTE:
+                if (entering) {
+                    ++quoteDepth;
+                    pushFormat([&](QTextCharFormat &format) {
+                        format.setForeground(mutedColor);
+                        format.setFontItalic(true);
+                    });
+                } else {
+                    --quoteDepth;
+                    formats.removeLast();
+                }
+                break;
+            case CMARK_NODE_LIST:
+                if (entering) {
+                    static const QTextListFormat::Style bullets[] = {QTextListFormat::ListDisc, QTextListFormat::ListCircle,
+                                                                     QTextListFormat::ListSquare};
+                    ListState state;
+                    if (cmark_node_get_list_type(node) == CMARK_ORDERED_LIST) {
+                        state.format.setStyle(QTextListFormat::ListDecimal);
+                        state.format.setStart(cmark_node_get_list_start(node));
+                    } else {
+                        state.format.setStyle(bullets[lists.size() % 3]);
+                    }
+                    state.format.setIndent(lists.size() + 1);
+                    lists.append(state);
+                } else {
+                    lists.removeLast();
+                }
+                break;
+            case CMARK_NODE_ITEM:
+                if (entering) {
+                    lists.last().itemStarted = false;
+                }
+                break;
+            case CMARK_NODE_TEXT:
+                cursor.insertText(literal(node), formats.last());
+                break;
+            case CMARK_NODE_SOFTBREAK:
+                cursor.insertText(" ", formats.last());
+                break;
+            case CMARK_NODE_LINEBREAK:
+                cursor.insertText(QString(QChar::LineSeparator), formats.last());
+                break;
+            case CMARK_NODE_CODE: {
+                QTextCharFormat code = formats.last();
+                code.setFontFamilies(monospace);
+                code.setBackground(codeBackground);
+                cursor.insertText(literal(node), code);
+                break;
+            }
+            case CMARK_NODE_HTML_INLINE: {
+                QTextCharFormat html = formats.last();
+                html.setForeground(mutedColor);
+                cursor.insertText(literal(node), html);
+                break;
+            }
+            case CMARK_NODE_EMPH:
+                if (entering) {
+                    pushFormat([](QTextCharFormat &format) { format.setFontItalic(true); });
+                } else {
+                    formats.removeLast();
+                }
+                break;
+            case CMARK_NODE_STRONG:
+                if (entering) {
+                    pushFormat([](QTextCharFormat &format) { format.setFontWeight(QFont::Bold); });
+                } else {
+                    formats.removeLast();
+                }
+                break;
+            case CMARK_NODE_LINK:
+                if (entering) {
+                    const QString href = baseUrl.resolved(QUrl(QString::fromUtf8(cmark_node_get_url(node)))).toString();
+                    pushFormat([&](QTextCharFormat &format) {
+                        format.setAnchor(true);
+                        format.setAnchorHref(href);
+                        format.setForeground(linkColor);
+                        format.setFontUnderline(true);
+                    });
+                } else {
+                    formats.removeLast();
+                }
+                break;
+            case CMARK_NODE_IMAGE: {
+                if (!entering) {
+                    break;
+                }
+                // 找不到的图片不处理，子节点作为替代文字照常输出
+                const QString path = resolveImage ? resolveImage(QString::fromUtf8(cmark_node_get_url(node))) : QString();
+                if (path.isEmpty()) {
+                    break;
+                }
+                QTextImageFormat image;
+                image.setName(QUrl::fromLocalFile(path).toString());
+                // 只读文件头取尺寸，解码交给显示时的资源加载
+                const QSize size = QImageReader(path).size();
+                if (size.isValid() && size.width() > maxImageWidth && maxImageWidth > 0) {
+                    image.setWidth(maxImageWidth);
+                    image.setHeight(qreal(size.height()) * maxImageWidth / size.width());
+                }
+                cursor.insertImage(image);
+                skipUntil = node;
+                break;
+            }
+            default:
+                break;
+        }
+    });
+}
@@ -0,0 +1,26 @@
+#ifndef QMARKDOWNEDITOR_NATIVERENDERER_H
+#define QMARKDOWNEDITOR_NATIVERENDERER_H
+
+#include "PageTemplate.hpp"
+#include "documentsnapshot.h"
+#include <QString>
+#include <QTextDocument>
+#include <functional>
+
+// 轻量预览：遍历 cmark AST 直接构建 QTextDocument，不经过 HTML 和 Chromium。
+// 支持标题、段落、强调、行内代码、代码块、引用、列表、分隔线、链接和本地图片；
+// 公式和图表按源码显示
+class NativeRenderer {
+public:
+    // 把 Markdown 中的图片地址换成要显示的本地文件，返回空字符串时显示替代文字
+    using ImageResolver = std::function<QString(const QString &url)>;
+
+    // 清空 document 并按 style 重新构建；相对链接以 baseDir 为基准，图片宽度不超过 maxImageWidth
+    static void render(const DocumentSnapshot &snapshot, QTextDocument *document, const PageStyle &style,
+                       const QString &baseDir, int maxImageWidth, const ImageResolver &resolveImage);
+
+    // 第 index 个标题（按文档顺序，从 0 开始）的锚点名，与大纲的行号一致
+    static QString headingAnchor(int index) { return QString("heading-%1").arg(index); }
+};
+
+#endif// QMARKDOWNEDITOR_NATIVERENDERER_H
@@ -0,0 +1,128 @@
+#include "outline.h"
+
+OutlineModel::OutlineModel(QObject *parent) : QAbstractListModel(parent) {}
+
+QVector<OutlineHeading> OutlineModel::extractHeadings(const DocumentSnapshot &snapshot) {
+    QVector<OutlineHeading> result;
+    OutlineHeading current{0, 0, QString()};
+    bool inHeading = false;
+    snapshot.walk([&](cmark_node *node, cmark_event_type event, int lineOffset) {
+        cmark_node_type type = cmark_node_get_type(node);
+
+        if (type == CMARK_NODE_HEADING) {
+            if (event == CMARK_EVENT_ENTER) {
+                current = OutlineHeading{cmark_node_get_heading_level(node), cmark_node_get_start_line(node) + lineOffset, QString()};
+                inHeading = true;
+            } else {
+                current.text = current.text.simplified();
+                result.append(current);
+                inHeading = false;
+            }
+        } else if (inHeading && event == CMARK_EVENT_ENTER) {
+            // 标题文字由文本、行内代码等叶子节点拼接而成
+            if (type == CMARK_NODE_TEXT || type == CMARK_NODE_CODE) {
+                current.text += QString::fromUtf8(cmark_node_get_literal(node));
+            } else if (type == CMARK_NODE_SOFTBREAK || type == CMARK_NODE_LINEBREAK) {
+                current.text += ' ';
+            }
+        }
+    });
+    return result;
+}
+
+void OutlineModel::setHeadings(const QVector<OutlineHeading> &newHeadings) {
+    const int oldCount = headings.size();
+    const int newCount = newHeadings.size();
+
+    auto sameEntry = [](const OutlineHeading &a, const OutlineHeading &b) {
+        return a.level == b.level && a.text == b.text;
+    };
+
+    // 公共前缀：编辑点之前的标题连行号都不会变化
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount &&
+           sameEntry(headings[prefix], newHeadings[prefix]) &&
+           headings[prefix].line == newHeadings[prefix].line) {
+        ++prefix;
+    }
+
+    // 公共后缀：编辑点之后的标题内容不变，最多只是整体平移了行号
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+           sameEntry(headings[oldCount - 1 - suffix], newHeadings[newCount - 1 - suffix])) {
+        ++suffix;
+    }
+
+    const int oldMiddle = oldCount - prefix - suffix;
+    const int newMiddle = newCount - prefix - suffix;
+    const int common = qMin(oldMiddle, newMiddle);
+
+    // 中间区间：先原地替换，再插入或删除多出来的行
+    for (int i = 0; i < common; ++i) {
+        headings[prefix + i] = newHeadings[prefix + i];
+    }
+    if (common > 0) {
+        emit dataChanged(index(prefix), index(prefix + common - 1));
+    }
+
+    if (newMiddle > oldMiddle) {
+        beginInsertRows(QModelIndex(), prefix + common, prefix + newMiddle - 1);
+        headings.insert(prefix + common, newMiddle - common, OutlineHeading{0, 0, QString()});
+        for (int i = common; i < newMiddle; ++i) {
+            headings[prefix + i] = newHeadings[prefix + i];
+        }
+        endInsertRows();
+    } else if (oldMiddle > newMiddle) {
+        beginRemoveRows(QModelIndex(), prefix + common, prefix + oldMiddle - 1);
+        headings.remove(prefix + common, oldMiddle - newMiddle);
+        endRemoveRows();
+    }
+
+    // 后缀部分只同步行号
+    int first = -1;
+    int last = -1;
+    for (int i = newCount - suffix; i < newCount; ++i) {
+        if (headings[i].line != newHeadings[i].line) {
+            headings[i].line = newHeadings[i].line;
+            if (first == -1) {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    if (first != -1) {
+        emit dataChanged(index(first), index(last), {LineRole, Qt::ToolTipRole});
+    }
+}
+
+void OutlineModel::clear() {
+    if (headings.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    headings.clear();
+    endResetModel();
+}
+
+int OutlineModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : headings.size();
+}
+
+QVariant OutlineModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= headings.size()) {
+        return QVariant();
+    }
+    const OutlineHeading &heading = headings.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            return QString(2 * (heading.level - 1), ' ') + heading.text;
+        case Qt::ToolTipRole:
+            return QString("第 %1 行").arg(heading.line);
+        case LevelRole:
+            return heading.level;
+        case LineRole:
+            return heading.line;
+        default:
+            return QVariant();
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef QMARKDOWNEDITOR_OUTLINE_H
+#define QMARKDOWNEDITOR_OUTLINE_H
+
+#include "documentsnapshot.h"
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+struct OutlineHeading {
+    int level; // 标题级别 1-6
+    int line;  // 标题起始行（从 1 开始）
+    QString text;
+};
+
+// 大纲模型：每次只对变化的标题区间发出增删改信号，视图无需整体重建
+class OutlineModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        LevelRole = Qt::UserRole + 1,
+        LineRole
+    };
+
+    explicit OutlineModel(QObject *parent = nullptr);
+
+    // 遍历快照的 AST 提取 CMARK_NODE_HEADING。每次修订整体提取一遍：解析已与预览共用，
+    // 剩下的只是一次树遍历；按变化区间更新的是模型和视图
+    static QVector<OutlineHeading> extractHeadings(const DocumentSnapshot &snapshot);
+
+    void setHeadings(const QVector<OutlineHeading> &newHeadings);
+    void clear();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<OutlineHeading> headings;
+};
+
+#endif// QMARKDOWNEDITOR_OUTLINE_H
@@ -0,0 +1,158 @@
+#include "previewlifecycle.h"
+#include <QDateTime>
+
+namespace {
+    // Chromium 不提供单个页面的内存占用。同源页面共用一个渲染进程，
+    // performance.memory 报告的是整个进程的 JS 堆，只计一次；每个页面按 DOM 节点数和已解码图片的大小估算
+    const char *const EstimateScript = R"((function () {
+    var nodes = document.getElementsByTagName('*').length;
+    var images = 0;
+    for (var i = 0; i < document.images.length; ++i) {
+        images += document.images[i].naturalWidth * document.images[i].naturalHeight * 4;
+    }
+    return {heap: performance.memory ? performance.memory.usedJSHeapSize : 0, page: nodes * 600 + images};
+})())";
+}
+
+PreviewLifecycle::PreviewLifecycle(QObject *parent) : QObject(parent), sampleTimer(new QTimer(this)) {
+    // 当前预览随编辑变化，定期重新估算
+    sampleTimer->setInterval(10000);
+    connect(sampleTimer, &QTimer::timeout, this, [this]() {
+        if (current) {
+            sample(current);
+        }
+    });
+    sampleTimer->start();
+}
+
+void PreviewLifecycle::setBudget(qint64 bytes) {
+    budgetBytes = bytes;
+    enforceBudget();
+}
+
+int PreviewLifecycle::indexOf(QWebEngineView *view) const {
+    for (int i = 0; i < entries.size(); ++i) {
+        if (entries[i].view == view) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void PreviewLifecycle::track(QWebEngineView *view) {
+    if (!view || indexOf(view) != -1) {
+        return;
+    }
+    Entry entry;
+    entry.view = view;
+    entry.hiddenSince = view == current ? 0 : QDateTime::currentMSecsSinceEpoch();
+    entries.append(entry);
+    connect(view, &QObject::destroyed, this, [this]() {
+        // QPointer 已经置空，移除所有失效的项
+        entries.removeIf([](const Entry &e) { return e.view.isNull(); });
+        emit statusChanged();
+    });
+    if (view != current) {
+        QTimer::singleShot(FreezeDelayMs, this, [this, guard = QPointer<QWebEngineView>(view)]() { freeze(guard); });
+    }
+    emit statusChanged();
+}
+
+void PreviewLifecycle::setCurrent(QWebEngineView *view) {
+    if (view == current) {
+        return;
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (current) {
+        int previous = indexOf(current);
+        if (previous != -1) {
+            entries[previous].hiddenSince = now;
+        }
+        // 隐藏前最后采样一次，冻结后页面不再执行脚本
+        sample(current);
+        QTimer::singleShot(FreezeDelayMs, this, [this, guard = current]() { freeze(guard); });
+    }
+
+    current = view;
+    int index = indexOf(view);
+    if (index != -1) {
+        Entry entry = entries.takeAt(index);
+        entry.hiddenSince = 0;
+        entries.prepend(entry);
+        // 丢弃的页面在这里重新加载，loadFinished 后由主窗口注入内容
+        if (view->page()->lifecycleState() != QWebEnginePage::LifecycleState::Active) {
+            view->page()->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+        }
+    }
+    enforceBudget();
+    emit statusChanged();
+}
+
+void PreviewLifecycle::sample(QWebEngineView *view) {
+    if (view->page()->lifecycleState() != QWebEnginePage::LifecycleState::Active) {
+        return;
+    }
+    view->page()->runJavaScript(EstimateScript, [this, guard = QPointer<QWebEngineView>(view)](const QVariant &result) {
+        int index = guard ? indexOf(guard) : -1;
+        if (index == -1) {
+            return;
+        }
+        const QVariantMap estimate = result.toMap();
+        entries[index].estimatedBytes = estimate.value("page").toLongLong();
+        sharedHeapBytes = estimate.value("heap").toLongLong();
+        enforceBudget();
+        emit statusChanged();
+    });
+}
+
+void PreviewLifecycle::freeze(QWebEngineView *view) {
+    if (!view || view == current || view->isVisible()) {
+        return;
+    }
+    if (view->page()->lifecycleState() == QWebEnginePage::LifecycleState::Active) {
+        view->page()->setLifecycleState(QWebEnginePage::LifecycleState::Frozen);
+        emit statusChanged();
+    }
+}
+
+void PreviewLifecycle::enforceBudget() {
+    qint64 total = totalEstimate();
+    // 从最久未使用的隐藏页面开始丢弃，当前预览永远保留
+    for (int i = entries.size() - 1; i > 0 && total > budgetBytes; --i) {
+        QWebEngineView *view = entries[i].view;
+        if (!view || view == current || view->isVisible()) {
+            continue;
+        }
+        QWebEnginePage *page = view->page();
+        if (page->lifecycleState() == QWebEnginePage::LifecycleState::Discarded) {
+            continue;
+        }
+        page->setLifecycleState(QWebEnginePage::LifecycleState::Discarded);
+        total -= entries[i].estimatedBytes;
+        emit statusChanged();
+    }
+}
+
+qint64 PreviewLifecycle::totalEstimate() const {
+    qint64 total = 0;
+    bool alive = false;
+    for (const Entry &entry: entries) {
+        if (entry.view && entry.view->page()->lifecycleState() != QWebEnginePage::LifecycleState::Discarded) {
+            total += entry.estimatedBytes;
+            alive = true;
+        }
+    }
+    return alive ? total + sharedHeapBytes : 0;
+}
+
+QList<PreviewStatus> PreviewLifecycle::statuses() const {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<PreviewStatus> result;
+    for (const Entry &entry: entries) {
+        if (entry.view) {
+            result.append(PreviewStatus{entry.view, entry.view->page()->lifecycleState(), entry.estimatedBytes,
+                                        entry.hiddenSince ? now - entry.hiddenSince : 0});
+        }
+    }
+    return result;
+}
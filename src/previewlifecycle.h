@@ -0,0 +1,63 @@
+#ifndef QMARKDOWNEDITOR_PREVIEWLIFECYCLE_H
+#define QMARKDOWNEDITOR_PREVIEWLIFECYCLE_H
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QWebEnginePage>
+#include <QWebEngineView>
+
+struct PreviewStatus {
+    QWebEngineView *view;
+    QWebEnginePage::LifecycleState state;
+    qint64 estimatedBytes;// 最近一次活动时采样的估算值，不含共享的 JS 堆
+    qint64 hiddenMs;      // 隐藏了多久，0 表示当前可见
+};
+
+// 预览页面的生命周期：隐藏的预览稍后冻结（停止脚本和渲染），
+// 所有未丢弃页面的估算内存超过预算时，从最久未使用的开始丢弃。
+// 丢弃的页面再次显示时由 Chromium 重新加载外壳，内容由主窗口重新注入
+class PreviewLifecycle : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PreviewLifecycle(QObject *parent = nullptr);
+
+    static constexpr int FreezeDelayMs = 5000;// 来回切换标签时不必反复冻结
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return budgetBytes; }
+
+    // 开始管理一个预览，视图销毁时自动移除
+    void track(QWebEngineView *view);
+    // 切换到 view 所在的标签，其余预览视为隐藏
+    void setCurrent(QWebEngineView *view);
+
+    QList<PreviewStatus> statuses() const;
+    qint64 totalEstimate() const;// 未丢弃页面的估算内存之和，加上一份共享的 JS 堆
+    qint64 sharedHeap() const { return sharedHeapBytes; }
+
+signals:
+    void statusChanged();
+
+private:
+    struct Entry {
+        QPointer<QWebEngineView> view;
+        qint64 estimatedBytes = 0;
+        qint64 hiddenSince = 0;// 毫秒时间戳，0 表示可见
+    };
+
+    int indexOf(QWebEngineView *view) const;
+    void sample(QWebEngineView *view);
+    void freeze(QWebEngineView *view);
+    void enforceBudget();
+
+    QList<Entry> entries;// 按最近使用排序，第一项是当前预览
+    QPointer<QWebEngineView> current;
+    qint64 budgetBytes = 512ll * 1024 * 1024;
+    qint64 sharedHeapBytes = 0;// 渲染进程的 JS 堆，所有预览共用，最近一次采样的值
+    QTimer *sampleTimer;
+};
+
+#endif// QMARKDOWNEDITOR_PREVIEWLIFECYCLE_H
@@ -0,0 +1,67 @@
+#include "previewpagepool.h"
+#include "PageTemplate.hpp"
+#include <QWebEngineProfile>
+#include <QWebEngineSettings>
+
+PreviewPage::PreviewPage(QObject *parent) : QWebEnginePage(QWebEngineProfile::defaultProfile(), parent) {
+    // 禁用滚动动画
+    settings()->setAttribute(QWebEngineSettings::ScrollAnimatorEnabled, false);
+    settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
+
+    // 启用 GPU 加速
+    settings()->setAttribute(QWebEngineSettings::Accelerated2dCanvasEnabled, true);
+    settings()->setAttribute(QWebEngineSettings::WebGLEnabled, true);
+
+    connect(this, &QWebEnginePage::loadStarted, this, [this]() {
+        shellReady = false;
+    });
+    connect(this, &QWebEnginePage::loadFinished, this, [this](bool success) {
+        shellReady = success;
+    });
+
+    // 以本地根目录为基准加载外壳，内容中的相对路径由 <base> 重新指定
+    setHtml(PageTemplate::buildShell(), QUrl("file:///"));
+}
+
+bool PreviewPage::acceptNavigationRequest(const QUrl &url, NavigationType type, bool isMainFrame) {
+    if (type == NavigationTypeLinkClicked && isMainFrame) {
+        emit linkActivated(url);
+        return false;
+    }
+    return QWebEnginePage::acceptNavigationRequest(url, type, isMainFrame);
+}
+
+PreviewPagePool::PreviewPagePool(int capacity, QObject *parent)
+    : QObject(parent), capacity(capacity), refillTimer(new QTimer(this)) {
+    refillTimer->setSingleShot(true);
+    refillTimer->setInterval(300);
+    connect(refillTimer, &QTimer::timeout, this, &PreviewPagePool::refill);
+    refillTimer->start();
+}
+
+PreviewPage *PreviewPagePool::take(QObject *newParent) {
+    PreviewPage *page = nullptr;
+    // 优先取已经加载完外壳的页面
+    for (int i = 0; i < pages.size(); ++i) {
+        if (pages[i]->isShellReady()) {
+            page = pages.takeAt(i);
+            break;
+        }
+    }
+    if (!page) {
+        page = pages.isEmpty() ? new PreviewPage() : pages.takeFirst();
+    }
+    page->setParent(newParent);
+    refillTimer->start();
+    return page;
+}
+
+void PreviewPagePool::refill() {
+    // 每次只创建一个页面，避免长时间占用界面线程
+    if (pages.size() < capacity) {
+        pages.append(new PreviewPage(this));
+    }
+    if (pages.size() < capacity) {
+        refillTimer->start();
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef QMARKDOWNEDITOR_PREVIEWPAGEPOOL_H
+#define QMARKDOWNEDITOR_PREVIEWPAGEPOOL_H
+
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <QWebEnginePage>
+
+// 预览页面：外壳加载后不再导航，点击的链接交给主窗口处理
+class PreviewPage : public QWebEnginePage {
+    Q_OBJECT
+
+public:
+    explicit PreviewPage(QObject *parent = nullptr);
+
+    bool isShellReady() const { return shellReady; }
+
+signals:
+    void linkActivated(const QUrl &url);
+
+protected:
+    bool acceptNavigationRequest(const QUrl &url, NavigationType type, bool isMainFrame) override;
+
+private:
+    bool shellReady = false;
+};
+
+// 预热的预览页面池：页面提前创建并加载好外壳（样式和 Highlight.js），打开标签时直接取用
+class PreviewPagePool : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PreviewPagePool(int capacity, QObject *parent = nullptr);
+
+    // 取出一个页面并交给 newParent 管理；池为空时同步创建一个
+    PreviewPage *take(QObject *newParent);
+
+private:
+    void refill();
+
+    QList<PreviewPage *> pages;
+    int capacity;
+    QTimer *refillTimer;// 空闲时逐个补充页面
+};
+
+#endif// QMARKDOWNEDITOR_PREVIEWPAGEPOOL_H
@@ -0,0 +1,58 @@
+#include "session.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+static const quint32 SessionMagic = 0x424E5353;// "BNSS"
+static const quint16 SessionVersion = 1;
+
+bool Session::loadSession() {
+    tabs.clear();
+    activeIndex = -1;
+
+    QFile file(sessionFilePath);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic;
+    quint16 version;
+    in >> magic >> version;
+    if (magic != SessionMagic || version != SessionVersion) {
+        return false;
+    }
+
+    qint32 active;
+    quint32 count;
+    in >> active >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        qint32 cursorPosition, editorScroll, scrollY;
+        in >> filePath >> cursorPosition >> editorScroll >> scrollY;
+        tabs.append(SessionTab{filePath, cursorPosition, editorScroll, scrollY});
+    }
+    if (in.status() != QDataStream::Ok) {
+        tabs.clear();
+        return false;
+    }
+    activeIndex = active;
+    return true;
+}
+
+bool Session::saveSession() const {
+    // 先写临时文件再替换，避免中途退出留下半个会话文件
+    QSaveFile file(sessionFilePath);
+    if (!file.open(QFile::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+
+    out << SessionMagic << SessionVersion << qint32(activeIndex) << quint32(tabs.size());
+    for (const SessionTab &tab: tabs) {
+        out << tab.filePath << qint32(tab.cursorPosition) << qint32(tab.editorScroll) << qint32(tab.scrollY);
+    }
+    return file.commit();
+}
@@ -0,0 +1,28 @@
+#ifndef QMARKDOWNEDITOR_SESSION_H
+#define QMARKDOWNEDITOR_SESSION_H
+
+#include <QDir>
+#include <QString>
+#include <QVector>
+
+struct SessionTab {
+    QString filePath;
+    int cursorPosition;// 编辑器光标位置
+    int editorScroll;  // 编辑器滚动条位置
+    int scrollY;       // 预览滚动位置（FileTab::scrollY）
+};
+
+// 会话：所有打开的标签及其状态，保存为紧凑的二进制文件
+class Session {
+public:
+    bool loadSession();
+    bool saveSession() const;
+
+    QVector<SessionTab> tabs;
+    int activeIndex = -1;
+
+private:
+    const QString sessionFilePath = QDir::homePath() + "/markdown_editor_session.bin"; // 会话文件路径
+};
+
+#endif// QMARKDOWNEDITOR_SESSION_H
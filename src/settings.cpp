@@ -10,6 +10,12 @@ void Settings::loadSettings() {
         theme = json.value("theme").toString("Solarized Light"); // 默认主题
         font = json.value("font").toString("Arial"); // 默认字体
         fontSize = json.value("fontSize").toInt(12); // 默认字体大小
+        largeFileMB = json.value("largeFileMB").toInt(64);
+        previewMemoryMB = json.value("previewMemoryMB").toInt(512);
+        spellCheck = json.value("spellCheck").toBool(true);
+        spellLanguage = json.value("spellLanguage").toString("en_US");
+        nativePreview = json.value("nativePreview").toBool(false);
+        collapseIdleMinutes = json.value("collapseIdleMinutes").toInt(30);
         lastOpenedFile = json.value("lastOpenedFile").toString(); // 加载最近打开文件路径
 
         file.close();
@@ -21,7 +27,12 @@ void Settings::saveSettings() {
     json["theme"] = theme;
     json["font"] = font;
     json["fontSize"] = fontSize;
-    json["lastOpenedFile"] = lastOpenedFile; // 保存最近打开文件路径
+    json["largeFileMB"] = largeFileMB;
+    json["previewMemoryMB"] = previewMemoryMB;
+    json["spellCheck"] = spellCheck;
+    json["spellLanguage"] = spellLanguage;
+    json["nativePreview"] = nativePreview;
+    json["collapseIdleMinutes"] = collapseIdleMinutes;
 
     QJsonDocument doc(json);
     QFile file(settingsFilePath);
@@ -30,10 +41,6 @@ void Settings::saveSettings() {
         file.close();
     }
 }
-void Settings::saveLastOpenedFile(const QString &filePath) {
-    lastOpenedFile = filePath; // 更新成员变量
-    saveSettings(); // 立即保存设置
-}
 
 QString Settings::getLastOpenedFile() const {
     return lastOpenedFile; // 返回最近打开的文件路径
@@ -10,16 +10,21 @@ class Settings {
 public:
     void loadSettings();
     void saveSettings();
-    void saveLastOpenedFile(const QString &filePath);
-    QString getLastOpenedFile() const;
+    QString getLastOpenedFile() const;// 旧版本记录的最近文件，仅在没有会话文件时使用
 
     QString theme; // 主题
     QString font;  // 字体
     int fontSize;  // 字体大小
+    int largeFileMB = 64;// 超过该大小（MB）的文件以只读方式分页打开
+    int previewMemoryMB = 512;// 所有预览页面的估算内存预算，超出时丢弃最久未用的隐藏预览
+    bool spellCheck = true;         // 编辑器拼写检查
+    QString spellLanguage = "en_US";// Hunspell 词典名
+    bool nativePreview = false;     // 使用不依赖 Chromium 的轻量预览
+    int collapseIdleMinutes = 30;   // 不活动超过该时间（分钟）的标签压缩保存，0 表示不折叠
 
 private:
     const QString settingsFilePath = QDir::homePath() + "/markdown_editor_settings.json"; // 设置文件路径
-    QString lastOpenedFile; // 最近打开的文件路径
+    QString lastOpenedFile; // 最近打开的文件路径（已由会话文件取代）
 };
 
 #endif // QMARKDOWNEDITOR_SETTINGS_HPP
@@ -0,0 +1,126 @@
+#include "spellchecker.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrent>
+
+SpellChecker::SpellChecker(QObject *parent) : QObject(parent) {
+}
+
+QStringList SpellChecker::dictionaryDirs() {
+    // 程序自带、用户数据目录，以及系统的 Hunspell 词典
+    return {QCoreApplication::applicationDirPath() + "/dictionaries",
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/dictionaries",
+            "/usr/share/hunspell",
+            "/usr/share/myspell/dicts",
+            "/Library/Spelling"};
+}
+
+QStringList SpellChecker::availableLanguages() {
+    QStringList languages;
+    for (const QString &dir: dictionaryDirs()) {
+        for (const QString &name: QDir(dir).entryList({"*.dic"}, QDir::Files)) {
+            const QString language = name.chopped(4);
+            if (!languages.contains(language) && QFileInfo::exists(dir + "/" + language + ".aff")) {
+                languages.append(language);
+            }
+        }
+    }
+    languages.sort();
+    return languages;
+}
+
+void SpellChecker::setLanguage(const QString &language) {
+    currentLanguage = language;
+    const int serial = ++loadSerial;
+    QString dicPath;
+    for (const QString &dir: dictionaryDirs()) {
+        if (QFileInfo::exists(dir + "/" + language + ".dic")) {
+            dicPath = dir + "/" + language + ".dic";
+            break;
+        }
+    }
+    if (dicPath.isEmpty()) {
+        setDictionary(nullptr);
+        return;
+    }
+    // 第一次使用时要展开词缀并编译，之后只是映射缓存文件
+    const QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/spell/" + language + ".dawg";
+    auto *watcher = new QFutureWatcher<QSharedPointer<const SpellDictionary>>(this);
+    connect(watcher, &QFutureWatcher<QSharedPointer<const SpellDictionary>>::finished, this, [this, watcher, serial]() {
+        watcher->deleteLater();
+        if (serial == loadSerial) {
+            setDictionary(watcher->result());
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([dicPath, cachePath]() {
+        auto dictionary = QSharedPointer<SpellDictionary>::create();
+        return dictionary->open(dicPath, cachePath) ? QSharedPointer<const SpellDictionary>(dictionary) : nullptr;
+    }));
+}
+
+void SpellChecker::setEnabled(bool value) {
+    if (enabled != value) {
+        enabled = value;
+        emit dictionaryChanged();
+    }
+}
+
+void SpellChecker::setDictionary(QSharedPointer<const SpellDictionary> dictionary) {
+    loaded = dictionary && !dictionary->isEmpty() ? dictionary : nullptr;
+    emit dictionaryChanged();
+}
+
+bool SpellChecker::nextWord(const QString &text, int from, int &start, int &length) {
+    auto latin = [](QChar c) { return c.isLetter() && c.script() == QChar::Script_Latin; };
+    auto apostrophe = [](QChar c) { return c == '\'' || c == QChar(0x2019); };
+    auto blocks = [](QChar c) { return c == '@' || c == '/' || c == '\\' || c == '_'; };
+    const int size = int(text.size());
+    int i = from;
+    while (i < size) {
+        if (!latin(text[i]) && !text[i].isDigit() && text[i] != '_') {
+            ++i;
+            continue;
+        }
+        const int begin = i;
+        bool checkable = true;
+        while (i < size) {
+            const QChar c = text[i];
+            if (latin(c) || c.isMark()) {
+                checkable = checkable && !(i > begin && c.isUpper());// 缩写和 camelCase 标识符
+                ++i;
+            } else if (c.isDigit() || c == '_') {
+                checkable = false;
+                ++i;
+            } else if (apostrophe(c) && i > begin && i + 1 < size && latin(text[i + 1])) {
+                ++i;
+            } else {
+                break;
+            }
+        }
+        const QChar before = begin > 0 ? text[begin - 1] : QChar(' ');
+        const QChar after = i < size ? text[i] : QChar(' ');
+        if (blocks(before) || blocks(after) || (before == '.' && begin > 1 && text[begin - 2].isLetterOrNumber()) ||
+            (after == '.' && i + 1 < size && text[i + 1].isLetterOrNumber())) {
+            checkable = false;
+        }
+        if (checkable && i - begin >= 2) {
+            start = begin;
+            length = i - begin;
+            return true;
+        }
+    }
+    return false;
+}
+
+QVector<QPair<int, int>> SpellChecker::misspelled(const SpellDictionary &dictionary, const QString &text,
+                                                  const QVector<QPair<int, int>> &words) {
+    QVector<QPair<int, int>> wrong;
+    for (auto word: words) {
+        if (!dictionary.check(QStringView(text).mid(word.first, word.second))) {
+            wrong.append(word);
+        }
+    }
+    return wrong;
+}
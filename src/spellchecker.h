@@ -0,0 +1,51 @@
+#ifndef QMARKDOWNEDITOR_SPELLCHECKER_H
+#define QMARKDOWNEDITOR_SPELLCHECKER_H
+
+#include "spelldictionary.h"
+#include <QObject>
+#include <QPair>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+// 全局的拼写检查设置与当前词典。词典在后台加载，加载完成或切换时发出 dictionaryChanged，
+// 各编辑器的高亮器据此重新检查。词典只读，可以同时被多个后台任务使用
+class SpellChecker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SpellChecker(QObject *parent = nullptr);
+
+    // 在后台加载语言对应的 Hunspell 词典（如 en_US），找不到时不做拼写检查
+    void setLanguage(const QString &language);
+    QString language() const { return currentLanguage; }
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    void setDictionary(QSharedPointer<const SpellDictionary> dictionary);
+
+    // 关闭或词典不可用时为空
+    QSharedPointer<const SpellDictionary> dictionary() const { return enabled ? loaded : nullptr; }
+
+    // 可以找到词典的语言
+    static QStringList availableLanguages();
+
+    // 从 from 开始的下一个需要检查的词：只含拉丁字母（中间可以有撇号）。
+    // 含数字或下划线、首字母之后有大写、紧贴 @ / \ 或 . 的（缩写、标识符、网址、文件名）不检查
+    static bool nextWord(const QString &text, int from, int &start, int &length);
+    // words 中拼错的词（位置，长度），在后台线程调用
+    static QVector<QPair<int, int>> misspelled(const SpellDictionary &dictionary, const QString &text,
+                                               const QVector<QPair<int, int>> &words);
+
+signals:
+    void dictionaryChanged();
+
+private:
+    static QStringList dictionaryDirs();
+
+    QSharedPointer<const SpellDictionary> loaded;
+    QString currentLanguage;
+    bool enabled = true;
+    int loadSerial = 0;// 连续切换语言时只采用最后一次加载的结果
+};
+
+#endif// QMARKDOWNEDITOR_SPELLCHECKER_H
@@ -0,0 +1,436 @@
+#include "spelldictionary.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <QStringDecoder>
+#include <QtEndian>
+#include <algorithm>
+#include <functional>
+
+namespace {
+    const char Magic[8] = {'B', 'N', 'D', 'A', 'W', 'G', '1', '\0'};
+    const int HeaderSize = 20;// 魔数 + 边数 + 根节点 + 词数
+    const quint32 LastEdge = 1u << 8;
+    const quint32 FinalEdge = 1u << 9;
+    const int TargetShift = 10;
+    const quint32 MaxTarget = (1u << 22) - 1;
+
+    struct BuildNode {
+        QVector<QPair<uchar, int>> edges;
+        bool final = false;
+    };
+
+    // 节点的等价签名：是否为词尾，以及每条边的字节和目标（目标都已是最小化后的节点）
+    QByteArray signature(const BuildNode &node) {
+        QByteArray key;
+        key.reserve(1 + node.edges.size() * 5);
+        key.append(node.final ? '1' : '0');
+        for (const auto &edge: node.edges) {
+            key.append(char(edge.first));
+            key.append(reinterpret_cast<const char *>(&edge.second), sizeof(int));
+        }
+        return key;
+    }
+
+    enum FlagType { CharFlags, LongFlags, NumericFlags };
+
+    QStringList splitFlags(const QString &flags, FlagType type) {
+        QStringList result;
+        if (type == NumericFlags) {
+            return flags.split(',', Qt::SkipEmptyParts);
+        }
+        const int width = type == LongFlags ? 2 : 1;
+        for (qsizetype i = 0; i + width <= flags.size(); i += width) {
+            result.append(flags.mid(i, width));
+        }
+        return result;
+    }
+
+    // 条件中的一个位置：[abc]、[^abc]、. 或单个字符
+    struct CharClass {
+        QString chars;
+        bool negate = false;
+        bool any = false;
+    };
+
+    struct AffixRule {
+        QString strip;
+        QString add;
+        QVector<CharClass> condition;
+        bool cross = false;// 是否可以与另一侧的词缀组合
+    };
+
+    QVector<CharClass> parseCondition(const QString &condition) {
+        QVector<CharClass> result;
+        for (qsizetype i = 0; i < condition.size(); ++i) {
+            CharClass item;
+            if (condition[i] == '.') {
+                item.any = true;
+            } else if (condition[i] == '[') {
+                qsizetype close = condition.indexOf(']', i + 1);
+                if (close == -1) {
+                    close = condition.size();
+                }
+                item.negate = i + 1 < close && condition[i + 1] == '^';
+                item.chars = condition.mid(i + (item.negate ? 2 : 1), close - i - (item.negate ? 2 : 1));
+                i = close;
+            } else {
+                item.chars = condition[i];
+            }
+            result.append(item);
+        }
+        return result;
+    }
+
+    bool classMatches(const CharClass &item, QChar c) {
+        if (item.any) {
+            return true;
+        }
+        return item.chars.contains(c) != item.negate;
+    }
+
+    // 后缀的条件对齐词尾，前缀的条件对齐词首
+    bool suffixApplies(const AffixRule &rule, const QString &word) {
+        const qsizetype n = rule.condition.size();
+        if (word.size() <= rule.strip.size() || word.size() < n || !word.endsWith(rule.strip)) {
+            return false;
+        }
+        for (qsizetype i = 0; i < n; ++i) {
+            if (!classMatches(rule.condition[i], word[word.size() - n + i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool prefixApplies(const AffixRule &rule, const QString &word) {
+        const qsizetype n = rule.condition.size();
+        if (word.size() <= rule.strip.size() || word.size() < n || !word.startsWith(rule.strip)) {
+            return false;
+        }
+        for (qsizetype i = 0; i < n; ++i) {
+            if (!classMatches(rule.condition[i], word[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 按 .aff 中 SET 声明的编码解码，不支持的编码返回空
+    QString decode(const QByteArray &bytes, const QByteArray &encoding) {
+        QStringDecoder decoder(encoding.isEmpty() ? QByteArray("ISO-8859-1") : encoding);
+        if (!decoder.isValid()) {
+            return QString();
+        }
+        return decoder(bytes);
+    }
+}
+
+QByteArray SpellDictionary::compile(QList<QByteArray> words) {
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    // 按字典序增量构建并最小化（Daciuk 算法）：上一个词与当前词公共前缀之后的节点不会再变化，
+    // 可以立即与已登记的等价节点合并
+    QVector<BuildNode> nodes(1);
+    QHash<QByteArray, int> registry;
+    QVector<int> path{0};
+    auto minimize = [&](qsizetype depth) {
+        while (path.size() - 1 > depth) {
+            const int child = path.takeLast();
+            const QByteArray key = signature(nodes[child]);
+            auto it = registry.constFind(key);
+            if (it != registry.constEnd()) {
+                nodes[path.last()].edges.last().second = it.value();
+            } else {
+                registry.insert(key, child);
+            }
+        }
+    };
+    QByteArray previous;
+    int wordCount = 0;
+    for (const QByteArray &word: words) {
+        if (word.isEmpty()) {
+            continue;
+        }
+        qsizetype common = 0;
+        while (common < word.size() && common < previous.size() && word[common] == previous[common]) {
+            ++common;
+        }
+        minimize(common);
+        for (qsizetype k = common; k < word.size(); ++k) {
+            nodes.append(BuildNode());
+            const int id = int(nodes.size() - 1);
+            nodes[path.last()].edges.append({uchar(word[k]), id});
+            path.append(id);
+        }
+        nodes[path.last()].final = true;
+        previous = word;
+        ++wordCount;
+    }
+    minimize(0);
+
+    // 后序写出：子节点先就位，节点的边连续存放；下标 0 留空表示“没有后继”
+    QVector<quint32> edges{0};
+    QHash<int, quint32> placed;
+    bool overflow = false;
+    std::function<quint32(int)> place = [&](int id) -> quint32 {
+        if (nodes[id].edges.isEmpty() || overflow) {
+            return 0;
+        }
+        auto it = placed.constFind(id);
+        if (it != placed.constEnd()) {
+            return it.value();
+        }
+        QVector<quint32> targets;
+        for (const auto &edge: nodes[id].edges) {
+            targets.append(place(edge.second));
+        }
+        const quint32 start = quint32(edges.size());
+        if (start + nodes[id].edges.size() > MaxTarget) {
+            overflow = true;
+            return 0;
+        }
+        for (qsizetype j = 0; j < nodes[id].edges.size(); ++j) {
+            const auto &edge = nodes[id].edges[j];
+            quint32 value = edge.first | (targets[j] << TargetShift);
+            if (j == nodes[id].edges.size() - 1) {
+                value |= LastEdge;
+            }
+            if (nodes[edge.second].final) {
+                value |= FinalEdge;
+            }
+            edges.append(value);
+        }
+        placed.insert(id, start);
+        return start;
+    };
+    const quint32 root = place(0);
+    if (overflow) {
+        return QByteArray();
+    }
+
+    QByteArray out(HeaderSize + edges.size() * 4, Qt::Uninitialized);
+    uchar *bytes = reinterpret_cast<uchar *>(out.data());
+    memcpy(bytes, Magic, sizeof(Magic));
+    qToLittleEndian<quint32>(quint32(edges.size()), bytes + 8);
+    qToLittleEndian<quint32>(root, bytes + 12);
+    qToLittleEndian<quint32>(quint32(wordCount), bytes + 16);
+    for (qsizetype i = 0; i < edges.size(); ++i) {
+        qToLittleEndian<quint32>(edges[i], bytes + HeaderSize + i * 4);
+    }
+    return out;
+}
+
+QList<QByteArray> SpellDictionary::expandHunspell(const QString &dicPath, const QString &affPath) {
+    QList<QByteArray> forms;
+    QFile affFile(affPath);
+    QFile dicFile(dicPath);
+    if (!dicFile.open(QFile::ReadOnly)) {
+        return forms;
+    }
+    const QByteArray affBytes = affFile.open(QFile::ReadOnly) ? affFile.readAll() : QByteArray();
+
+    // SET 之前的内容都是 ASCII，先找到编码再整体解码
+    QByteArray encoding;
+    for (const QByteArray &line: affBytes.split('\n')) {
+        if (line.startsWith("SET ")) {
+            encoding = line.mid(4).trimmed();
+            break;
+        }
+    }
+    const QString aff = decode(affBytes, encoding);
+    const QString dic = decode(dicFile.readAll(), encoding);
+    if (dic.isEmpty()) {
+        return forms;
+    }
+
+    FlagType flagType = CharFlags;
+    QSet<QString> noBareWord;// 带这些标记的词根本身不是合法的词
+    QSet<QString> forbidden;
+    QHash<QString, bool> cross;
+    QHash<QString, QList<AffixRule>> prefixes, suffixes;
+    for (const QString &line: aff.split('\n')) {
+        const QStringList fields = line.simplified().split(' ', Qt::SkipEmptyParts);
+        if (fields.size() < 2 || fields[0].startsWith('#')) {
+            continue;
+        }
+        const QString &key = fields[0];
+        if (key == "FLAG") {
+            flagType = fields[1] == "long" ? LongFlags : fields[1] == "num" ? NumericFlags : CharFlags;
+        } else if (key == "NEEDAFFIX" || key == "ONLYINCOMPOUND") {
+            noBareWord.insert(fields[1]);
+        } else if (key == "FORBIDDENWORD") {
+            forbidden.insert(fields[1]);
+        } else if ((key == "PFX" || key == "SFX") && fields.size() >= 4) {
+            bool isCount = false;
+            fields[3].toInt(&isCount);
+            if (fields.size() == 4 && (fields[2] == "Y" || fields[2] == "N") && isCount) {
+                cross.insert(key + fields[1], fields[2] == "Y");
+                continue;
+            }
+            AffixRule rule;
+            rule.strip = fields[2] == "0" ? QString() : fields[2];
+            rule.add = fields[3].section('/', 0, 0);
+            if (rule.add == "0") {
+                rule.add.clear();
+            }
+            rule.condition = parseCondition(fields.size() > 4 ? fields[4] : QString("."));
+            if (fields.size() > 4 && fields[4] == ".") {
+                rule.condition.clear();
+            }
+            rule.cross = cross.value(key + fields[1]);
+            (key == "PFX" ? prefixes : suffixes)[fields[1]].append(rule);
+        }
+    }
+
+    const QStringList lines = dic.split('\n');
+    for (qsizetype n = 1; n < lines.size(); ++n) {// 第一行是词数
+        QString entry = lines[n].section('\t', 0, 0).section(' ', 0, 0).trimmed();
+        if (entry.isEmpty()) {
+            continue;
+        }
+        qsizetype slash = entry.indexOf('/');
+        while (slash > 0 && entry[slash - 1] == '\\') {
+            slash = entry.indexOf('/', slash + 1);
+        }
+        const QString word = QString(slash == -1 ? entry : entry.left(slash)).replace("\\/", "/");
+        const QStringList flags = slash == -1 ? QStringList() : splitFlags(entry.mid(slash + 1), flagType);
+
+        bool bare = true;
+        bool skip = false;
+        for (const QString &flag: flags) {
+            bare = bare && !noBareWord.contains(flag);
+            skip = skip || forbidden.contains(flag);
+        }
+        if (skip) {
+            continue;
+        }
+        if (bare) {
+            forms.append(word.toUtf8());
+        }
+        QStringList crossSuffixed;
+        for (const QString &flag: flags) {
+            for (const AffixRule &rule: suffixes.value(flag)) {
+                if (suffixApplies(rule, word)) {
+                    const QString form = word.chopped(rule.strip.size()) + rule.add;
+                    forms.append(form.toUtf8());
+                    if (rule.cross) {
+                        crossSuffixed.append(form);
+                    }
+                }
+            }
+        }
+        for (const QString &flag: flags) {
+            for (const AffixRule &rule: prefixes.value(flag)) {
+                if (!prefixApplies(rule, word)) {
+                    continue;
+                }
+                forms.append((rule.add + word.mid(rule.strip.size())).toUtf8());
+                if (rule.cross) {
+                    for (const QString &suffixed: crossSuffixed) {
+                        forms.append((rule.add + suffixed.mid(rule.strip.size())).toUtf8());
+                    }
+                }
+            }
+        }
+    }
+    return forms;
+}
+
+bool SpellDictionary::open(const QString &dicPath, const QString &cachePath) {
+    const QString affPath = dicPath.chopped(4) + ".aff";
+    const QFileInfo cache(cachePath);
+    const QDateTime source = qMax(QFileInfo(dicPath).lastModified(), QFileInfo(affPath).lastModified());
+    if (!cache.exists() || cache.lastModified() < source) {
+        const QByteArray data = compile(expandHunspell(dicPath, affPath));
+        if (data.isEmpty()) {
+            return false;
+        }
+        QDir().mkpath(cache.absolutePath());
+        QSaveFile out(cachePath);
+        if (!out.open(QFile::WriteOnly) || out.write(data) != data.size() || !out.commit()) {
+            owned = data;// 缓存写不进去时直接使用内存中的结果
+            return attach(reinterpret_cast<const uchar *>(owned.constData()), owned.size());
+        }
+    }
+    file.setFileName(cachePath);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const uchar *bytes = file.map(0, file.size());
+    return bytes && attach(bytes, file.size());
+}
+
+bool SpellDictionary::build(QList<QByteArray> words) {
+    owned = compile(std::move(words));
+    return attach(reinterpret_cast<const uchar *>(owned.constData()), owned.size());
+}
+
+bool SpellDictionary::attach(const uchar *bytes, qint64 size) {
+    if (size < HeaderSize || memcmp(bytes, Magic, sizeof(Magic)) != 0) {
+        return false;
+    }
+    const quint32 count = qFromLittleEndian<quint32>(bytes + 8);
+    const quint32 start = qFromLittleEndian<quint32>(bytes + 12);
+    if (size < HeaderSize + qint64(count) * 4 || start >= qMax<quint32>(count, 1)) {
+        return false;
+    }
+    edges = bytes + HeaderSize;
+    edgeCount = count;
+    root = start;
+    wordCount = int(qFromLittleEndian<quint32>(bytes + 16));
+    return true;
+}
+
+bool SpellDictionary::containsUtf8(QByteArrayView word) const {
+    quint32 node = root;
+    bool final = false;
+    for (char c: word) {
+        if (node == 0) {
+            return false;
+        }
+        quint32 edge;
+        for (quint32 i = node;; ++i) {
+            if (i >= edgeCount) {
+                return false;// 损坏的缓存
+            }
+            edge = qFromLittleEndian<quint32>(edges + i * 4);
+            if ((edge & 0xFF) == uchar(c)) {
+                break;
+            }
+            if (edge & LastEdge) {
+                return false;
+            }
+        }
+        final = edge & FinalEdge;
+        node = edge >> TargetShift;
+    }
+    return final;
+}
+
+bool SpellDictionary::check(QStringView word) const {
+    if (!edges || word.isEmpty()) {
+        return false;
+    }
+    QString text = word.toString();
+    text.replace(QChar(0x2019), '\'');// 排版用的右单引号按撇号处理
+    if (containsUtf8(text.toUtf8())) {
+        return true;
+    }
+    const QString lower = text.toLower();
+    const bool allUpper = text == text.toUpper();
+    const bool capitalized = text[0].isUpper() && QStringView(text).mid(1) == QStringView(lower).mid(1);
+    if ((allUpper || capitalized) && containsUtf8(lower.toUtf8())) {
+        return true;
+    }
+    if (allUpper) {
+        QString title = lower;
+        title[0] = title[0].toUpper();
+        return containsUtf8(title.toUtf8());
+    }
+    return false;
+}
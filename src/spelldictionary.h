@@ -0,0 +1,48 @@
+#ifndef QMARKDOWNEDITOR_SPELLDICTIONARY_H
+#define QMARKDOWNEDITOR_SPELLDICTIONARY_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+// 拼写词典：所有词形（UTF-8）编译成最小化的 DAWG（共享前缀和后缀的有向无环词图），
+// 以平坦的边数组写入缓存文件，之后直接内存映射查询，不需要解析也不占堆内存。
+// 每条边 32 位：低 8 位为字节，第 8 位表示节点的最后一条边，第 9 位表示走到这里构成完整的词，
+// 其余 22 位为目标节点第一条边的下标（0 表示没有后继）。只读，可以在任意线程查询
+class SpellDictionary {
+public:
+    SpellDictionary() = default;
+    SpellDictionary(const SpellDictionary &) = delete;
+    SpellDictionary &operator=(const SpellDictionary &) = delete;
+
+    // 打开 Hunspell 词典（.dic 与同名 .aff），编译结果缓存在 cachePath，词典未变化时直接映射缓存
+    bool open(const QString &dicPath, const QString &cachePath);
+    // 直接由词表构建（不落盘），供基准测试等使用
+    bool build(QList<QByteArray> words);
+
+    bool isEmpty() const { return root == 0; }
+    int words() const { return wordCount; }
+
+    // 按常见的大小写规则查词：原样、首字母大写或全大写的词也接受词典中的小写形式
+    bool check(QStringView word) const;
+
+    // 词表编译为 DAWG 文件内容，边数超出 22 位下标时返回空
+    static QByteArray compile(QList<QByteArray> words);
+    // 展开 Hunspell 词典的前后缀规则，得到全部词形
+    static QList<QByteArray> expandHunspell(const QString &dicPath, const QString &affPath);
+
+private:
+    bool attach(const uchar *bytes, qint64 size);
+    bool containsUtf8(QByteArrayView word) const;
+
+    QFile file;     // 映射的缓存文件
+    QByteArray owned;// build() 生成的数据
+    const uchar *edges = nullptr;
+    quint32 edgeCount = 0;
+    quint32 root = 0;
+    int wordCount = 0;
+};
+
+#endif// QMARKDOWNEDITOR_SPELLDICTIONARY_H
@@ -0,0 +1,48 @@
+#ifndef QMARKDOWNEDITOR_STARTUPPROFILER_H
+#define QMARKDOWNEDITOR_STARTUPPROFILER_H
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+// 启动阶段计时：记录每个阶段相对上一阶段的耗时，启动完成后输出汇总
+class StartupProfiler {
+public:
+    inline static void start() {
+        elapsedTimer.start();
+        lastMark = 0;
+        phases.clear();
+    }
+
+    inline static void mark(const QString &phase) {
+        if (!elapsedTimer.isValid()) {
+            return;
+        }
+        qint64 now = elapsedTimer.elapsed();
+        phases.append(qMakePair(phase, now - lastMark));
+        qInfo().noquote() << QString("[startup] %1: +%2 ms (累计 %3 ms)").arg(phase).arg(now - lastMark).arg(now);
+        lastMark = now;
+    }
+
+    // 输出各阶段耗时汇总，之后的 mark 调用不再记录
+    inline static void finish() {
+        if (!elapsedTimer.isValid()) {
+            return;
+        }
+        qInfo().noquote() << "[startup] 启动耗时分解:";
+        for (const auto &phase: phases) {
+            qInfo().noquote() << QString("[startup]   %1 %2 ms").arg(phase.first, -24).arg(phase.second, 6);
+        }
+        qInfo().noquote() << QString("[startup]   %1 %2 ms").arg("总计", -24).arg(elapsedTimer.elapsed(), 6);
+        elapsedTimer.invalidate();
+    }
+
+private:
+    inline static QElapsedTimer elapsedTimer;
+    inline static qint64 lastMark = 0;
+    inline static QVector<QPair<QString, qint64>> phases;
+};
+
+#endif// QMARKDOWNEDITOR_STARTUPPROFILER_H
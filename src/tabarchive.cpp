@@ -0,0 +1,111 @@
+#include "tabarchive.h"
+#include <QDataStream>
+#include <QTextCursor>
+
+namespace {
+    constexpr quint32 ArchiveMagic = 0x424e5441;// "BNTA"
+    constexpr quint32 ArchiveVersion = 1;
+}
+
+EditJournal::EditJournal(QTextDocument *document, const QString &base, const QVector<Edit> &edits)
+    : QObject(document), document(document), base(base), log(edits) {
+    for (const Edit &edit: log) {
+        chars += edit.added.size();
+    }
+    connect(document, &QTextDocument::contentsChange, this, &EditJournal::record);
+}
+
+void EditJournal::record(int position, int removed, int added) {
+    // 信号发出时修改已经完成，插入的文字从文档中读回；
+    // Qt 有时把文档末尾隐含的段落分隔符也计入长度，重放时同样按文档长度截断
+    QString text;
+    if (added > 0) {
+        const int last = document->characterCount() - 1;
+        QTextCursor cursor(document);
+        cursor.setPosition(qMin(position, last));
+        cursor.setPosition(qMin(position + added, last), QTextCursor::KeepAnchor);
+        text = cursor.selectedText().replace(QChar::ParagraphSeparator, '\n');
+    }
+    chars += text.size();
+    if (chars > MaxChars) {
+        base = document->toPlainText();
+        log.clear();
+        chars = 0;
+        return;
+    }
+    log.append(Edit{position, removed, text});
+}
+
+QByteArray TabArchive::store(const QTextDocument *document, const EditJournal &journal, const TabViewState &state) {
+    QByteArray raw;
+    QDataStream out(&raw, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << ArchiveMagic << ArchiveVersion << document->toPlainText().toUtf8();
+    // 没有修改时基准就是当前文本，不重复保存
+    const QVector<EditJournal::Edit> &edits = journal.edits();
+    out << qint32(edits.size());
+    if (!edits.isEmpty()) {
+        out << journal.baseText().toUtf8();
+        for (const EditJournal::Edit &edit: edits) {
+            out << qint32(edit.position) << qint32(edit.removed) << edit.added.toUtf8();
+        }
+    }
+    out << qint32(state.anchor) << qint32(state.position) << qint32(state.scroll);
+    return qCompress(raw);
+}
+
+EditJournal *TabArchive::restore(const QByteArray &archive, QTextDocument *document, TabViewState &state, QString &text) {
+    const QByteArray raw = qUncompress(archive);
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray current;
+    qint32 count = 0;
+    in >> magic >> version >> current >> count;
+    if (magic != ArchiveMagic || version != ArchiveVersion || count < 0) {
+        return nullptr;
+    }
+    QByteArray base = current;
+    QVector<EditJournal::Edit> edits;
+    if (count > 0) {
+        in >> base;
+        edits.reserve(count);
+        for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            qint32 position;
+            qint32 removed;
+            QByteArray added;
+            in >> position >> removed >> added;
+            edits.append(EditJournal::Edit{position, removed, QString::fromUtf8(added)});
+        }
+    }
+    qint32 anchor;
+    qint32 position;
+    qint32 scroll;
+    in >> anchor >> position >> scroll;
+    if (in.status() != QDataStream::Ok) {
+        return nullptr;
+    }
+    state = TabViewState{anchor, position, scroll};
+    text = QString::fromUtf8(current);
+
+    // 从基准文本开始逐条重放，每条修改都进入撤销栈
+    const QString baseText = QString::fromUtf8(base);
+    document->setPlainText(baseText);
+    QTextCursor cursor(document);
+    for (const EditJournal::Edit &edit: edits) {
+        const int last = document->characterCount() - 1;
+        cursor.setPosition(qMin(edit.position, last));
+        cursor.setPosition(qMin(edit.position + edit.removed, last), QTextCursor::KeepAnchor);
+        if (edit.added.isEmpty()) {
+            cursor.removeSelectedText();
+        } else {
+            cursor.insertText(edit.added);
+        }
+    }
+    if (document->toPlainText() != text) {
+        document->setPlainText(text);
+        return new EditJournal(document, text);
+    }
+    return new EditJournal(document, baseText, edits);
+}
@@ -0,0 +1,56 @@
+#ifndef QMARKDOWNEDITOR_TABARCHIVE_H
+#define QMARKDOWNEDITOR_TABARCHIVE_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QTextDocument>
+#include <QVector>
+
+// 编辑日志：记录文档自基准文本以来的每次修改。在基准文本上按顺序重放，
+// 既得到当前文本，也重建出 QTextDocument 的撤销栈（Qt 的撤销栈本身不能序列化）
+class EditJournal : public QObject {
+    Q_OBJECT
+
+public:
+    struct Edit {
+        int position;
+        int removed;  // 删除的字符数
+        QString added;// 插入的文字
+    };
+
+    // 随 document 一起销毁
+    EditJournal(QTextDocument *document, const QString &base, const QVector<Edit> &edits = {});
+
+    // 日志中插入文字的总量上限，超出时以当前文本为新基准，更早的撤销历史不再保存
+    static constexpr qsizetype MaxChars = 1024 * 1024;
+
+    const QString &baseText() const { return base; }
+    const QVector<Edit> &edits() const { return log; }
+
+private:
+    void record(int position, int removed, int added);
+
+    QTextDocument *document;
+    QString base;
+    QVector<Edit> log;
+    qsizetype chars = 0;
+};
+
+struct TabViewState {
+    int anchor;  // 选区起点
+    int position;// 光标位置
+    int scroll;  // 编辑器滚动条位置
+};
+
+// 不活动标签的压缩存档：当前文本（UTF-8）、编辑日志和光标/滚动位置序列化后整体压缩
+class TabArchive {
+public:
+    static QByteArray store(const QTextDocument *document, const EditJournal &journal, const TabViewState &state);
+
+    // 在空文档上恢复并返回新的编辑日志；重放结果与存档的文本不一致时只恢复文本，不恢复撤销历史。
+    // text 为存档时的文本；存档损坏时返回空指针
+    static EditJournal *restore(const QByteArray &archive, QTextDocument *document, TabViewState &state, QString &text);
+};
+
+#endif// QMARKDOWNEDITOR_TABARCHIVE_H
@@ -0,0 +1,214 @@
+#include "threewaymerge.h"
+#include <QHash>
+#include <QStringView>
+
+namespace {
+    // 按行切分，每行保留结尾的换行符，最后一行可能没有
+    QList<QStringView> splitLines(const QString &text) {
+        QList<QStringView> lines;
+        qsizetype start = 0;
+        while (start < text.size()) {
+            qsizetype newline = text.indexOf('\n', start);
+            qsizetype end = newline == -1 ? text.size() : newline + 1;
+            lines.append(QStringView(text).mid(start, end - start));
+            start = end;
+        }
+        return lines;
+    }
+
+    // 把行换成编号，之后的比较都是整数比较
+    QVector<int> lineIds(const QList<QStringView> &lines, QHash<QStringView, int> &ids) {
+        QVector<int> result;
+        result.reserve(lines.size());
+        for (QStringView line: lines) {
+            auto it = ids.find(line);
+            if (it == ids.end()) {
+                it = ids.insert(line, int(ids.size()));
+            }
+            result.append(it.value());
+        }
+        return result;
+    }
+
+    void appendLines(QString &out, const QList<QStringView> &lines, qsizetype from, qsizetype to) {
+        for (qsizetype i = from; i < to; ++i) {
+            out.append(lines[i]);
+        }
+    }
+
+    bool sameLines(const QVector<int> &a, qsizetype aFrom, qsizetype aTo, const QVector<int> &b, qsizetype bFrom, qsizetype bTo) {
+        return aTo - aFrom == bTo - bFrom && std::equal(a.begin() + aFrom, a.begin() + aTo, b.begin() + bFrom);
+    }
+
+    void endLine(QString &out) {
+        if (!out.isEmpty() && !out.endsWith('\n')) {
+            out.append('\n');
+        }
+    }
+}
+
+QList<ThreeWayMerge::Hunk> ThreeWayMerge::diff(const QVector<int> &a, const QVector<int> &b) {
+    QList<Hunk> hunks;
+    qsizetype prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix]) {
+        ++prefix;
+    }
+    qsizetype suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix && a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    const int *x0 = a.constData() + prefix;
+    const int *y0 = b.constData() + prefix;
+    const int n = int(a.size() - prefix - suffix);
+    const int m = int(b.size() - prefix - suffix);
+    if (n == 0 && m == 0) {
+        return hunks;
+    }
+    const Hunk whole{prefix, prefix + n, prefix, prefix + m};
+    if (n == 0 || m == 0) {
+        hunks.append(whole);
+        return hunks;
+    }
+
+    // 前向搜索：v[k] 为对角线 k 上能到达的最远 x，trace[d] 保存第 d 步的 v[-d..d]
+    const int limit = qMin(n + m, MaxEditDistance);
+    QVector<int> v(2 * limit + 3, 0);
+    const int offset = limit + 1;
+    QList<QVector<int>> trace;
+    int distance = -1;
+    for (int d = 0; d <= limit && distance < 0; ++d) {
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && x0[x] == y0[y]) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                distance = d;
+                break;
+            }
+        }
+        trace.append(v.mid(offset - d, 2 * d + 1));
+    }
+    if (distance < 0) {
+        hunks.append(whole);// 改动太多，整段替换
+        return hunks;
+    }
+
+    // 从终点回溯，收集对角线上的匹配行（逆序）
+    QVector<QPair<int, int>> matches;
+    int x = n, y = m;
+    for (int d = distance; d > 0; --d) {
+        const QVector<int> &previous = trace[d - 1];
+        const int k = x - y;
+        auto at = [&previous, d](int diagonal) { return previous[diagonal + d - 1]; };
+        const bool down = k == -d || (k != d && at(k - 1) < at(k + 1));
+        const int previousK = down ? k + 1 : k - 1;
+        const int previousX = at(previousK);
+        const int snakeX = down ? previousX : previousX + 1;
+        while (x > snakeX) {
+            --x;
+            --y;
+            matches.append({x, y});
+        }
+        x = previousX;
+        y = previousX - previousK;
+    }
+    while (x > 0 && y > 0) {
+        --x;
+        --y;
+        matches.append({x, y});
+    }
+
+    // 相邻两个匹配之间的空隙就是一处修改
+    qsizetype nextA = 0, nextB = 0;
+    for (auto it = matches.crbegin(); it != matches.crend(); ++it) {
+        if (it->first > nextA || it->second > nextB) {
+            hunks.append(Hunk{prefix + nextA, prefix + it->first, prefix + nextB, prefix + it->second});
+        }
+        nextA = it->first + 1;
+        nextB = it->second + 1;
+    }
+    if (nextA < n || nextB < m) {
+        hunks.append(Hunk{prefix + nextA, prefix + n, prefix + nextB, prefix + m});
+    }
+    return hunks;
+}
+
+MergeResult ThreeWayMerge::merge(const QString &base, const QString &mine, const QString &theirs) {
+    if (mine == theirs || base == theirs) {
+        return MergeResult{mine, 0};
+    }
+    if (base == mine) {
+        return MergeResult{theirs, 0};
+    }
+
+    const QList<QStringView> baseLines = splitLines(base);
+    const QList<QStringView> mineLines = splitLines(mine);
+    const QList<QStringView> theirLines = splitLines(theirs);
+    QHash<QStringView, int> ids;
+    const QVector<int> baseIds = lineIds(baseLines, ids);
+    const QVector<int> mineIds = lineIds(mineLines, ids);
+    const QVector<int> theirIds = lineIds(theirLines, ids);
+    const QList<Hunk> ours = diff(baseIds, mineIds);
+    const QList<Hunk> others = diff(baseIds, theirIds);
+
+    MergeResult result;
+    result.text.reserve(qMax(mine.size(), theirs.size()));
+    qsizetype basePos = 0;
+    qsizetype i = 0, j = 0;
+    while (i < ours.size() || j < others.size()) {
+        // 从最靠前的修改开始，把与之重叠或相接的修改（两边的）并成一个区域
+        const qsizetype firstOurs = i, firstOthers = j;
+        qsizetype start = (j >= others.size() || (i < ours.size() && ours[i].baseStart <= others[j].baseStart))
+                                  ? ours[i].baseStart
+                                  : others[j].baseStart;
+        qsizetype end = start;
+        bool grew = true;
+        while (grew) {
+            grew = false;
+            while (i < ours.size() && ours[i].baseStart <= end) {
+                end = qMax(end, ours[i++].baseEnd);
+                grew = true;
+            }
+            while (j < others.size() && others[j].baseStart <= end) {
+                end = qMax(end, others[j++].baseEnd);
+                grew = true;
+            }
+        }
+
+        appendLines(result.text, baseLines, basePos, start);
+        basePos = end;
+        if (j == firstOthers) {
+            appendLines(result.text, mineLines, ours[firstOurs].otherStart, ours[i - 1].otherEnd);
+            continue;
+        }
+        if (i == firstOurs) {
+            appendLines(result.text, theirLines, others[firstOthers].otherStart, others[j - 1].otherEnd);
+            continue;
+        }
+
+        // 区域内未修改的行在两个版本中一一对应，由此换算出各自的范围
+        const qsizetype mineStart = ours[firstOurs].otherStart - (ours[firstOurs].baseStart - start);
+        const qsizetype mineEnd = ours[i - 1].otherEnd + (end - ours[i - 1].baseEnd);
+        const qsizetype theirStart = others[firstOthers].otherStart - (others[firstOthers].baseStart - start);
+        const qsizetype theirEnd = others[j - 1].otherEnd + (end - others[j - 1].baseEnd);
+        if (sameLines(mineIds, mineStart, mineEnd, theirIds, theirStart, theirEnd)) {
+            appendLines(result.text, mineLines, mineStart, mineEnd);// 两边改成了一样的内容
+            continue;
+        }
+        endLine(result.text);
+        result.text.append("<<<<<<< 编辑器中的版本\n");
+        appendLines(result.text, mineLines, mineStart, mineEnd);
+        endLine(result.text);
+        result.text.append("=======\n");
+        appendLines(result.text, theirLines, theirStart, theirEnd);
+        endLine(result.text);
+        result.text.append(">>>>>>> 磁盘上的版本\n");
+        ++result.conflicts;
+    }
+    appendLines(result.text, baseLines, basePos, baseLines.size());
+    return result;
+}
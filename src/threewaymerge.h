@@ -0,0 +1,32 @@
+#ifndef QMARKDOWNEDITOR_THREEWAYMERGE_H
+#define QMARKDOWNEDITOR_THREEWAYMERGE_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+struct MergeResult {
+    QString text;     // 合并结果，有冲突时包含冲突标记
+    int conflicts = 0;// 两边修改了同一处的区域数
+};
+
+// 按行的三方合并：分别求出共同祖先到两个版本的差异，
+// 互不重叠的修改直接合并，两边对同一区域做了不同修改时写入冲突标记
+class ThreeWayMerge {
+public:
+    static MergeResult merge(const QString &base, const QString &mine, const QString &theirs);
+
+    // a 中 [baseStart, baseEnd) 的行被替换为 b 中 [otherStart, otherEnd) 的行
+    struct Hunk {
+        qsizetype baseStart;
+        qsizetype baseEnd;
+        qsizetype otherStart;
+        qsizetype otherEnd;
+    };
+    // Myers O(ND) 差异，先去掉公共的首尾行；编辑距离超过上限时整段视为替换
+    static QList<Hunk> diff(const QVector<int> &a, const QVector<int> &b);
+
+    static constexpr int MaxEditDistance = 2048;// 回溯记录占用 O(D²) 内存
+};
+
+#endif// QMARKDOWNEDITOR_THREEWAYMERGE_H
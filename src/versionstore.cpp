@@ -0,0 +1,302 @@
+#include "versionstore.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrent>
+
+namespace {
+    const int HashSize = 32;
+    const quint32 IndexMagic = 0x424e5649;// "BNVI"
+    const quint32 IndexVersion = 1;
+
+    // 文档内容和块哈希列表的分块参数（最小 / 平均 / 最大字节数）
+    const qsizetype ContentMin = 2 * 1024, ContentAverage = 8 * 1024, ContentMax = 64 * 1024;
+    const qsizetype ManifestMin = 256, ManifestAverage = 1024, ManifestMax = 4 * 1024;
+
+    QByteArray sha256(QByteArrayView data) {
+        return QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    }
+
+    // Gear 表由固定种子生成（splitmix64），分块边界在每次运行之间必须一致
+    const quint64 *gearTable() {
+        static quint64 table[256];
+        static const bool ready = []() {
+            quint64 state = 0x5EED5EED5EED5EEDull;
+            for (quint64 &value: table) {
+                state += 0x9E3779B97F4A7C15ull;
+                quint64 z = state;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                value = z ^ (z >> 31);
+            }
+            return true;
+        }();
+        Q_UNUSED(ready);
+        return table;
+    }
+}
+
+VersionStore::VersionStore(const QString &rootDir, QObject *parent) : QObject(parent), root(rootDir) {
+    writer.setMaxThreadCount(1);
+    QDir().mkpath(root + "/chunks");
+    QDir().mkpath(root + "/index");
+}
+
+VersionStore::~VersionStore() {
+    writer.waitForDone();
+}
+
+QVector<qsizetype> VersionStore::chunkBoundaries(const QByteArray &data, qsizetype minSize, qsizetype averageSize, qsizetype maxSize) {
+    // FastCDC：平均长度之前用更严格的掩码，之后用更宽松的掩码，块长集中在平均值附近。
+    // 左移的 Gear 哈希中高位取决于最近 64 个字节，所以掩码取高位
+    int bits = 0;
+    while ((qsizetype(1) << (bits + 1)) <= averageSize) {
+        ++bits;
+    }
+    const quint64 strictMask = ~0ull << (64 - (bits + 2));
+    const quint64 looseMask = ~0ull << (64 - (bits - 2));
+    const quint64 *gear = gearTable();
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    const qsizetype size = data.size();
+
+    QVector<qsizetype> ends;
+    for (qsizetype start = 0; start < size;) {
+        const qsizetype end = qMin(size, start + maxSize);
+        const qsizetype normal = qMin(end, start + averageSize);
+        qsizetype cut = end;
+        quint64 hash = 0;
+        qsizetype i = qMin(end, start + minSize);
+        for (; i < normal; ++i) {
+            hash = (hash << 1) + gear[bytes[i]];
+            if (!(hash & strictMask)) {
+                cut = i + 1;
+                break;
+            }
+        }
+        if (cut == end) {
+            for (; i < end; ++i) {
+                hash = (hash << 1) + gear[bytes[i]];
+                if (!(hash & looseMask)) {
+                    cut = i + 1;
+                    break;
+                }
+            }
+        }
+        ends.append(cut);
+        start = cut;
+    }
+    return ends;
+}
+
+QString VersionStore::chunkPath(const QByteArray &hash) const {
+    const QString hex = QString::fromLatin1(hash.toHex());
+    return root + "/chunks/" + hex.left(2) + "/" + hex.mid(2);
+}
+
+QString VersionStore::indexPath(const QString &filePath) const {
+    const QString normalized = QDir::cleanPath(QFileInfo(filePath).absoluteFilePath());
+    return root + "/index/" + QString::fromLatin1(sha256(normalized.toUtf8()).toHex().left(32)) + ".idx";
+}
+
+bool VersionStore::storeChunks(const QByteArray &data, qsizetype minSize, qsizetype averageSize, qsizetype maxSize,
+                               QList<QByteArray> &hashes) {
+    hashes.clear();
+    qsizetype start = 0;
+    for (qsizetype end: chunkBoundaries(data, minSize, averageSize, maxSize)) {
+        QByteArrayView chunk(data.constData() + start, end - start);
+        start = end;
+        QByteArray hash = sha256(chunk);
+        hashes.append(hash);
+
+        // 相同内容的块只存一份
+        const QString path = chunkPath(hash);
+        if (QFileInfo::exists(path)) {
+            continue;
+        }
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QByteArray compressed = qCompress(reinterpret_cast<const uchar *>(chunk.data()), int(chunk.size()));
+        QSaveFile file(path);
+        if (!file.open(QFile::WriteOnly)) {
+            return false;
+        }
+        // 首字节标记存储方式：z 为 zlib 压缩，r 为原样（压缩后没有变小）
+        if (compressed.size() < chunk.size()) {
+            file.write("z", 1);
+            file.write(compressed);
+        } else {
+            file.write("r", 1);
+            file.write(chunk.data(), chunk.size());
+        }
+        // QSaveFile 记住写入错误，commit 失败时不会留下不完整的块
+        if (!file.commit()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VersionStore::readChunks(const QByteArray &hashes, QByteArray &out) const {
+    for (qsizetype at = 0; at + HashSize <= hashes.size(); at += HashSize) {
+        const QByteArray hash = hashes.mid(at, HashSize);
+        QFile file(chunkPath(hash));
+        if (!file.open(QFile::ReadOnly)) {
+            return false;
+        }
+        QByteArray stored = file.readAll();
+        QByteArray chunk;
+        if (stored.startsWith('z')) {
+            chunk = qUncompress(reinterpret_cast<const uchar *>(stored.constData()) + 1, int(stored.size()) - 1);
+        } else if (stored.startsWith('r')) {
+            chunk = stored.mid(1);
+        }
+        if (sha256(chunk) != hash) {
+            return false;
+        }
+        out += chunk;
+    }
+    return true;
+}
+
+QList<VersionStore::Record> VersionStore::readIndex(const QString &filePath, qint64 *validBytes) const {
+    QList<Record> records;
+    if (validBytes) {
+        *validBytes = 0;
+    }
+    QFile file(indexPath(filePath));
+    if (!file.open(QFile::ReadOnly) || file.size() == 0) {
+        return records;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic, version;
+    QString path;
+    in >> magic >> version >> path;
+    if (in.status() != QDataStream::Ok || magic != IndexMagic || version != IndexVersion) {
+        if (validBytes) {
+            *validBytes = -1;
+        }
+        return records;
+    }
+    if (validBytes) {
+        *validBytes = file.pos();
+    }
+    while (!in.atEnd()) {
+        Record record;
+        quint32 count;
+        record.hash.resize(HashSize);
+        in >> record.time >> record.size;
+        in.readRawData(record.hash.data(), HashSize);
+        in >> count;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            QByteArray hash(HashSize, Qt::Uninitialized);
+            in.readRawData(hash.data(), HashSize);
+            record.manifest.append(hash);
+        }
+        // 写入中途退出留下的不完整记录
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        records.append(record);
+        if (validBytes) {
+            *validBytes = file.pos();
+        }
+    }
+    return records;
+}
+
+void VersionStore::snapshot(const QString &filePath, const QString &markdown) {
+    QtConcurrent::run(&writer, [this, filePath, markdown]() {
+        store(filePath, markdown.toUtf8());
+    });
+}
+
+void VersionStore::store(const QString &filePath, const QByteArray &content) {
+    const QByteArray hash = sha256(content);
+    {
+        QMutexLocker locker(&mutex);
+        if (!lastHash.contains(filePath)) {
+            QList<Record> records = readIndex(filePath);
+            lastHash.insert(filePath, records.isEmpty() ? QByteArray() : records.last().hash);
+        }
+        if (lastHash.value(filePath) == hash) {
+            return;// 自动保存时内容往往没有变化
+        }
+    }
+
+    // 块哈希列表本身也按内容分块，未变化的部分同样去重。
+    // 有块没写成功（磁盘满、权限）时放弃这个版本，索引不能指向不存在的块
+    QList<QByteArray> contentChunks;
+    QList<QByteArray> manifestChunks;
+    if (!storeChunks(content, ContentMin, ContentAverage, ContentMax, contentChunks) ||
+        !storeChunks(contentChunks.join(), ManifestMin, ManifestAverage, ManifestMax, manifestChunks)) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    // 上次写入中途退出留下的不完整记录先截掉，否则追加的记录都会读不出来
+    qint64 validBytes;
+    readIndex(filePath, &validBytes);
+    if (validBytes < 0) {
+        return;// 无法识别的索引（例如更新版本写的），不追加
+    }
+    QFile file(indexPath(filePath));
+    if (!file.open(QFile::ReadWrite)) {
+        return;
+    }
+    if (file.size() != validBytes && !file.resize(validBytes)) {
+        return;
+    }
+    file.seek(validBytes);
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    if (validBytes == 0) {
+        out << IndexMagic << IndexVersion << QDir::cleanPath(QFileInfo(filePath).absoluteFilePath());
+    }
+    out << QDateTime::currentMSecsSinceEpoch() << qint64(content.size());
+    out.writeRawData(hash.constData(), HashSize);
+    out << quint32(manifestChunks.size());
+    for (const QByteArray &chunk: manifestChunks) {
+        out.writeRawData(chunk.constData(), HashSize);
+    }
+    if (out.status() != QDataStream::Ok || !file.flush()) {
+        file.resize(validBytes);// 写了一半的记录不留在索引里
+        return;
+    }
+    file.close();
+    lastHash.insert(filePath, hash);
+    emit snapshotStored(filePath);
+}
+
+QList<VersionInfo> VersionStore::versions(const QString &filePath) {
+    QList<Record> records;
+    {
+        QMutexLocker locker(&mutex);
+        records = readIndex(filePath);
+    }
+    QList<VersionInfo> result;
+    for (int i = 0; i < records.size(); ++i) {
+        result.append(VersionInfo{i, QDateTime::fromMSecsSinceEpoch(records[i].time), records[i].size, records[i].hash});
+    }
+    return result;
+}
+
+bool VersionStore::restore(const QString &filePath, int index, QByteArray &content) {
+    QList<Record> records;
+    {
+        QMutexLocker locker(&mutex);
+        records = readIndex(filePath);
+    }
+    if (index < 0 || index >= records.size()) {
+        return false;
+    }
+    const Record &record = records[index];
+    QByteArray manifest;
+    content.clear();
+    if (!readChunks(record.manifest.join(), manifest) || !readChunks(manifest, content)) {
+        return false;
+    }
+    return content.size() == record.size && sha256(content) == record.hash;
+}
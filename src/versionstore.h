@@ -0,0 +1,70 @@
+#ifndef QMARKDOWNEDITOR_VERSIONSTORE_H
+#define QMARKDOWNEDITOR_VERSIONSTORE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+struct VersionInfo {
+    int index;        // 在该文档历史中的序号，从 0 开始
+    QDateTime time;
+    qint64 size;      // 文档字节数
+    QByteArray hash;  // 文档内容的 SHA-256
+};
+
+// 本地版本历史：每次保存的内容按内容定义分块（FastCDC），块以 SHA-256 命名、压缩后只存一份，
+// 版本只记录块哈希列表（列表本身也分块去重），所以一个大文档的上千个版本只占编辑量大小的空间。
+// 每个文档一个追加写入的索引文件，列出版本不需要读取任何块
+class VersionStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit VersionStore(const QString &rootDir, QObject *parent = nullptr);
+    ~VersionStore() override;
+
+    // 在后台线程为文档生成快照，内容与上一个版本相同时跳过
+    void snapshot(const QString &filePath, const QString &markdown);
+
+    // 文档的所有版本，按时间顺序
+    QList<VersionInfo> versions(const QString &filePath);
+
+    // 读出某个版本的内容，校验失败（块缺失或损坏）时返回 false
+    bool restore(const QString &filePath, int index, QByteArray &content);
+
+    // 把数据切成内容定义的块，返回每块的结束位置
+    static QVector<qsizetype> chunkBoundaries(const QByteArray &data, qsizetype minSize, qsizetype averageSize, qsizetype maxSize);
+
+signals:
+    // 快照写入完成（在后台线程发出）
+    void snapshotStored(const QString &filePath);
+
+private:
+    struct Record {
+        qint64 time;
+        qint64 size;
+        QByteArray hash;
+        QList<QByteArray> manifest;// 块哈希列表所在的块
+    };
+
+    void store(const QString &filePath, const QByteArray &content);
+    // 任何一块写入失败时返回 false，此时不能记录这个版本
+    bool storeChunks(const QByteArray &data, qsizetype minSize, qsizetype averageSize, qsizetype maxSize, QList<QByteArray> &hashes);
+    bool readChunks(const QByteArray &hashes, QByteArray &out) const;
+    QString chunkPath(const QByteArray &hash) const;
+    QString indexPath(const QString &filePath) const;
+    // validBytes 返回最后一条完整记录的结束位置；文件头无法识别时为 -1
+    QList<Record> readIndex(const QString &filePath, qint64 *validBytes = nullptr) const;
+
+    QString root;
+    QThreadPool writer;               // 单线程，快照按保存顺序写入
+    QMutex mutex;                     // 保护索引文件和 lastHash
+    QHash<QString, QByteArray> lastHash;// 文档 -> 最新版本的内容哈希
+};
+
+#endif// QMARKDOWNEDITOR_VERSIONSTORE_H
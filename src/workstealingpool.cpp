@@ -0,0 +1,67 @@
+#include "workstealingpool.h"
+#include <QThread>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : threads(threadCount > 0 ? threadCount : qMax(1, QThread::idealThreadCount())) {}
+
+void WorkStealingPool::run(int taskCount, const std::function<void(int)> &task) const {
+    if (taskCount <= 0) {
+        return;
+    }
+    const int workers = qMin(threads, taskCount);
+    std::vector<WorkQueue> queues(workers);
+
+    // 连续区间分配，相邻文件（通常在同一目录）落在同一线程上
+    for (int i = 0; i < taskCount; ++i) {
+        queues[static_cast<qint64>(i) * workers / taskCount].tasks.push_back(i);
+    }
+
+    auto worker = [&](int self) {
+        for (;;) {
+            int index = -1;
+            {
+                // 自己的队列从尾部取（后进先出）
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].tasks.empty()) {
+                    index = queues[self].tasks.back();
+                    queues[self].tasks.pop_back();
+                }
+            }
+            // 从其他线程的队列头部窃取，与其所有者的取用方向相反，减少竞争
+            for (int k = 1; index == -1 && k < workers; ++k) {
+                WorkQueue &victim = queues[(self + k) % workers];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    index = victim.tasks.front();
+                    victim.tasks.pop_front();
+                }
+            }
+            // 任务不会在执行中新增，所有队列都空就可以结束
+            if (index == -1) {
+                return;
+            }
+            task(index);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (int i = 1; i < workers; ++i) {
+        pool.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto &thread: pool) {
+        thread.join();
+    }
+}
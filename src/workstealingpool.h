@@ -0,0 +1,20 @@
+#ifndef QMARKDOWNEDITOR_WORKSTEALINGPOOL_H
+#define QMARKDOWNEDITOR_WORKSTEALINGPOOL_H
+
+#include <functional>
+
+// 工作窃取线程池：任务按区间均分给各线程，自己的队列空了就从其他线程的队列头部窃取
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threadCount = 0);// 0 表示使用 CPU 核心数
+
+    // 执行编号为 [0, taskCount) 的任务，阻塞直到全部完成；调用线程也参与执行
+    void run(int taskCount, const std::function<void(int)> &task) const;
+
+    int threadCount() const { return threads; }
+
+private:
+    int threads;
+};
+
+#endif// QMARKDOWNEDITOR_WORKSTEALINGPOOL_H